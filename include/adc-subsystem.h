@@ -0,0 +1,4 @@
+#pragma once
+
+void adc_subsystem_init(void);
+void adc_subsystem_do_periodic_work(void);
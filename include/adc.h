@@ -4,8 +4,17 @@
 #include "fix16.h"
 #include "config.h"
 
+// Время выборки канала (столбец SMP в ADC_CHANNELS_DESC)
+// АЦП имеет две настройки времени выборки, каждый канал использует одну из них
+#define ADC_SMP_LONG                    0   // SMP1: 160.5 тактов - высокоомные источники и внутренние каналы
+#define ADC_SMP_SHORT                   1   // SMP2: 12.5 тактов - низкоомные источники (делители с конденсатором)
+
+// Ограничения настроек фильтрации канала
+#define ADC_MEDIAN_WINDOW_MAX           5
+#define ADC_LOWPASS_RC_MAX_MS           10000
+
 /* ADC channels names generation*/
-#define ADC_ENUM(alias, ch_num, port, pin, rc_factor, k)     ADC_CHANNEL_##alias,
+#define ADC_ENUM(alias, ch_num, port, pin, rc_factor, k, smp)     ADC_CHANNEL_##alias,
 
 enum adc_channel {
     ADC_CHANNELS_DESC(ADC_ENUM)
@@ -32,11 +41,108 @@ enum adc_vref {
     ADC_VREF_INT,
 };
 
+// Аппаратные аналоговые watchdog АЦП
+enum adc_awd {
+    ADC_AWD_1,
+    ADC_AWD_2,
+    ADC_AWD_3,
+
+    ADC_AWD_COUNT
+};
+
+// Вызывается из прерывания АЦП при выходе канала за пороги watchdog
+typedef void (*adc_awd_handler_t)(enum adc_awd awd);
+
+// Захват осциллограммы питания: кольцевой буфер сырых измерений каждого опроса
+#define ADC_CAPTURE_DEPTH               64      // должно быть степенью двойки
+
+enum adc_capture_channel {
+    ADC_CAPTURE_CHANNEL_V_IN,
+    ADC_CAPTURE_CHANNEL_5V,
+    ADC_CAPTURE_CHANNEL_3V3,
+
+    ADC_CAPTURE_CHANNEL_COUNT
+};
+
+enum adc_capture_state {
+    ADC_CAPTURE_STATE_IDLE,
+    ADC_CAPTURE_STATE_ARMED,        // буфер заполняется, ожидание события
+    ADC_CAPTURE_STATE_TRIGGERED,    // событие произошло, идёт запись после него
+    ADC_CAPTURE_STATE_DONE,         // буфер заморожен
+};
+
+enum adc_capture_trigger {
+    ADC_CAPTURE_TRIGGER_NONE,
+    ADC_CAPTURE_TRIGGER_THRESHOLD,  // канал опустился ниже порога захвата
+    ADC_CAPTURE_TRIGGER_EXTERNAL,   // вызов adc_capture_trigger(), например от voltage monitor
+};
+
+// Каналы, для которых собирается статистика
+enum adc_stats_channel {
+    ADC_STATS_CHANNEL_V_IN,
+    ADC_STATS_CHANNEL_IN1,
+    ADC_STATS_CHANNEL_IN2,
+    ADC_STATS_CHANNEL_IN3,
+    ADC_STATS_CHANNEL_IN4,
+
+    ADC_STATS_CHANNEL_COUNT
+};
+
+struct adc_stats {
+    int32_t min_mv;
+    int32_t max_mv;
+    int32_t avg_mv;
+    uint16_t count;                 // количество измерений (по одному за период фильтрации)
+};
+
+// Цифровые входы с гистерезисом на аналоговых входах A1-A4
+enum adc_din {
+    ADC_DIN_A1,
+    ADC_DIN_A2,
+    ADC_DIN_A3,
+    ADC_DIN_A4,
+
+    ADC_DIN_COUNT
+};
+
+struct adc_capture_info {
+    enum adc_capture_state state;
+    enum adc_capture_trigger trigger;
+    enum adc_capture_channel trigger_channel;
+    uint8_t samples_count;
+    uint8_t trigger_index;          // индекс измерения события от начала буфера
+};
+
 void adc_init(enum adc_clock clock_divider, enum adc_vref vref);
 void adc_set_lowpass_rc(enum adc_channel channel, uint16_t rc_ms);
+uint16_t adc_get_lowpass_rc(enum adc_channel channel);
+void adc_set_median_window(enum adc_channel channel, uint8_t n);
+uint8_t adc_get_median_window(enum adc_channel channel);
 void adc_set_offset_mv(enum adc_channel channel, int16_t offset_mv);
 fix16_t adc_get_ch_adc_raw(enum adc_channel channel);
 int32_t adc_get_ch_mv(enum adc_channel channel);
 fix16_t adc_get_ch_mv_f16(enum adc_channel channel);
 bool adc_get_ready(void);
+
+// Однократное измерение канала в mV без DMA, таймера и фильтров, с коррекцией по INT_VREF
+// Для быстрой проверки после пробуждения из standby: вызывается до adc_init, после измерения АЦП выключается
+int32_t adc_measure_once_mv(enum adc_channel channel);
+
+void adc_awd_set_handler(adc_awd_handler_t handler);
+void adc_awd_setup(enum adc_awd awd, enum adc_channel channel, int32_t low_mv, int32_t high_mv);
+void adc_awd_rearm(enum adc_awd awd);
+void adc_awd_disarm(enum adc_awd awd);
+
+void adc_capture_arm(uint8_t post_trigger_samples);
+void adc_capture_trigger(void);
+void adc_capture_set_threshold_mv(enum adc_capture_channel channel, int32_t mv);
+void adc_capture_get_info(struct adc_capture_info * info);
+int32_t adc_capture_get_sample_mv(enum adc_capture_channel channel, uint8_t index);
+
+void adc_stats_take(struct adc_stats stats[ADC_STATS_CHANNEL_COUNT]);
+
+void adc_din_set_thresholds(enum adc_din din, int32_t low_mv, int32_t high_mv);
+uint8_t adc_din_get_states(void);
+uint16_t adc_din_get_rising_count(enum adc_din din);
+uint16_t adc_din_get_falling_count(enum adc_din din);
 void adc_do_periodic_work(void);
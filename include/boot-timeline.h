@@ -0,0 +1,20 @@
+#pragma once
+
+// Этапы загрузки в порядке прохождения, номер этапа - индекс в BOOT_TIMELINE
+enum boot_milestone {
+    BOOT_MILESTONE_ADC_READY,           // первое измерение АЦП на 1 МГц
+    BOOT_MILESTONE_WBEC_INIT,           // принято решение включаться
+    BOOT_MILESTONE_INIT_DONE,           // 64 МГц, драйверы и подсистемы инициализированы
+    BOOT_MILESTONE_STARTUP_DONE,        // определено, работает ли уже Linux (выход из WAIT_STARTUP)
+    BOOT_MILESTONE_VMON_READY,          // voltage monitor проверил все каналы
+    BOOT_MILESTONE_LINUX_POWER_ON,      // начато включение питания Linux
+    BOOT_MILESTONE_LINUX_WORKING,       // питание Linux включено (WORKING)
+
+    BOOT_MILESTONE_COUNT
+};
+
+void boot_timeline_init(void);
+void boot_timeline_do_periodic_work(void);
+
+// Запоминает время первого прохождения этапа, можно вызывать до инициализации regmap
+void boot_timeline_mark(enum boot_milestone m);
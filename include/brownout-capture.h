@@ -0,0 +1,4 @@
+#pragma once
+
+void brownout_capture_init(void);
+void brownout_capture_do_periodic_work(void);
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdbool.h>
+
+// Размер данных журнала питания, хранимого в страницах настроек
+#define CONFIG_STORE_JOURNAL_SIZE           112
+
+void config_store_init(void);
+void config_store_do_periodic_work(void);
+
+// Записывает сохранённые настройки в regmap, модули применят их как записанные из Linux
+void config_store_apply(void);
+
+// Данные журнала питания (CONFIG_STORE_JOURNAL_SIZE байт) или NULL, если журнал не сохранён.
+// Указатель на flash действителен до следующей записи в хранилище
+const void * config_store_get_journal(void);
+// Записывает журнал во flash, при переходе на другую страницу стирает её (22-40 мс)
+bool config_store_save_journal(const void *data);
@@ -45,8 +45,13 @@
 // Максимальный таймаут
 #define WBEC_WATCHDOG_MAX_TIMEOUT_S             600
 
-// Время, на которое выключается питание при перезагрузке
+// Время, на которое выключается питание при перезагрузке (максимальное)
 #define WBEC_POWER_RESET_TIME_MS                1000
+// Питание включается раньше, как только линия 3.3В разрядится ниже порога,
+// но не раньше минимального времени: 5В процессорного модуля EC не измеряет
+// Значения по умолчанию, меняются через regmap PWR_SEQ_CFG
+#define WBEC_POWER_RESET_TIME_MIN_MS            300
+#define WBEC_POWER_RESET_V33_DISCHARGED_MV      500
 // Время загрузки Linux и драйверов WBEC
 // До этого времени питание выключается сразу при коротком нажатии
 // После - отправляется запрос в Linux
@@ -57,6 +62,10 @@
 // Время задержки включения при работе от USB
 #define WBEC_LINUX_POWER_ON_DELAY_FROM_USB      5000
 
+// Сколько канал держится в FAIL после срабатывания watchdog АЦП,
+// если отфильтрованное значение так и не вышло за порог FAIL
+#define VOLTAGE_MONITOR_AWD_HOLD_MS             1000
+
 #define WBEC_PERIODIC_WAKEUP_FIRST_TIMEOUT_S    5
 #define WBEC_PERIODIC_WAKEUP_NEXT_TIMEOUT_S     2
 
@@ -82,3 +91,33 @@
     #error "Unknown model"
 #endif
 
+/**
+ * Тайминги включения питания Linux по умолчанию, одинаковые для всех моделей
+ * Модель может переопределить любое значение в своём конфиге
+ * Процессорные модули включаются за разное время, поэтому значения
+ * можно изменить из Linux через regmap (PWR_SEQ_CFG) и сохранить во flash (CONFIG_CTRL)
+ */
+#ifndef WBEC_LINUX_POWER_WAIT_3V3_MS
+    #define WBEC_LINUX_POWER_WAIT_3V3_MS            1000    // ожидание 3.3В после подачи 5В
+#endif
+#ifndef WBEC_LINUX_POWER_PMIC_PWRON_MS
+    #define WBEC_LINUX_POWER_PMIC_PWRON_MS          1500    // удержание PWRON PMIC
+#endif
+#ifndef WBEC_LINUX_POWER_PMIC_PWRON_PAUSE_MS
+    #define WBEC_LINUX_POWER_PMIC_PWRON_PAUSE_MS    500     // пауза между попытками PWRON
+#endif
+#ifndef WBEC_LINUX_POWER_PMIC_PWRON_ATTEMPTS
+    #define WBEC_LINUX_POWER_PMIC_PWRON_ATTEMPTS    3       // повторные попытки PWRON до сброса 5В
+#endif
+#ifndef WBEC_LINUX_POWER_PMIC_RESET_MS
+    #define WBEC_LINUX_POWER_PMIC_RESET_MS          2000    // максимальное удержание RESET PMIC
+#endif
+// Пороги досрочного выхода из шагов: 3.3В появилось (включение) и пропало (сброс PMIC)
+// 0 - по статусу канала V33 voltage monitor
+#ifndef WBEC_LINUX_POWER_V33_ON_MV
+    #define WBEC_LINUX_POWER_V33_ON_MV              0
+#endif
+#ifndef WBEC_LINUX_POWER_V33_OFF_MV
+    #define WBEC_LINUX_POWER_V33_OFF_MV             0
+#endif
+
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+
+enum event_log_level {
+    EVENT_LOG_LEVEL_ERROR,
+    EVENT_LOG_LEVEL_WARN,
+    EVENT_LOG_LEVEL_INFO,
+    EVENT_LOG_LEVEL_DEBUG,
+
+    EVENT_LOG_LEVEL_COUNT
+};
+
+#define EVENT_LOG_LEVEL_MASK(l)             (1U << EVENT_LOG_LEVEL_##l)
+#define EVENT_LOG_LEVEL_MASK_ALL            ((1U << EVENT_LOG_LEVEL_COUNT) - 1)
+#define EVENT_LOG_LEVEL_MASK_DEFAULT        (EVENT_LOG_LEVEL_MASK(ERROR) | \
+                                             EVENT_LOG_LEVEL_MASK(WARN) | \
+                                             EVENT_LOG_LEVEL_MASK(INFO))
+
+/**
+ * Таблица событий
+ *
+ * Номер события передаётся в Linux, поэтому новые события добавляются только в конец.
+ * В тексте можно использовать аргументы события:
+ *  %d      - целое число
+ *  %.Nd    - число с фиксированной точкой, N знаков после запятой (1-3)
+ */
+#define EVENT_LOG_EVENTS(m) \
+    /* Name                     Level   Text */ \
+    m(TEST_MESSAGE,             INFO,   "Test message") \
+    m(V50_PRESENT,              INFO,   "5V line status: voltage present") \
+    m(V50_ABSENT,               INFO,   "5V line status: no voltage") \
+    m(GOTO_STANDBY,             INFO,   "Power off and go to standby now") \
+    m(PWRKEY_LONG_PRESS_OFF,    INFO,   "Power off after power key long press detected.") \
+    m(V50_LOST,                 WARN,   "Voltage on 5V line is lost, power off and go to standby now") \
+    m(PMIC_PWRON_NO_3V3,        WARN,   "No voltage on 3.3V line, try to switch on PMIC throught PWRON") \
+    m(PMIC_PWRON_FAILED,        ERROR,  "Still no voltage on 3.3V line, reset 5V line and try to switch on again") \
+    m(PMIC_PWRON_RETRY,         WARN,   "One more attempt to switch on PMIC throught PWRON") \
+    m(PMIC_RESET_DONE,          INFO,   "PMIC was reset throught RESET line") \
+    m(TEMP_OK,                  INFO,   "Temperature is OK!") \
+    m(TEMP_TOO_LOW,             WARN,   "Current board temperature %.1dºC is too low! Waiting for it to rise above %.1dºC") \
+    m(POWEROFF_REQUEST,         INFO,   "Power off request from Linux.") \
+    m(POWERING_OFF,             INFO,   "Powering off") \
+    m(REBOOT_NO_ALARM,          INFO,   "Alarm not set, reboot system instead of power off.") \
+    m(REBOOT_REQUEST,           INFO,   "Reboot request, reset power.") \
+    m(PMIC_RESET_REQUEST,       INFO,   "PMIC reset request, activate PMIC RESET line now") \
+    m(WDT_TIMED_OUT,            WARN,   "Watchdog is timed out, reset power.") \
+    m(V33_LOST,                 WARN,   "3.3V is lost") \
+    m(WBMZ_DISCHARGED,          WARN,   "WBMZ battery is fully discharged, disable WBMZ to prevent reboot loop") \
+    m(POWER_LOSS_LIMIT,         ERROR,  "Reaching power loss limit, power off and go to standby now") \
+    m(POWER_LOSS_RESET,         WARN,   "Try to reset power, enable WBMZ to prevent power loss under load") \
+    m(CONFIG_OLD_FORMAT,        WARN,   "Stored settings are from older firmware, missing values are default") \
+    m(CONFIG_DROPPED,           ERROR,  "Stored settings are damaged or unknown, default settings are used") \
+
+#define __EVENT_LOG_ID(name, level, text)       EVENT_LOG_##name,
+
+enum event_log_id {
+    EVENT_LOG_EVENTS(__EVENT_LOG_ID)
+
+    EVENT_LOG_ID_COUNT
+};
+
+void event_log_init(void);
+void event_log_do_periodic_work(void);
+
+// Записывает событие в лог, вызывать только из основного цикла
+void event_log_put(enum event_log_id id, int16_t arg0, int16_t arg1);
+
+static inline void event_log(enum event_log_id id)
+{
+    event_log_put(id, 0, 0);
+}
+
+// Выводит в консоль не выведенные события, которые помещаются в буфер UART
+void event_log_print_pending(void);
+// Выводит в консоль все не выведенные события и ждёт окончания отправки (перед standby)
+void event_log_flush(void);
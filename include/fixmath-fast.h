@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include "fix16.h"
+
+/**
+ * Операции с фиксированной точкой без деления
+ *
+ * На Cortex-M0+ нет аппаратного деления: fix16_div и целочисленное деление
+ * выполняются программно и стоят сотни тактов. На горячих путях деление
+ * заменяется умножением на обратную величину:
+ *  - для констант обратная величина считается при компиляции (U32_RECIP_Q32)
+ *  - для медленно меняющихся величин обратная величина уточняется
+ *    итерацией Ньютона (fix16_recip_nr_step)
+ *
+ * Для проверки стоимости операций есть бенчмарк tools/fixmath-bench
+ */
+
+// Обратная величина целого d в формате Q0.32 (с округлением вверх)
+// Для констант считается при компиляции
+#define U32_RECIP_Q32(d)            ((uint32_t)((((uint64_t)1 << 32) + (d) - 1) / (d)))
+
+// a / d через умножение на recip_q32 = U32_RECIP_Q32(d)
+static inline uint32_t u32_mul_recip_q32(uint32_t a, uint32_t recip_q32)
+{
+    return ((uint64_t)a * recip_q32) >> 32;
+}
+
+// Один шаг итерации Ньютона для y = 1 / x: y' = y * (2 - x * y)
+// Относительная ошибка после шага равна квадрату ошибки до шага, поэтому для
+// медленно меняющегося x достаточно одного шага на каждое новое значение
+// Сходится при |1 - x * y| < 1
+static inline fix16_t fix16_recip_nr_step(fix16_t x, fix16_t y)
+{
+    return fix16_mul(y, fix16_sub(F16(2), fix16_mul(x, y)));
+}
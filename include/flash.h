@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Страницы flash для хранения настроек
+ * Расположены в конце flash, место под них зарезервировано в ldscript
+ */
+
+#define FLASH_STORAGE_PAGE_SIZE         2048
+#define FLASH_STORAGE_PAGES_COUNT       2
+// Минимальная единица программирования flash - двойное слово
+#define FLASH_STORAGE_WRITE_UNIT        8
+
+// Адрес начала страницы хранилища, читать можно напрямую
+const uint8_t * flash_storage_page_addr(unsigned page);
+// Стирает страницу хранилища, после стирания все байты равны 0xFF
+bool flash_storage_erase(unsigned page);
+// Записывает данные в стёртую область страницы
+// offset и size должны быть кратны FLASH_STORAGE_WRITE_UNIT
+bool flash_storage_program(unsigned page, uint16_t offset, const void *data, uint16_t size);
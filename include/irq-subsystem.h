@@ -6,6 +6,8 @@
 enum irq_flag {
     IRQ_ALARM,
     IRQ_PWR_OFF_REQ,
+    IRQ_PWR_FAIL,
+    IRQ_GPIO_DIN,
 
     IRQ_COUNT
 };
@@ -2,6 +2,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+void linux_cpu_pwr_seq_config_init(void);
 void linux_cpu_pwr_seq_init(bool on);
 void linux_cpu_pwr_seq_off_and_goto_standby(uint16_t wakeup_after_s);
 void linux_cpu_pwr_seq_on(void);
@@ -15,8 +15,16 @@ enum mcu_vcc_5v_state {
     MCU_VCC_5V_STATE_ON = 1,
 };
 
+// Статистика периодических пробуждений, хранится в RTC домене
+struct mcu_standby_stats {
+    uint16_t wakeups;           // количество засыпаний с прошлого вызова mcu_take_standby_stats
+    uint16_t last_awake_us;     // время бодрствования перед последним засыпанием, UINT16_MAX - не меньше
+};
+
 void mcu_init_poweron_reason(void);
 enum mcu_poweron_reason mcu_get_poweron_reason(void);
 void mcu_goto_standby(uint16_t wakeup_after_s);
 enum mcu_vcc_5v_state mcu_get_vcc_5v_last_state(void);
 void mcu_save_vcc_5v_last_state(enum mcu_vcc_5v_state state);
+// Забирает статистику пробуждений из standby, счётчик засыпаний обнуляется
+void mcu_take_standby_stats(struct mcu_standby_stats * stats);
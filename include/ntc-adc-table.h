@@ -0,0 +1,89 @@
+#pragma once
+
+// Сгенерировано tools/gen-ntc-adc-table.py, не редактировать вручную
+// Температура NTC в 1/64 °C для кодов АЦП 0, 16, 32, ... 4096
+
+#include <stdint.h>
+
+#define NTC_ADC_TABLE_STEP_SHIFT        4
+#define NTC_ADC_TABLE_TEMP_SHIFT        6
+
+#if (NTC_RES_KOHM == 10) && (NTC_PULLUP_RES_KOHM == 33)
+
+static const int16_t ntc_adc_table[257] = {
+    9600, 9600, 9600, 8881, 8000, 7358, 6864, 6450,
+    6101, 5803, 5544, 5312, 5099, 4913, 4738, 4579,
+    4429, 4294, 4158, 4044, 3928, 3817, 3720, 3622,
+    3523, 3440, 3357, 3274, 3191, 3121, 3051, 2980,
+    2908, 2844, 2784, 2724, 2664, 2603, 2544, 2494,
+    2443, 2392, 2340, 2287, 2236, 2193, 2149, 2106,
+    2061, 2017, 1972, 1926, 1888, 1851, 1814, 1776,
+    1738, 1699, 1660, 1621, 1585, 1553, 1521, 1488,
+    1455, 1422, 1388, 1354, 1320, 1285, 1256, 1229,
+    1200, 1172, 1143, 1114, 1084, 1054, 1024, 994,
+    963, 938, 913, 888, 863, 837, 811, 785,
+    759, 732, 705, 677, 649, 625, 603, 581,
+    558, 535, 512, 489, 465, 441, 416, 391,
+    366, 341, 316, 296, 276, 255, 234, 213,
+    191, 170, 148, 125, 102, 79, 56, 32,
+    8, -12, -31, -51, -70, -90, -110, -130,
+    -151, -172, -194, -215, -237, -260, -283, -306,
+    -327, -345, -364, -382, -401, -421, -441, -461,
+    -481, -502, -523, -545, -567, -589, -612, -635,
+    -654, -672, -690, -709, -728, -748, -768, -788,
+    -809, -830, -852, -874, -896, -919, -943, -965,
+    -984, -1002, -1021, -1041, -1061, -1081, -1102, -1124,
+    -1146, -1169, -1192, -1216, -1240, -1265, -1288, -1307,
+    -1327, -1348, -1369, -1390, -1413, -1436, -1459, -1484,
+    -1509, -1535, -1562, -1589, -1613, -1634, -1656, -1679,
+    -1703, -1727, -1753, -1779, -1807, -1835, -1865, -1896,
+    -1926, -1950, -1975, -2001, -2028, -2056, -2086, -2118,
+    -2151, -2185, -2222, -2254, -2283, -2313, -2345, -2379,
+    -2415, -2453, -2494, -2538, -2577, -2612, -2650, -2690,
+    -2734, -2782, -2834, -2888, -2931, -2979, -3032, -3091,
+    -3157, -3222, -3280, -3347, -3425, -3518, -3520, -3520,
+    -3520, -3520, -3520, -3520, -3520, -3520, -3520, -3520,
+    -3520,
+};
+
+#elif (NTC_RES_KOHM == 100) && (NTC_PULLUP_RES_KOHM == 33)
+
+static const int16_t ntc_adc_table[257] = {
+    9600, 9600, 9600, 9600, 9600, 9600, 9600, 9600,
+    9600, 9600, 9600, 9600, 9600, 9600, 9600, 9522,
+    9324, 9144, 8968, 8813, 8657, 8519, 8382, 8254,
+    8134, 8012, 7905, 7799, 7691, 7597, 7503, 7408,
+    7320, 7238, 7155, 7071, 6994, 6922, 6848, 6774,
+    6703, 6639, 6574, 6509, 6444, 6381, 6324, 6267,
+    6209, 6151, 6092, 6040, 5990, 5939, 5888, 5836,
+    5783, 5735, 5690, 5645, 5599, 5553, 5506, 5459,
+    5416, 5376, 5335, 5294, 5253, 5211, 5169, 5126,
+    5089, 5053, 5016, 4979, 4941, 4904, 4865, 4826,
+    4789, 4757, 4724, 4690, 4656, 4622, 4587, 4552,
+    4517, 4481, 4451, 4420, 4390, 4359, 4327, 4296,
+    4263, 4231, 4198, 4165, 4136, 4108, 4080, 4051,
+    4022, 3993, 3963, 3932, 3902, 3871, 3839, 3813,
+    3787, 3760, 3733, 3706, 3678, 3650, 3621, 3592,
+    3562, 3533, 3506, 3481, 3455, 3430, 3404, 3377,
+    3350, 3323, 3295, 3267, 3239, 3209, 3184, 3160,
+    3135, 3110, 3085, 3059, 3033, 3006, 2979, 2951,
+    2923, 2895, 2868, 2845, 2821, 2796, 2771, 2746,
+    2720, 2693, 2666, 2639, 2610, 2582, 2554, 2530,
+    2506, 2482, 2456, 2431, 2404, 2378, 2350, 2322,
+    2293, 2264, 2235, 2211, 2186, 2161, 2135, 2108,
+    2081, 2053, 2025, 1995, 1965, 1934, 1906, 1880,
+    1854, 1827, 1799, 1771, 1742, 1711, 1680, 1648,
+    1615, 1585, 1558, 1529, 1500, 1470, 1439, 1406,
+    1373, 1338, 1302, 1268, 1239, 1208, 1176, 1142,
+    1107, 1071, 1033, 993, 954, 921, 886, 850,
+    812, 772, 729, 685, 638, 601, 561, 519,
+    475, 427, 376, 322, 278, 231, 181, 127,
+    68, 4, -49, -105, -167, -236, -313, -377,
+    -448, -527, -619, -701, -790, -895, -1004, -1115,
+    -1253, -1387, -1556, -1734, -1963, -2247, -2614, -3229,
+    -3520,
+};
+
+#else
+    #error Not supported NTC, regenerate table with tools/gen-ntc-adc-table.py
+#endif
@@ -0,0 +1,4 @@
+#pragma once
+
+void perf_subsystem_init(void);
+void perf_subsystem_do_periodic_work(void);
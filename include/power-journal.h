@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// Значения хранятся во flash и передаются в Linux,
+// поэтому менять их нельзя, новые события добавляются в конец
+enum power_journal_event {
+    POWER_JOURNAL_EMPTY,
+    POWER_JOURNAL_LINUX_POWERON,        // arg: причина включения (как в POWERON_REASON)
+    POWER_JOURNAL_WATCHDOG,             // сработал watchdog Linux
+    POWER_JOURNAL_PMIC_OFF,             // пропало 3.3V, arg: число предыдущих потерь питания подряд
+    POWER_JOURNAL_POWER_LOSS_LIMIT,     // превышено число потерь питания, выключение
+    POWER_JOURNAL_WBMZ_ON,              // переход на питание от WBMZ
+    POWER_JOURNAL_WBMZ_OFF,             // переход на внешнее питание
+    POWER_JOURNAL_STANDBY,              // выключение и переход EC в standby
+};
+
+void power_journal_init(void);
+void power_journal_do_periodic_work(void);
+
+void power_journal_add(enum power_journal_event e, uint8_t arg);
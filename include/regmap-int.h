@@ -20,3 +20,7 @@ enum regmap_region {
 void regmap_init(void);
 bool regmap_set_region_data(enum regmap_region r, const void * data, size_t size);
 bool regmap_get_data_if_region_changed(enum regmap_region r, void * data, size_t size);
+// Копирует текущие данные региона, не сбрасывая флаги изменения
+bool regmap_get_region_data(enum regmap_region r, void * data, size_t size);
+// Записывает данные в RW регион так, как будто их записали снаружи
+bool regmap_set_region_data_as_changed(enum regmap_region r, const void * data, size_t size);
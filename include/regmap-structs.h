@@ -62,6 +62,39 @@
         /* 0x48 */  uint16_t v_a3; \
         /* 0x49 */  uint16_t v_a4; \
     ) \
+    /*     Addr     Name                RO/RW */ \
+    m(     0x4A,    ADC_CAPTURE_CTRL,   RW, \
+        /* 0x4A */  uint16_t arm : 1; \
+        /* 0x4B */  uint16_t post_trigger_samples; \
+        /* 0x4C */  uint16_t threshold_v_in; \
+        /* 0x4D */  uint16_t threshold_v_5_0; \
+        /* 0x4E */  uint16_t threshold_v_3_3; \
+        /* 0x4F */  uint16_t window_offset : 8; \
+        /* -//- */  uint16_t window_channel : 8; \
+    ) \
+    /*     Addr     Name                RO/RW */ \
+    m(     0x50,    ADC_CAPTURE_STATUS, RO, \
+        /* 0x50 */  uint16_t state; \
+        /* 0x51 */  uint16_t trigger; \
+        /* 0x52 */  uint16_t trigger_channel; \
+        /* 0x53 */  uint16_t samples_count; \
+        /* 0x54 */  uint16_t trigger_index; \
+        /* 0x55 */  uint16_t depth; \
+    ) \
+    /*     Addr     Name                RO/RW */ \
+    m(     0x56,    ADC_FILTER,         RW, \
+        /* 0x56-0x59 */ uint16_t rc_ms[4]; \
+        /* 0x5A-0x5D */ uint16_t median_window[4]; \
+    ) \
+    /*     Addr     Name                RO/RW */ \
+    m(     0x5E,    ADC_STATS_CTRL,     RW, \
+        /* 0x5E */  uint16_t window_ms; \
+        /* 0x5F */  uint16_t latch : 1; \
+    ) \
+    /*     Addr     Name                RO/RW */ \
+    m(     0x60,    ADC_CAPTURE_DATA,   RO, \
+        /* 0x60-0x7F */ uint16_t mv[32]; \
+    ) \
     /*     Addr     Name            RO/RW */ \
     m(     0x80,    GPIO_CTRL,      RW, \
         /* 0x80 */  uint16_t gpio_ctrl; \
@@ -86,17 +119,43 @@
                     }; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0x86,    GPIO_DIN_CFG,   RW, \
+        /* 0x86-0x8D */ struct { \
+                        uint16_t low_mv; \
+                        uint16_t high_mv; \
+                    } a[4]; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0x90,    WDT,            RW, \
         /* 0x90 */  uint16_t timeout; \
         /* 0x91 */  uint16_t reset : 1; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0x92,    GPIO_DIN_CNT,   RO, \
+        /* 0x92-0x95 */ uint16_t rising[4]; \
+        /* 0x96-0x99 */ uint16_t falling[4]; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0xA0,    POWER_CTRL,     RW, \
         /* 0xA0 */  uint16_t off : 1; \
         /* -//- */  uint16_t reboot : 1; \
         /* -//- */  uint16_t reset_pmic : 1; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0xA1,    BOOT_TIMELINE,  RO, \
+        /* 0xA1-0xA7 */ uint16_t ms[7]; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xA8,    STANDBY_WAKEUP, RO, \
+        /* 0xA8 */  uint16_t wakeups; \
+        /* 0xA9 */  uint16_t last_awake_us; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xAA,    POWER_RESET,    RO, \
+        /* 0xAA */  uint16_t v33_discharge_ms; \
+        /* 0xAB */  uint16_t off_ms; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0xB0,    IRQ_FLAGS,      RO, \
         /* 0xB0 */  uint16_t irqs; \
     ) \
@@ -109,6 +168,19 @@
         /* 0xB4 */  uint16_t irqs; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0xB5,    PWR_SEQ_CFG,    RW, \
+        /* 0xB5 */  uint16_t wait_3v3_ms; \
+        /* 0xB6 */  uint16_t pmic_pwron_ms; \
+        /* 0xB7 */  uint16_t pmic_pwron_pause_ms; \
+        /* 0xB8 */  uint16_t pmic_pwron_attempts; \
+        /* 0xB9 */  uint16_t pmic_reset_ms; \
+        /* 0xBA */  uint16_t reset_min_ms; \
+        /* 0xBB */  uint16_t reset_max_ms; \
+        /* 0xBC */  uint16_t reset_v33_discharged_mv; \
+        /* 0xBD */  uint16_t v33_on_mv; \
+        /* 0xBE */  uint16_t v33_off_mv; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0xC0,    PWR_STATUS,     RO, \
         /* 0xC0 */  uint16_t powered_from_wbmz : 1; \
         /* 0xC0 */  uint16_t wbmz_stepup_enabled : 1; \
@@ -129,12 +201,50 @@
         /* 0xC9 */  int16_t wbmz_temperature; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0xCA,    PWR_SEQ_TIMES,  RO, \
+        /* 0xCA */  uint16_t wait_3v3_ms; \
+        /* 0xCB */  uint16_t pmic_pwron_ms; \
+        /* 0xCC */  uint16_t pmic_pwron_pause_ms; \
+        /* 0xCD */  uint16_t pmic_reset_ms; \
+        /* 0xCE */  uint16_t pmic_pwron_count; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0xD0,    BUZZER_CTRL,    RW, \
         /* 0xD0 */  uint16_t freq_hz; \
         /* 0xD1 */  uint16_t duty_percent; \
         /* 0xD2 */  uint16_t enabled : 1; \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0xD8,    ADC_STATS,      RO, \
+        /* 0xD8 */  uint16_t seq; \
+        /* 0xD9 */  uint16_t count; \
+        /* 0xDA */  uint16_t v_in_min; \
+        /* 0xDB */  uint16_t v_in_max; \
+        /* 0xDC */  uint16_t v_in_avg; \
+        /* 0xDD-0xE8 */ struct { \
+                        uint16_t min; \
+                        uint16_t max; \
+                        uint16_t avg; \
+                    } v_a[4]; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xE9,    CONFIG_CTRL,    RW, \
+        /* 0xE9 */  uint16_t save : 1; \
+        /* 0xE9 */  uint16_t clear : 1; \
+        /* 0xE9 */  uint16_t stored : 1; \
+        /* 0xE9 */  uint16_t error : 1; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xEA,    PERF_CTRL,      RW, \
+        /* 0xEA */  uint16_t reset : 1; \
+        /* 0xEB */  uint16_t first_task; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xEC,    LOG_CTRL,       RW, \
+        /* 0xEC */  uint16_t level_mask; \
+        /* 0xED */  uint16_t read_seq; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0xF0,    TEST,           RW, \
         /* 0xF0 */  uint16_t send_test_message : 1; \
         /* 0xF0 */  uint16_t enable_rtc_out : 1; \
@@ -144,6 +254,20 @@
         /* 0xF0 */  uint16_t wbmz_stepup_en : 1; \
         /* 0xF0 */  uint16_t wbmz_charge_en : 1; \
     ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0xF1,    LOG,            RO, \
+        /* 0xF1 */  uint16_t seq; \
+        /* 0xF2 */  uint16_t count; \
+        /* 0xF3 */  uint16_t pending; \
+        /* 0xF4 */  uint16_t dropped; \
+        /* 0xF5-0xFE */ struct { \
+                        uint16_t id : 8; \
+                        uint16_t level : 8; \
+                        uint16_t timestamp_lo; \
+                        uint16_t timestamp_hi; \
+                        int16_t arg[2]; \
+                    } record[2]; \
+    ) \
     /* UARTs */ \
     /*     Addr     Name            RO/RW */ \
     m(     0x100,   UART_CTRL_MOD1, RW, \
@@ -153,6 +277,23 @@
     m(     0x108,   UART_CTRL_MOD2, RW, \
         /* 0x108 */ struct uart_ctrl ctrl; \
     ) \
+    /* Profiling */ \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x110,   PERF,           RO, \
+        /* 0x110 */ uint16_t tasks_count : 8; \
+        /* 0x110 */ uint16_t first_task : 8; \
+        /* 0x111 */ uint16_t loop_time_us; \
+        /* 0x112 */ uint16_t loop_time_max_us; \
+        /* 0x113 */ uint16_t loop_period_us; \
+        /* 0x114 */ uint16_t loops_per_sec; \
+        /* 0x115 */ uint16_t load_permille; \
+        /* 0x116 */ uint16_t worst_task; \
+        /* 0x117-0x11F */ struct { \
+                        uint16_t last_us; \
+                        uint16_t max_us; \
+                        uint16_t avg_us; \
+                    } task[3]; \
+    ) \
     /*     Addr     Name            RO/RW */ \
     m(     0x120,   UART_TX_START_MOD1,  RW, \
         /* 0x120 */ struct uart_start_tx start_tx; \
@@ -163,6 +304,34 @@
         /* 0x122    end of the region */ \
     ) \
     /*     Addr     Name            RO/RW */ \
+    m(     0x122,   PWR_JOURNAL_CTRL, RW, \
+        /* 0x122 */ uint16_t first_entry; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x123,   PWR_JOURNAL,    RO, \
+        /* 0x123 */ uint16_t count : 8; \
+        /* 0x123 */ uint16_t first_entry : 8; \
+        /* 0x124-0x12F */ struct { \
+                        uint16_t event : 8; \
+                        uint16_t arg : 8; \
+                        uint16_t minutes : 8; \
+                        uint16_t hours : 8; \
+                        uint16_t days : 5; \
+                        uint16_t months : 4; \
+                        uint16_t years : 7; \
+                    } entry[4]; \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x130,   UART_DMX_MOD1,  RW, \
+        /* 0x130 */ struct uart_dmx_window w; \
+        /* 0x152    end of the region */ \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x158,   UART_DMX_MOD2,  RW, \
+        /* 0x158 */ struct uart_dmx_window w; \
+        /* 0x17A    end of the region */ \
+    ) \
+    /*     Addr     Name            RO/RW */ \
     m(     0x180,   UART_EXCHANGE_MOD1,  RW, \
         /* 0x180 */ union uart_exchange e; \
         /* 0x1A0    end of the region */ \
@@ -173,6 +342,26 @@
         /* 0x1A1 */ union uart_exchange e; \
         /* 0x1C1    end of the region */ \
     ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x1C2,   UART_STATS_MOD1,  RO, \
+        /* 0x1C2 */ struct uart_stats stats; \
+        /* 0x1D0    end of the region */ \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x1D0,   UART_ONEWIRE_MOD1,  RW, \
+        /* 0x1D0 */ struct uart_onewire ow; \
+        /* 0x1DF    end of the region */ \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x1E0,   UART_ONEWIRE_MOD2,  RW, \
+        /* 0x1E0 */ struct uart_onewire ow; \
+        /* 0x1EF    end of the region */ \
+    ) \
+    /*     Addr     Name            RO/RW */ \
+    m(     0x1F0,   UART_STATS_MOD2,  RO, \
+        /* 0x1F0 */ struct uart_stats stats; \
+        /* 0x1FE    end of the region */ \
+    ) \
 
 // Общее число регистров в адресном пространстве
 // Число должно быть больше или равно адресу последнего регистра
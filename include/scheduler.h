@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// События, по которым задачи запускаются вне своего периода
+// Могут выставляться из прерываний
+enum scheduler_event {
+    SCHEDULER_EVENT_ADC,            // отфильтрован новый блок данных АЦП
+    SCHEDULER_EVENT_REGMAP,         // закончена внешняя операция с regmap
+
+    SCHEDULER_EVENT_COUNT
+};
+
+#define SCHEDULER_EVENT_MASK(e)         (1U << (e))
+#define SCHEDULER_TASKS_MAX             24
+
+struct scheduler_task {
+    void (*work)(void);
+    // Период запуска, 0 - на каждом пробуждении
+    uint16_t period_ms;
+    // Маска событий SCHEDULER_EVENT_MASK, по которым задача запускается сразу
+    uint8_t events;
+};
+
+// Время выполнения задачи в мкс, значения ограничиваются UINT16_MAX
+struct scheduler_task_perf {
+    uint16_t last_us;
+    uint16_t max_us;
+    uint16_t avg_us;
+};
+
+struct scheduler_loop_perf {
+    uint16_t loop_time_us;          // время последнего прохода по таблице задач
+    uint16_t loop_time_max_us;      // максимальное время прохода
+    uint16_t loop_period_us;        // интервал между началами двух последних проходов (со сном)
+    uint16_t loops_per_sec;         // проходов за последнюю секунду
+    uint16_t load_permille;         // доля времени без сна за последнюю секунду, 0.1%
+};
+
+void scheduler_init(const struct scheduler_task tasks[], uint8_t count);
+void scheduler_set_event(enum scheduler_event e);
+
+// Один проход по таблице задач: запускает задачи, у которых истёк период или пришло событие
+void scheduler_run_pass(void);
+// Засыпает до ближайшего прерывания, если нет необработанных событий
+void scheduler_sleep(void);
+
+void scheduler_run(void) __attribute__((noreturn));
+
+uint8_t scheduler_get_tasks_count(void);
+void scheduler_get_task_perf(uint8_t task, struct scheduler_task_perf *perf);
+void scheduler_get_loop_perf(struct scheduler_loop_perf *perf);
+// Сбрасывает максимумы и средние значения
+void scheduler_reset_perf(void);
@@ -38,6 +38,7 @@ enum mod_gpio_mode shared_gpio_get_mode(enum mod mod, enum mod_gpio mod_gpio);
 
 bool shared_gpio_test(enum mod mod, enum mod_gpio mod_gpio);
 void shared_gpio_set_value(enum mod mod, enum mod_gpio mod_gpio, bool value);
+void shared_gpio_set_open_drain(enum mod mod, enum mod_gpio mod_gpio, bool open_drain);
 
 #else
 
@@ -6,3 +6,4 @@ typedef uint32_t systime_t;
 void systick_init(void);
 systime_t systick_get_system_time_ms(void);
 systime_t systick_get_time_since_timestamp(systime_t timestamp);
+uint32_t systick_get_time_us(void);
@@ -18,6 +18,8 @@ struct circ_buf_rx {
 struct circ_buf_tx {
     struct circ_buf_index i;
     uint8_t data[UART_REGMAP_CIRC_BUFFER_SIZE];
+    // 9-й бит каждого байта (используется только в режиме 9 бит данных)
+    uint8_t bit8[UART_REGMAP_CIRC_BUFFER_SIZE / 8];
 };
 
 static inline void circ_buffer_reset(struct circ_buf_index *i)
@@ -46,19 +48,29 @@ static inline void circ_buffer_tail_inc(struct circ_buf_index *i)
     i->tail++;
 }
 
-static inline void circ_buffer_tx_push(struct circ_buf_tx *buf, uint8_t byte)
+// Принимает слово до 9 бит, 9-й бит хранится отдельно в битовом массиве
+static inline void circ_buffer_tx_push(struct circ_buf_tx *buf, uint16_t word)
 {
     uint16_t byte_pos = buf->i.head % UART_REGMAP_CIRC_BUFFER_SIZE;
+    uint8_t bit8_mask = 1 << (byte_pos % 8);
     circ_buffer_head_inc(&buf->i);
-    buf->data[byte_pos] = byte;
+    buf->data[byte_pos] = word;
+    if (word & 0x100) {
+        buf->bit8[byte_pos / 8] |= bit8_mask;
+    } else {
+        buf->bit8[byte_pos / 8] &= ~bit8_mask;
+    }
 }
 
 static inline uint16_t circ_buffer_tx_pop(struct circ_buf_tx *buf)
 {
     uint16_t byte_pos = buf->i.tail % UART_REGMAP_CIRC_BUFFER_SIZE;
-    uint16_t byte = buf->data[byte_pos];
+    uint16_t word = buf->data[byte_pos];
+    if (buf->bit8[byte_pos / 8] & (1 << (byte_pos % 8))) {
+        word |= 0x100;
+    }
     circ_buffer_tail_inc(&buf->i);
-    return byte;
+    return word;
 }
 
 static inline void circ_buffer_rx_push(struct circ_buf_rx *buf, const union uart_rx_byte_w_errors *data)
@@ -4,6 +4,44 @@
 #include "wbmcu_system.h"
 #include "regmap-int.h"
 #include "uart-circ-buffer.h"
+#include "systick.h"
+#include "shared-gpio.h"
+
+enum uart_dmx_state {
+    UART_DMX_STATE_IDLE = 0,
+    UART_DMX_STATE_BREAK,
+    UART_DMX_STATE_DATA,
+    UART_DMX_STATE_LAST_SLOT,
+};
+
+// Состояние передатчика DMX512
+// Universe хранится в буфере circ_buf_tx.data, который в режиме DMX не используется
+struct uart_dmx_ctx {
+    enum uart_dmx_state state;
+    uint16_t slot;
+    systime_t frame_timestamp;
+};
+
+// Состояние мастера 1-Wire
+// Биты тайм-слотов передаются через буфер circ_buf_tx.data, кеш найденных устройств
+// хранится в буфере circ_buf_rx.data - в режиме 1-Wire оба буфера не используются
+struct uart_onewire_ctx {
+    struct uart_onewire pub;
+    bool pub_changed;
+    uint8_t cmd;
+    uint8_t step;
+    uint8_t dev;
+    // задание для прерывания: передать job_len символов, принятые символы пишутся на их место
+    volatile uint16_t job_pos;
+    uint16_t job_len;
+    systime_t job_timestamp;
+    systime_t convert_timestamp;
+    // состояние алгоритма SEARCH ROM
+    uint8_t search_rom[8];
+    uint8_t search_bit;
+    uint8_t search_last_zero;
+    uint8_t search_last_discrepancy;
+};
 
 struct uart_ctx {
     struct circ_buf_tx circ_buf_tx;
@@ -15,8 +53,18 @@ struct uart_ctx {
     bool tx_completed;
     bool want_to_tx;
     bool rx_during_tx;
+    // байт потерян из-за переполнения кольцевого буфера, следующий принятый байт получит флаг ORE
     bool rx_buf_overflow;
+    // кольцевой буфер переполнен и ещё ни один байт после этого в него не поместился
+    bool rx_buf_overflowing;
     int tx_bytes_count_in_prev_exchange;
+    // при последнем сборе данных буфер regmap заполнен или следующий байт требует формата с ошибками
+    bool rx_regmap_full;
+    // время приёма первого байта, ожидающего передачи в линукс (для объединения прерываний)
+    systime_t rx_pending_timestamp;
+    struct uart_dmx_ctx dmx;
+    struct uart_onewire_ctx onewire;
+    struct uart_stats stats;
 };
 
 struct uart_descr {
@@ -25,6 +73,10 @@ struct uart_descr {
     enum regmap_region ctrl_region;
     enum regmap_region start_tx_region;
     enum regmap_region exchange_region;
+    enum regmap_region dmx_region;
+    enum regmap_region onewire_region;
+    enum regmap_region stats_region;
+    enum mod mod;
     struct uart_ctx *ctx;
 };
 
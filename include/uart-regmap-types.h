@@ -3,6 +3,33 @@
 
 #define UART_REGMAP_BUFFER_SIZE             64
 
+// DMX512: количество каналов в universe и размер окна для записи каналов из линукса
+#define UART_DMX_UNIVERSE_SIZE              512
+#define UART_DMX_WINDOW_SIZE                64
+
+enum uart_mode {
+    UART_MODE_UART = 0,
+    // Передатчик DMX512: непрерывно передаёт universe из региона UART_DMX
+    UART_MODE_DMX = 1,
+    // Мастер шины 1-Wire: USART в режиме half-duplex, команды и результаты в регионе UART_ONEWIRE
+    UART_MODE_ONEWIRE = 2,
+
+    UART_MODE_MAX_VALUE = UART_MODE_ONEWIRE
+};
+
+enum uart_onewire_cmd {
+    UART_ONEWIRE_CMD_NONE = 0,
+    // Поиск всех устройств на шине (SEARCH ROM)
+    UART_ONEWIRE_CMD_SEARCH = 1,
+    // Запуск измерения температуры на всех устройствах (SKIP ROM + CONVERT T)
+    // и чтение результатов всех найденных термодатчиков DS18x20, другие устройства пропускаются
+    UART_ONEWIRE_CMD_CONVERT_ALL = 2,
+    // Чтение scratchpad устройства device_index
+    UART_ONEWIRE_CMD_READ_SCRATCHPAD = 3,
+
+    UART_ONEWIRE_CMD_MAX_VALUE = UART_ONEWIRE_CMD_READ_SCRATCHPAD
+};
+
 enum uart_word_length {
     // Имеется в виду количество бит данных без учёта бита чётности, даже если он включён.
     // Такая логика выбрана для обратной совместимости (ранее было всегда 8 бит), чтобы
@@ -10,8 +37,10 @@ enum uart_word_length {
     // а просто добавлялся бит контроля чётности.
     UART_WORD_LEN_8 = 0,
     UART_WORD_LEN_7 = 1,
+    // 9 бит данных используются только без контроля чётности (multidrop, 9-й бит - признак адреса)
+    UART_WORD_LEN_9 = 2,
 
-    UART_WORD_LEN_MAX_VALUE = UART_WORD_LEN_7
+    UART_WORD_LEN_MAX_VALUE = UART_WORD_LEN_9
 };
 
 enum uart_parity {
@@ -60,8 +89,11 @@ struct uart_rx {
 
 struct uart_tx {
     uint8_t bytes_to_send_count;
-    // регистры 16 бит, зарезервируем 1 байт, чтобы данные начинались с нового регистра
-    uint8_t reserved;
+    // регистры 16 бит, 1 байт под флаги, чтобы данные начинались с нового регистра
+    // флаг означает, что первый байт порции нужно передать с установленным 9-м битом (адресный байт)
+    // используется только в режиме 9 бит данных, в остальных режимах игнорируется
+    uint8_t addr_mark_first : 1;
+    uint8_t reserved : 7;
     uint8_t bytes_to_send[UART_REGMAP_BUFFER_SIZE];
 };
 
@@ -69,6 +101,7 @@ struct uart_ctrl {
     /* offset 0x00 */
     uint16_t enable : 1;
     uint16_t ctrl_applyed : 1;
+    uint16_t mode : 3; // enum uart_mode
     /* offset 0x01 */
     uint16_t baud_x100;
     /* offset 0x02 */
@@ -76,10 +109,93 @@ struct uart_ctrl {
     uint16_t stop_bits : 2;
     uint16_t rs485_enabled : 1;
     uint16_t rs485_rx_during_tx : 1;
-    uint16_t word_length : 2; // reserve 2 bits for 0/1 value for optional adding 6-,9-data bits modes in future
+    uint16_t word_length : 2; // enum uart_word_length
+    // аппаратная фильтрация по адресу в режиме 9 бит (mute mode, address mark detection)
+    uint16_t addr_match_enabled : 1;
+    /* offset 0x03 */
+    uint16_t node_addr : 8;
+    /* offset 0x04 */
+    // объединение прерываний по приёму: прерывание выставляется, когда накоплено irq_min_bytes байт
+    // или с момента приёма первого байта прошло irq_max_hold_ms
+    // 0 в любом из полей - прерывание выставляется сразу по приёму байта
+    uint16_t irq_min_bytes;
+    /* offset 0x05 */
+    uint16_t irq_max_hold_ms;
+    /* offset 0x06 */
+    // только в режиме DMX: количество каналов в кадре (1..512) и частота обновления, Гц (1..44)
+    // скорость и формат кадра в режиме DMX фиксированы: 250 кбит/с, 8N2
+    uint16_t dmx_channels_count;
+    /* offset 0x07 */
+    uint16_t dmx_refresh_hz;
+};
+
+// Статистика порта, счётчики накапливаются с момента старта ЕС и переполняются циклически
+struct uart_stats {
+    /* offset 0x00 */
+    uint32_t tx_bytes;
+    /* offset 0x02 */
+    uint32_t rx_bytes;
+    /* offset 0x04 */
+    uint32_t exchanges;
+    /* offset 0x06 */
+    uint16_t parity_errors;
+    uint16_t framing_errors;
+    uint16_t noise_errors;
+    uint16_t overrun_errors;
+    // переполнения кольцевого буфера приёма ЕС (данные потеряны)
+    uint16_t rx_buf_overflows;
+    /* offset 0x0B */
+    // максимальная заполненность кольцевых буферов ЕС, байт
+    uint16_t rx_buf_peak;
+    uint16_t tx_buf_peak;
+    uint16_t reserved;
+};
+
+// Окно записи каналов DMX512
+// Линукс записывает только изменившиеся каналы: номер первого канала, количество и значения
+struct uart_dmx_window {
+    // номер первого канала окна, 0 - первый канал после стартового кода
+    uint16_t first_channel;
+    uint16_t channels_count;
+    uint8_t data[UART_DMX_WINDOW_SIZE];
 };
 
 union uart_exchange {
     struct uart_rx rx;
     struct uart_tx tx;
 };
+
+// Команды и результаты мастера 1-Wire
+// Линукс записывает cmd и/или device_index, сбросив applyed в 0; ЕС принимает команду,
+// сбрасывает cmd в 0 и устанавливает applyed в 1. Результаты для устройства device_index
+// (ROM, температура, scratchpad) берутся из кеша ЕС и доступны сразу.
+struct uart_onewire {
+    /* offset 0x00 */
+    uint16_t cmd; // enum uart_onewire_cmd
+    /* offset 0x01 */
+    uint16_t applyed : 1;
+    // выполняется команда
+    uint16_t busy : 1;
+    // при последней команде не получен presence pulse
+    uint16_t no_presence : 1;
+    // при последней команде была ошибка CRC или шина не отвечает
+    uint16_t bus_error : 1;
+    uint16_t reserved : 4;
+    uint16_t devices_count : 8;
+    /* offset 0x02 */
+    uint16_t device_index;
+    /* offset 0x03 */
+    uint8_t rom[8];
+    /* offset 0x07 */
+    // температура в единицах 1/16 °C (формат DS18B20)
+    int16_t temperature;
+    /* offset 0x08 */
+    uint16_t temperature_valid : 1;
+    uint16_t reserved2 : 15;
+    /* offset 0x09 */
+    uint8_t scratchpad[9];
+    uint8_t reserved3;
+    /* offset 0x0E */
+    // период автоматического измерения температуры всех датчиков, с; 0 - выключено
+    uint16_t auto_convert_period_s;
+};
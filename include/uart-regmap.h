@@ -7,3 +7,14 @@ void uart_regmap_process_irq(const struct uart_descr *u);
 void uart_regmap_process_ctrl(const struct uart_descr *u, const struct uart_ctrl *ctrl);
 void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u);
 bool uart_regmap_is_irq_needed(const struct uart_descr *u);
+
+void uart_dmx_start(const struct uart_descr *u);
+void uart_dmx_clear_universe(const struct uart_descr *u);
+void uart_dmx_process_irq(const struct uart_descr *u);
+void uart_dmx_process_window(const struct uart_descr *u, const struct uart_dmx_window *w);
+void uart_dmx_do_periodic_work(const struct uart_descr *u);
+
+void uart_onewire_start(const struct uart_descr *u);
+void uart_onewire_process_irq(const struct uart_descr *u);
+void uart_onewire_process_region(const struct uart_descr *u, const struct uart_onewire *ow);
+void uart_onewire_do_periodic_work(const struct uart_descr *u);
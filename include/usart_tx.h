@@ -1,10 +1,17 @@
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 
 void usart_tx_init(void);
 void usart_tx_deinit(void);
 
-// Transmits buffer with given size
-void usart_tx_buf_blocking(const void * buf, size_t size);
-// Transmits null-terminated string
-void usart_tx_str_blocking(const char str[]);
+// Queues buffer with given size, drops it if there is no space in TX buffer
+void usart_tx_buf(const void * buf, size_t size);
+// Queues null-terminated string
+void usart_tx_str(const char str[]);
+// Blocks until all queued data is transmitted (interrupts stay enabled)
+// Only for standby and UART deinit paths: may take tens of ms
+void usart_tx_flush(void);
+
+size_t usart_tx_get_free_space(void);
+uint32_t usart_tx_get_dropped_bytes(void);
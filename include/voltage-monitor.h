@@ -15,4 +15,8 @@ void vmon_init(void);
 bool vmon_ready(void);
 bool vmon_get_ch_status(enum vmon_channel ch);
 bool vmon_check_ch_once(enum vmon_channel ch);
+// Проверка канала по порогам OK однократным измерением, до инициализации АЦП (adc_measure_once_mv)
+bool vmon_check_ch_fast(enum vmon_channel ch);
+// Запрет watchdog АЦП канала на время штатного отключения питания
+void vmon_awd_inhibit(enum vmon_channel ch, bool inhibit);
 void vmon_do_periodic_work(void);
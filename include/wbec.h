@@ -1,4 +1,5 @@
 #pragma once
 
+void wbec_periodic_wakeup_fast_path(void);
 void wbec_init(void);
 void wbec_do_periodic_work(void);
@@ -0,0 +1,117 @@
+#include "adc-subsystem.h"
+#include "adc.h"
+#include "regmap-int.h"
+#include "array_size.h"
+#include "systick.h"
+#include <assert.h>
+
+/**
+ * Модуль связывает с regmap настройки и статистику аналоговых каналов
+ *
+ * ADC_FILTER: для каждого входа A1-A4 постоянная RC lowpass фильтра в мс
+ * и окно медианного фильтра (0 или 1 - выключен, 3 или 5 измерений)
+ * Значения ограничиваются допустимыми и записываются обратно в regmap
+ *
+ * ADC_STATS: минимум, максимум и среднее V_IN и A1-A4 в mV и количество измерений.
+ * Статистика забирается из АЦП (и накопление начинается заново):
+ *  - по записи latch = 1 в ADC_STATS_CTRL
+ *  - по истечении window_ms, если окно задано (0 - только по latch)
+ * Каждый раз seq увеличивается, по нему линукс понимает, что данные обновились.
+ */
+
+static const enum adc_channel analog_inputs[] = {
+    ADC_CHANNEL_ADC_IN1,
+    ADC_CHANNEL_ADC_IN2,
+    ADC_CHANNEL_ADC_IN3,
+    ADC_CHANNEL_ADC_IN4,
+};
+
+static_assert(ADC_STATS_CHANNEL_IN1 + 3 == ADC_STATS_CHANNEL_IN4, "ADC_STATS expects A1-A4 stats channels in a row");
+
+static struct {
+    uint16_t window_ms;
+    systime_t window_timestamp;
+    uint16_t seq;
+    // Статистика уже забрана из АЦП, поэтому повторяем запись, пока regmap занят
+    struct REGMAP_ADC_STATS regs;
+    bool publish_pending;
+} stats_ctx;
+
+static void take_stats(void)
+{
+    struct adc_stats st[ADC_STATS_CHANNEL_COUNT];
+    adc_stats_take(st);
+
+    struct REGMAP_ADC_STATS *r = &stats_ctx.regs;
+    r->seq = ++stats_ctx.seq;
+    r->count = st[ADC_STATS_CHANNEL_V_IN].count;
+    r->v_in_min = st[ADC_STATS_CHANNEL_V_IN].min_mv;
+    r->v_in_max = st[ADC_STATS_CHANNEL_V_IN].max_mv;
+    r->v_in_avg = st[ADC_STATS_CHANNEL_V_IN].avg_mv;
+    for (unsigned i = 0; i < ARRAY_SIZE(r->v_a); i++) {
+        r->v_a[i].min = st[ADC_STATS_CHANNEL_IN1 + i].min_mv;
+        r->v_a[i].max = st[ADC_STATS_CHANNEL_IN1 + i].max_mv;
+        r->v_a[i].avg = st[ADC_STATS_CHANNEL_IN1 + i].avg_mv;
+    }
+    stats_ctx.publish_pending = true;
+
+    stats_ctx.window_timestamp = systick_get_system_time_ms();
+}
+
+static void publish_filter_settings(void)
+{
+    struct REGMAP_ADC_FILTER f;
+    for (unsigned i = 0; i < ARRAY_SIZE(analog_inputs); i++) {
+        f.rc_ms[i] = adc_get_lowpass_rc(analog_inputs[i]);
+        f.median_window[i] = adc_get_median_window(analog_inputs[i]);
+    }
+    regmap_set_region_data(REGMAP_REGION_ADC_FILTER, &f, sizeof(f));
+}
+
+void adc_subsystem_init(void)
+{
+    publish_filter_settings();
+
+    stats_ctx.window_ms = 0;
+    stats_ctx.seq = 0;
+    stats_ctx.publish_pending = false;
+    stats_ctx.window_timestamp = systick_get_system_time_ms();
+}
+
+void adc_subsystem_do_periodic_work(void)
+{
+    struct REGMAP_ADC_FILTER f;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_ADC_FILTER, &f, sizeof(f))) {
+        for (unsigned i = 0; i < ARRAY_SIZE(analog_inputs); i++) {
+            if (f.rc_ms[i] != adc_get_lowpass_rc(analog_inputs[i])) {
+                adc_set_lowpass_rc(analog_inputs[i], f.rc_ms[i]);
+            }
+            if (f.median_window[i] != adc_get_median_window(analog_inputs[i])) {
+                adc_set_median_window(analog_inputs[i], f.median_window[i]);
+            }
+        }
+        publish_filter_settings();
+    }
+
+    struct REGMAP_ADC_STATS_CTRL sc;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_ADC_STATS_CTRL, &sc, sizeof(sc))) {
+        stats_ctx.window_ms = sc.window_ms;
+        if (sc.latch) {
+            take_stats();
+        }
+        sc.latch = 0;
+        regmap_set_region_data(REGMAP_REGION_ADC_STATS_CTRL, &sc, sizeof(sc));
+    }
+
+    if ((stats_ctx.window_ms) &&
+        (systick_get_time_since_timestamp(stats_ctx.window_timestamp) >= stats_ctx.window_ms))
+    {
+        take_stats();
+    }
+
+    if (stats_ctx.publish_pending) {
+        if (regmap_set_region_data(REGMAP_REGION_ADC_STATS, &stats_ctx.regs, sizeof(stats_ctx.regs))) {
+            stats_ctx.publish_pending = false;
+        }
+    }
+}
@@ -3,59 +3,194 @@
 #include "gpio.h"
 #include "config.h"
 #include <stdbool.h>
-#include "systick.h"
 #include "rcc.h"
 #include <assert.h>
+#include "atomic.h"
+#include "fixmath-fast.h"
+#include "scheduler.h"
 
 /**
  * Модуль занимается опросом каналов АЦП и фильтрацией данных
- * АЦП работает непрерывно и через DMA складывает данные в память
  *
- * Функция adc_do_periodic_work вызывается из основного цикла и выполняет
- * инициализацию lowpass фильтра и фильтрацию значений
+ * Опрос всех каналов запускается таймером TIM1 с периодом ADC_SAMPLE_PERIOD_US,
+ * DMA складывает результаты в кольцевой буфер из двух половин (ping-pong)
+ * по ADC_BLOCK_SEQUENCES опросов в каждой. По прерыванию DMA о заполнении половины
+ * буфера значения каналов пропускаются через медианный фильтр (если включен для канала),
+ * усредняются по блоку и подаются на lowpass фильтр.
+ * Таким образом фильтр работает с постоянным периодом ADC_FILTRATION_PERIOD_MS
+ * и не зависит от длительности основного цикла.
  *
- * Функция adc_get_ch_mv позволяет получить значение в mV
+ * Lowpass фильтр инициализируется первым опросом (прерывание АЦП по окончании
+ * последовательности, используется только один раз)
+ *
+ * Функция adc_do_periodic_work вызывается из основного цикла и после каждого нового блока
+ * пересчитывает коэффициент коррекции по внутреннему VREF и таблицу значений каналов в mV
+ *
+ * Функция adc_get_ch_mv позволяет получить значение в mV из этой таблицы,
+ * вычислений при чтении нет (кроме добавления оффсета)
  *
  * Конфигурация каналов задается макросом:
  *
  * #define ADC_CHANNELS_DESC(macro) \
- *          Channel name          ADC CH  PORT    PIN     RC      K                 \
- *    macro(ADC_IN1,              10,     GPIOB,  2,      50,     1               ) \
- *    macro(ADC_IN2,              11,     GPIOB,  10,     50,     1.0 / 11.0      ) \
+ *          Channel name          ADC CH  PORT    PIN     RC      K               SMP             \
+ *    macro(ADC_IN1,              10,     GPIOB,  2,      50,     1,              ADC_SMP_LONG    ) \
+ *    macro(ADC_IN2,              11,     GPIOB,  10,     50,     1.0 / 11.0,     ADC_SMP_SHORT   ) \
  *
  * Channel name - имя канала, превращается в enum ADC_CHANNEL_<name>
  * ADC CH - номер канала АЦП МК
  * PORT, PIN - GPIO
- * RC - постоянная RC (можно поменять в рантайме)
+ * RC - постоянная RC (можно поменять в рантайме, adc_set_lowpass_rc)
  * K - коэффициент пересчёта (делитель, в примере выше 1к + 10к). Если делителя нет, указать 1
+ * SMP - время выборки: ADC_SMP_LONG для высокоомных источников, ADC_SMP_SHORT для низкоомных
  *
  * Если используются внутренние каналы, то вместо PORT и PIN указать ADC_NO_GPIO_PIN
+ *
+ * Медианный фильтр по ADC_MEDIAN_WINDOW_MAX последним измерениям отбрасывает одиночные выбросы,
+ * не увеличивая постоянную времени lowpass фильтра. По умолчанию выключен,
+ * включается в рантайме через adc_set_median_window
+ *
+ * АЦП использует аппаратный oversampling: каждый результат - сумма ADC_OVERSAMPLING_RATIO
+ * измерений, т.е. на ADC_OVERSAMPLING_EXTRA_BITS больше разрядов, чем у самого АЦП.
+ * Дополнительные разряды сохраняются в дробной части значений фильтра.
+ *
+ * Аналоговые watchdog (AWD1..3) позволяют без участия основного цикла заметить выход
+ * канала за пороги: проверяется каждый опрос, т.е. реакция - не более ADC_SAMPLE_PERIOD_US.
+ * Пороги задаются в mV через adc_awd_setup() и пересчитываются в коды АЦП после инициализации
+ * (нужен коэффициент коррекции по VREF). Записывать настройки watchdog можно только
+ * при остановленном АЦП, поэтому они применяются в прерывании DMA, между опросами.
+ * Сработавший watchdog отключает своё прерывание и вызывает обработчик,
+ * повторно его взводит adc_awd_rearm(), adc_awd_disarm() отключает прерывание без срабатывания.
+ *
+ * Захват осциллограммы (brownout capture): после adc_capture_arm() результаты каждого опроса
+ * каналов V_IN, 5V, 3V3 без фильтрации пишутся в кольцевой буфер на ADC_CAPTURE_DEPTH измерений.
+ * Событие - падение канала ниже порога захвата или вызов adc_capture_trigger().
+ * После события записывается заданное количество измерений, затем буфер замораживается
+ * до следующего adc_capture_arm(). Запись и проверка порогов выполняются в прерывании DMA.
+ *
+ * Статистика: для каналов из enum adc_stats_channel в прерывании DMA накапливаются минимум,
+ * максимум и сумма средних по блоку значений (до lowpass фильтра). adc_stats_take()
+ * забирает накопленное и начинает накопление заново.
+ *
+ * Цифровые входы: средние по блоку значения A1-A4 сравниваются с порогами с гистерезисом
+ * (выше high - "1", ниже low - "0"), переключения подсчитываются. Аппаратные watchdog
+ * заняты мониторингом питания, поэтому сравнение программное, в прерывании DMA,
+ * т.е. с периодом ADC_FILTRATION_PERIOD_MS.
 */
 
 #define ADC_FILTRATION_PERIOD_MS        5
+// Количество опросов всех каналов в половине буфера DMA (должно быть степенью двойки)
+#define ADC_BLOCK_SEQUENCES_BITS        2
+#define ADC_BLOCK_SEQUENCES             (1 << ADC_BLOCK_SEQUENCES_BITS)
+#define ADC_SAMPLE_PERIOD_US            (ADC_FILTRATION_PERIOD_MS * 1000 / ADC_BLOCK_SEQUENCES)
+#define ADC_DMA_BUFFER_LEN              (2 * ADC_BLOCK_SEQUENCES * ADC_CHANNEL_COUNT)
 #define ADC_NO_GPIO_PIN                 0
 #define ADC_RESOLUTION_BIT              12
 
+// Oversampling x4 без сдвига: результат 14 бит
+// Коэффициент выбран так, чтобы полный цикл опроса каналов на частоте АЦП 1 МГц укладывался
+// примерно в период фильтрации и не затягивал первое измерение при старте
+#define ADC_OVERSAMPLING_RATIO_BITS     2
+#define ADC_OVERSAMPLING_SHIFT          0
+#define ADC_OVERSAMPLING_RATIO          (1 << ADC_OVERSAMPLING_RATIO_BITS)
+#define ADC_OVERSAMPLING_EXTRA_BITS     (ADC_OVERSAMPLING_RATIO_BITS - ADC_OVERSAMPLING_SHIFT)
+
+// Watchdog сравнивает с 12-битными порогами старшие биты 16-битного результата
+// oversampling (ADC_DR[15:4]), т.е. порог грубее 12-битного кода на ADC_AWD_THRESHOLD_SHIFT бит
+#define ADC_AWD_THRESHOLD_SHIFT         (16 - ADC_RESOLUTION_BIT - ADC_OVERSAMPLING_EXTRA_BITS)
+#define ADC_AWD_THRESHOLD_MAX           ADC_AWD1TR_LT1_Msk
+
+#define ADC_SMP_LONG_CYCLES_CODE        7   // 160.5 ADC clock cycles
+#define ADC_SMP_SHORT_CYCLES_CODE       2   // 12.5 ADC clock cycles
+
 #define ADC_CH_FULL_SCALE_MV(k)         (ADC_VREF_EXT_MV * (k)) // max measure voltage
 
 #define ADC_INT_VREF_FACTORY_CAL_MV     3000
 #define ADC_INT_VREF_CAL_VALUE          (*((uint16_t*)0x1FFF75AA))
 
+static_assert((ADC_CAPTURE_DEPTH & (ADC_CAPTURE_DEPTH - 1)) == 0, "ADC_CAPTURE_DEPTH must be power of 2");
+static_assert(ADC_CAPTURE_DEPTH <= 256, "ADC_CAPTURE_DEPTH must fit into uint8_t index");
+
 struct adc_ctx {
     bool initialized;
+    // Коэффициент калибровки сохраняется между вызовами adc_init
+    bool calibrated;
+    uint8_t calfact;
+    // новый блок отфильтрован в прерывании DMA
+    volatile bool block_ready;
     enum adc_vref vref;
-    systime_t timestamp;
-    uint16_t raw_values[ADC_CHANNEL_COUNT];
+    uint16_t raw_values[ADC_DMA_BUFFER_LEN];
     fix16_t  lowpass_values[ADC_CHANNEL_COUNT];
     fix16_t  lowpass_factors[ADC_CHANNEL_COUNT];
+    // Медианный фильтр: последние измерения каждого канала, новые в начале
+    uint16_t median_history[ADC_CHANNEL_COUNT][ADC_MEDIAN_WINDOW_MAX - 1];
+    uint8_t median_window[ADC_CHANNEL_COUNT];
+    uint16_t lowpass_rc_ms[ADC_CHANNEL_COUNT];
     int16_t offset_mv[ADC_CHANNEL_COUNT];
+    // Значения каналов в mV без оффсета, пересчитываются раз в период фильтрации
+    // Индексы - номера каналов
+    int32_t mv[ADC_CHANNEL_COUNT];
+    fix16_t mv_f16[ADC_CHANNEL_COUNT];
     fix16_t int_vref_coeff;
+    // 1 / int_vref_coeff, для обратного пересчёта mV в единицы АЦП
+    fix16_t int_vref_coeff_inv;
+    // ADC_INT_VREF_CAL_VALUE / INT_VREF, уточняется итерацией Ньютона
+    fix16_t int_vref_k;
+    // 1 / ADC_INT_VREF_CAL_VALUE в формате Q0.32
+    uint32_t int_vref_cal_recip;
+    // Настройки watchdog: заполняются в основном цикле, применяются в прерывании DMA
+    struct {
+        bool enabled;
+        enum adc_channel channel;
+        int32_t low_mv;
+        int32_t high_mv;
+        uint32_t tr;
+    } awd[ADC_AWD_COUNT];
+    uint32_t awd_cfgr1;
+    uint32_t awd_cr[ADC_AWD_COUNT];
+    bool awd_setup_changed;
+    volatile bool awd_apply_pending;
+    adc_awd_handler_t awd_handler;
+    struct {
+        volatile enum adc_capture_state state;
+        enum adc_capture_trigger trigger;
+        enum adc_capture_channel trigger_channel;
+        uint16_t samples[ADC_CAPTURE_DEPTH][ADC_CAPTURE_CHANNEL_COUNT];
+        uint8_t pos;
+        uint8_t count;
+        uint8_t trigger_pos;
+        uint8_t post_trigger_samples;
+        uint8_t post_trigger_left;
+        int32_t threshold_mv[ADC_CAPTURE_CHANNEL_COUNT];
+        // порог в единицах результата АЦП с oversampling, 0 - порог выключен
+        uint16_t threshold_raw[ADC_CAPTURE_CHANNEL_COUNT];
+        bool threshold_changed;
+    } capture;
+    struct {
+        uint16_t min[ADC_STATS_CHANNEL_COUNT];
+        uint16_t max[ADC_STATS_CHANNEL_COUNT];
+        uint32_t sum[ADC_STATS_CHANNEL_COUNT];
+        uint16_t count;
+    } stats;
+    struct {
+        int32_t low_mv[ADC_DIN_COUNT];
+        int32_t high_mv[ADC_DIN_COUNT];
+        // пороги в единицах результата АЦП с oversampling
+        uint16_t low_raw[ADC_DIN_COUNT];
+        uint16_t high_raw[ADC_DIN_COUNT];
+        uint8_t enabled;
+        // состояние входа определено (после изменения порогов первое сравнение не считается фронтом)
+        uint8_t valid;
+        volatile uint8_t states;
+        volatile uint16_t rising_count[ADC_DIN_COUNT];
+        volatile uint16_t falling_count[ADC_DIN_COUNT];
+        bool threshold_changed;
+    } din;
 };
 
 static struct adc_ctx adc_ctx = {};
 
-#define ADC_CHANNEL_DATA(alias, ch_num, port, pin, rc_factor, k) \
-    { ADC_CHSELR_CHSEL##ch_num, port, pin, rc_factor, ADC_CH_FULL_SCALE_MV(k) },
+#define ADC_CHANNEL_DATA(alias, ch_num, port, pin, rc_factor, k, smp) \
+    { ADC_CHSELR_CHSEL##ch_num, ch_num, port, pin, rc_factor, ADC_CH_FULL_SCALE_MV(k), F16(ADC_CH_FULL_SCALE_MV(k) / 4095.0), smp },
 
 /* This buffer contain order number in dma read sequence adc channels for each record in struct adc_channel adc_ch. It is set in runtime in adc_init() */
 static uint8_t chan_index_in_dma_buff[ADC_CHANNEL_COUNT] = {};
@@ -63,39 +198,87 @@ static uint8_t chan_index_in_dma_buff[ADC_CHANNEL_COUNT] = {};
 
 struct adc_config_record {
     uint32_t channel;
+    uint8_t ch_num;
     GPIO_TypeDef *port;
     uint8_t pin;
     uint32_t rc_factor;
     uint32_t full_scale_mv;
+    // mV на единицу 12-битного АЦП, считается при компиляции из колонки K
+    fix16_t mv_per_lsb;
+    uint8_t smp;
 };
 
 static const struct adc_config_record adc_cfg[ADC_CHANNEL_COUNT] = {
     ADC_CHANNELS_DESC(ADC_CHANNEL_DATA)
 };
 
-static inline void update_int_vref_coeff(void)
+static const enum adc_channel capture_channels[ADC_CAPTURE_CHANNEL_COUNT] = {
+    [ADC_CAPTURE_CHANNEL_V_IN] = ADC_CHANNEL_ADC_V_IN,
+    [ADC_CAPTURE_CHANNEL_5V] = ADC_CHANNEL_ADC_5V,
+    [ADC_CAPTURE_CHANNEL_3V3] = ADC_CHANNEL_ADC_3V3,
+};
+
+static const enum adc_channel stats_channels[ADC_STATS_CHANNEL_COUNT] = {
+    [ADC_STATS_CHANNEL_V_IN] = ADC_CHANNEL_ADC_V_IN,
+    [ADC_STATS_CHANNEL_IN1] = ADC_CHANNEL_ADC_IN1,
+    [ADC_STATS_CHANNEL_IN2] = ADC_CHANNEL_ADC_IN2,
+    [ADC_STATS_CHANNEL_IN3] = ADC_CHANNEL_ADC_IN3,
+    [ADC_STATS_CHANNEL_IN4] = ADC_CHANNEL_ADC_IN4,
+};
+
+static const enum adc_channel din_channels[ADC_DIN_COUNT] = {
+    [ADC_DIN_A1] = ADC_CHANNEL_ADC_IN1,
+    [ADC_DIN_A2] = ADC_CHANNEL_ADC_IN2,
+    [ADC_DIN_A3] = ADC_CHANNEL_ADC_IN3,
+    [ADC_DIN_A4] = ADC_CHANNEL_ADC_IN4,
+};
+
+// Переводит результат АЦП с oversampling в единицы 12-битного АЦП в формате fix16
+// Дополнительные разряды oversampling попадают в дробную часть
+static inline fix16_t adc_raw_to_fix16(uint16_t raw)
+{
+    return (fix16_t)raw << (16 - ADC_OVERSAMPLING_EXTRA_BITS);
+}
+
+// Отношение INT_VREF / ADC_INT_VREF_CAL_VALUE, около 1
+static inline fix16_t get_int_vref_ratio(void)
 {
-    // Вызывается из прерывания DMA только 1 раз (первый) во время инициализации lowpass фильтра
-    // Далее вызывается в основном цикле из adc_do_periodic_work
     fix16_t int_vref_value = adc_ctx.lowpass_values[ADC_CHANNEL_INDEX(ADC_CHANNEL_ADC_INT_VREF)];
-    fix16_t int_vref_cal = fix16_from_int(ADC_INT_VREF_CAL_VALUE);
+    return u32_mul_recip_q32(int_vref_value, adc_ctx.int_vref_cal_recip);
+}
+
+static inline void set_int_vref_k(fix16_t int_vref_ratio, fix16_t k_vref)
+{
     fix16_t k_int_ext = F16((float)ADC_INT_VREF_FACTORY_CAL_MV / ADC_VREF_EXT_MV);
-    fix16_t k_vref = fix16_div(int_vref_cal, int_vref_value);
+    fix16_t k_ext_int = F16((float)ADC_VREF_EXT_MV / ADC_INT_VREF_FACTORY_CAL_MV);
+
+    adc_ctx.int_vref_k = k_vref;
     adc_ctx.int_vref_coeff = fix16_mul(k_int_ext, k_vref);
+    adc_ctx.int_vref_coeff_inv = fix16_mul(k_ext_int, int_vref_ratio);
+}
+
+// Вызывается из прерывания DMA только 1 раз (первый) во время инициализации lowpass фильтра
+static void init_int_vref_coeff(void)
+{
+    adc_ctx.int_vref_cal_recip = UINT32_MAX / ADC_INT_VREF_CAL_VALUE;
+
+    fix16_t ratio = get_int_vref_ratio();
+    set_int_vref_k(ratio, fix16_div(fix16_one, ratio));
 }
 
+// Вызывается в основном цикле из adc_do_periodic_work на каждый новый блок
+// INT_VREF за период фильтрации меняется мало, поэтому вместо деления
+// достаточно одного шага итерации Ньютона от предыдущего значения
+static inline void update_int_vref_coeff(void)
+{
+    fix16_t ratio = get_int_vref_ratio();
+    set_int_vref_k(ratio, fix16_recip_nr_step(ratio, adc_ctx.int_vref_k));
+}
+
+// Коэффициент RC фильтра T / (T + tau), T - период фильтрации
 static inline fix16_t calculate_rc_factor(uint32_t tau_ms)
 {
-    return fix16_div(
-        fix16_one,
-        fix16_add(
-            fix16_one,
-            fix16_div(
-                fix16_from_int(tau_ms),
-                fix16_from_int(ADC_FILTRATION_PERIOD_MS)
-            )
-        )
-    );
+    return ((uint32_t)ADC_FILTRATION_PERIOD_MS << 16) / (ADC_FILTRATION_PERIOD_MS + tau_ms);
 }
 
 // Not precise!
@@ -108,25 +291,467 @@ static inline void delay_blocking_us(uint32_t us)
     }
 }
 
-static void dma_end_transfer_irq(void)
+// Переводит mV на входе делителя в единицы 12-битного АЦП с учётом оффсета и коррекции по VREF
+// Значения выше шкалы АЦП ограничиваются (1 << ADC_RESOLUTION_BIT)
+static uint32_t mv_to_adc_raw(enum adc_channel channel, int32_t mv)
+{
+    int32_t mv_in = mv - adc_ctx.offset_mv[channel];
+    if (mv_in <= 0) {
+        return 0;
+    }
+    uint32_t raw_value = ((uint32_t)mv_in << ADC_RESOLUTION_BIT) / adc_cfg[channel].full_scale_mv;
+    if (raw_value > (1 << ADC_RESOLUTION_BIT)) {
+        return (1 << ADC_RESOLUTION_BIT);
+    }
+    if (adc_ctx.vref == ADC_VREF_INT) {
+        raw_value = fix16_to_int(fix16_mul(fix16_from_int(raw_value), adc_ctx.int_vref_coeff_inv));
+    }
+    return raw_value;
+}
+
+// Переводит единицы АЦП в формате fix16 в mV с учётом делителя (K), без оффсета
+static int32_t adc_raw_to_mv(enum adc_channel channel, fix16_t ch_raw)
+{
+    uint32_t raw_value;
+    if (adc_ctx.vref == ADC_VREF_INT) {
+        raw_value = fix16_to_int(
+            fix16_mul(ch_raw, adc_ctx.int_vref_coeff)
+        );
+    } else {
+        raw_value = fix16_to_int(ch_raw);
+    }
+    // full_scale_mv - коэффициент из расчета, референс АЦП равен ADC_EXT_VREF_MV
+    return (raw_value * adc_cfg[channel].full_scale_mv) >> ADC_RESOLUTION_BIT;
+}
+
+// Пересчитывает таблицу значений каналов в mV по текущим значениям lowpass фильтра
+static void update_mv_cache(void)
+{
+    for (enum adc_channel ch = 0; ch < ADC_CHANNEL_COUNT; ch++) {
+        fix16_t ch_raw = adc_ctx.lowpass_values[ADC_CHANNEL_INDEX(ch)];
+
+        adc_ctx.mv[ch] = adc_raw_to_mv(ch, ch_raw);
+
+        if (adc_ctx.vref == ADC_VREF_INT) {
+            ch_raw = fix16_mul(ch_raw, adc_ctx.int_vref_coeff);
+        }
+        adc_ctx.mv_f16[ch] = fix16_mul(ch_raw, adc_cfg[ch].mv_per_lsb);
+    }
+}
+
+static void adc_end_of_sequence_irq(void)
 {
     // Disable IRQ - it needed only for first measurement
-    DMA1->IFCR = DMA_IFCR_CGIF1;
-    DMA1_Channel1->CCR &= ~DMA_CCR_TCIE;
-    NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    ADC1->IER &= ~ADC_IER_EOSIE;
+    ADC1->ISR = ADC_ISR_EOS;
+
+    // Дожидаемся, пока DMA заберёт результат последнего канала
+    while (DMA1_Channel1->CNDTR > ADC_DMA_BUFFER_LEN - ADC_CHANNEL_COUNT) {};
 
     for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
-        adc_ctx.lowpass_values[i] = fix16_from_int(adc_ctx.raw_values[i]);
+        adc_ctx.lowpass_values[i] = adc_raw_to_fix16(adc_ctx.raw_values[i]);
     }
-    update_int_vref_coeff();
-    adc_ctx.timestamp = systick_get_system_time_ms();
+    init_int_vref_coeff();
+    update_mv_cache();
     adc_ctx.initialized = 1;
 }
 
+// Прерывание АЦП общее для окончания первого опроса и для watchdog
+static void adc_irq(void)
+{
+    uint32_t isr = ADC1->ISR & ADC1->IER;
+
+    if (isr & ADC_ISR_EOS) {
+        adc_end_of_sequence_irq();
+    }
+
+    for (enum adc_awd awd = 0; awd < ADC_AWD_COUNT; awd++) {
+        if (isr & (ADC_ISR_AWD1 << awd)) {
+            // Флаг выставляется на каждом измерении за порогом, поэтому прерывание отключается
+            // до явного adc_awd_rearm()
+            ADC1->IER &= ~(ADC_IER_AWD1IE << awd);
+            ADC1->ISR = ADC_ISR_AWD1 << awd;
+            if (adc_ctx.awd_handler) {
+                adc_ctx.awd_handler(awd);
+            }
+        }
+    }
+}
+
+// Переводит mV на входе делителя в порог watchdog
+static uint32_t awd_mv_to_threshold(enum adc_channel channel, int32_t mv)
+{
+    uint32_t threshold = mv_to_adc_raw(channel, mv) >> ADC_AWD_THRESHOLD_SHIFT;
+    if (threshold > ADC_AWD_THRESHOLD_MAX) {
+        threshold = ADC_AWD_THRESHOLD_MAX;
+    }
+    return threshold;
+}
+
+// Пересчитывает настройки watchdog в значения регистров
+static void awd_prepare_registers(void)
+{
+    adc_ctx.awd_cfgr1 = 0;
+    for (enum adc_awd awd = 0; awd < ADC_AWD_COUNT; awd++) {
+        adc_ctx.awd_cr[awd] = 0;
+        if (!adc_ctx.awd[awd].enabled) {
+            continue;
+        }
+        enum adc_channel channel = adc_ctx.awd[awd].channel;
+        uint32_t lt = awd_mv_to_threshold(channel, adc_ctx.awd[awd].low_mv);
+        // Верхний порог округляется вверх, чтобы не сужать окно
+        uint32_t ht = awd_mv_to_threshold(channel, adc_ctx.awd[awd].high_mv) + 1;
+        if (ht > ADC_AWD_THRESHOLD_MAX) {
+            ht = ADC_AWD_THRESHOLD_MAX;
+        }
+        adc_ctx.awd[awd].tr = (ht << ADC_AWD1TR_HT1_Pos) | (lt << ADC_AWD1TR_LT1_Pos);
+
+        if (awd == ADC_AWD_1) {
+            adc_ctx.awd_cfgr1 = ADC_CFGR1_AWD1EN | ADC_CFGR1_AWD1SGL |
+                (adc_cfg[channel].ch_num << ADC_CFGR1_AWD1CH_Pos);
+        } else {
+            // Битовые маски AWD2CR и AWD3CR совпадают с масками CHSEL
+            adc_ctx.awd_cr[awd] = adc_cfg[channel].channel;
+        }
+    }
+}
+
+// Вызывается из прерывания DMA: опрос только что закончился, до следующего запуска
+// по таймеру АЦП простаивает и его можно остановить без потери порядка каналов в буфере
+static void awd_apply_registers(void)
+{
+    ADC1->CR |= ADC_CR_ADSTP;
+    while (ADC1->CR & ADC_CR_ADSTART) {};
+
+    ADC1->CFGR1 = (ADC1->CFGR1 & ~(ADC_CFGR1_AWD1EN | ADC_CFGR1_AWD1SGL | ADC_CFGR1_AWD1CH)) | adc_ctx.awd_cfgr1;
+    ADC1->AWD1TR = adc_ctx.awd[ADC_AWD_1].tr;
+    ADC1->AWD2TR = adc_ctx.awd[ADC_AWD_2].tr;
+    ADC1->AWD3TR = adc_ctx.awd[ADC_AWD_3].tr;
+    ADC1->AWD2CR = adc_ctx.awd_cr[ADC_AWD_2];
+    ADC1->AWD3CR = adc_ctx.awd_cr[ADC_AWD_3];
+
+    ADC1->CR |= ADC_CR_ADSTART;
+    adc_ctx.awd_apply_pending = false;
+}
+
+// Пропускает измерение через медианный фильтр канала, i - индекс в буфере DMA
+static uint16_t median_filter(uint8_t i, uint16_t value)
+{
+    uint8_t n = adc_ctx.median_window[i];
+    if (n < 3) {
+        return value;
+    }
+
+    uint16_t *history = adc_ctx.median_history[i];
+    uint16_t window[ADC_MEDIAN_WINDOW_MAX];
+    window[0] = value;
+    for (uint8_t k = 1; k < n; k++) {
+        window[k] = history[k - 1];
+    }
+    for (uint8_t k = n - 2; k > 0; k--) {
+        history[k] = history[k - 1];
+    }
+    history[0] = value;
+
+    // Сортировка вставками, окно не больше ADC_MEDIAN_WINDOW_MAX
+    for (uint8_t k = 1; k < n; k++) {
+        uint16_t v = window[k];
+        uint8_t m = k;
+        while ((m > 0) && (window[m - 1] > v)) {
+            window[m] = window[m - 1];
+            m--;
+        }
+        window[m] = v;
+    }
+    return window[n / 2];
+}
+
+// Пересчитывает пороги захвата в единицы результата АЦП с oversampling
+static void capture_prepare_thresholds(void)
+{
+    for (enum adc_capture_channel c = 0; c < ADC_CAPTURE_CHANNEL_COUNT; c++) {
+        uint16_t threshold = 0;
+        if (adc_ctx.capture.threshold_mv[c] > 0) {
+            threshold = mv_to_adc_raw(capture_channels[c], adc_ctx.capture.threshold_mv[c]) << ADC_OVERSAMPLING_EXTRA_BITS;
+        }
+        adc_ctx.capture.threshold_raw[c] = threshold;
+    }
+}
+
+static inline void capture_set_triggered(enum adc_capture_trigger trigger, enum adc_capture_channel channel)
+{
+    adc_ctx.capture.state = ADC_CAPTURE_STATE_TRIGGERED;
+    adc_ctx.capture.trigger = trigger;
+    adc_ctx.capture.trigger_channel = channel;
+    adc_ctx.capture.trigger_pos = (adc_ctx.capture.pos - 1) & (ADC_CAPTURE_DEPTH - 1);
+    adc_ctx.capture.post_trigger_left = adc_ctx.capture.post_trigger_samples;
+}
+
+// Записывает в буфер захвата результат одного опроса каналов
+static void capture_process_sequence(const uint16_t *sequence)
+{
+    enum adc_capture_state state = adc_ctx.capture.state;
+    if ((state != ADC_CAPTURE_STATE_ARMED) && (state != ADC_CAPTURE_STATE_TRIGGERED)) {
+        return;
+    }
+
+    uint16_t *sample = adc_ctx.capture.samples[adc_ctx.capture.pos];
+    for (enum adc_capture_channel c = 0; c < ADC_CAPTURE_CHANNEL_COUNT; c++) {
+        sample[c] = sequence[ADC_CHANNEL_INDEX(capture_channels[c])];
+    }
+    adc_ctx.capture.pos = (adc_ctx.capture.pos + 1) & (ADC_CAPTURE_DEPTH - 1);
+    if (adc_ctx.capture.count < ADC_CAPTURE_DEPTH) {
+        adc_ctx.capture.count++;
+    }
+
+    if (state == ADC_CAPTURE_STATE_ARMED) {
+        for (enum adc_capture_channel c = 0; c < ADC_CAPTURE_CHANNEL_COUNT; c++) {
+            if (sample[c] < adc_ctx.capture.threshold_raw[c]) {
+                capture_set_triggered(ADC_CAPTURE_TRIGGER_THRESHOLD, c);
+                break;
+            }
+        }
+    }
+
+    if (adc_ctx.capture.state == ADC_CAPTURE_STATE_TRIGGERED) {
+        if (adc_ctx.capture.post_trigger_left == 0) {
+            adc_ctx.capture.state = ADC_CAPTURE_STATE_DONE;
+        } else {
+            adc_ctx.capture.post_trigger_left--;
+        }
+    }
+}
+
+static inline void stats_reset(void)
+{
+    for (enum adc_stats_channel c = 0; c < ADC_STATS_CHANNEL_COUNT; c++) {
+        adc_ctx.stats.min[c] = UINT16_MAX;
+        adc_ctx.stats.max[c] = 0;
+        adc_ctx.stats.sum[c] = 0;
+    }
+    adc_ctx.stats.count = 0;
+}
+
+// Добавляет в статистику средние по блоку значения каналов, индексы - индексы в буфере DMA
+static void stats_process_block(const uint16_t *block_avg)
+{
+    // При переполнении счётчика накопление останавливается до adc_stats_take()
+    if (adc_ctx.stats.count == UINT16_MAX) {
+        return;
+    }
+    for (enum adc_stats_channel c = 0; c < ADC_STATS_CHANNEL_COUNT; c++) {
+        uint16_t v = block_avg[ADC_CHANNEL_INDEX(stats_channels[c])];
+        if (v < adc_ctx.stats.min[c]) {
+            adc_ctx.stats.min[c] = v;
+        }
+        if (v > adc_ctx.stats.max[c]) {
+            adc_ctx.stats.max[c] = v;
+        }
+        adc_ctx.stats.sum[c] += v;
+    }
+    adc_ctx.stats.count++;
+}
+
+// Пересчитывает пороги цифровых входов в единицы результата АЦП с oversampling
+static void din_prepare_thresholds(void)
+{
+    for (enum adc_din d = 0; d < ADC_DIN_COUNT; d++) {
+        enum adc_channel ch = din_channels[d];
+        int32_t low_mv = adc_ctx.din.low_mv[d];
+        int32_t high_mv = adc_ctx.din.high_mv[d];
+        bool enabled = (high_mv > 0) && (high_mv > low_mv);
+        uint16_t low_raw = mv_to_adc_raw(ch, low_mv) << ADC_OVERSAMPLING_EXTRA_BITS;
+        uint16_t high_raw = mv_to_adc_raw(ch, high_mv) << ADC_OVERSAMPLING_EXTRA_BITS;
+
+        ATOMIC {
+            adc_ctx.din.low_raw[d] = low_raw;
+            adc_ctx.din.high_raw[d] = high_raw;
+            adc_ctx.din.valid &= ~(1 << d);
+            if (enabled) {
+                adc_ctx.din.enabled |= (1 << d);
+            } else {
+                adc_ctx.din.enabled &= ~(1 << d);
+                adc_ctx.din.states &= ~(1 << d);
+            }
+        }
+    }
+}
+
+// Сравнивает средние по блоку значения входов с порогами, индексы - индексы в буфере DMA
+static void din_process_block(const uint16_t *block_avg)
+{
+    uint8_t states = adc_ctx.din.states;
+
+    for (enum adc_din d = 0; d < ADC_DIN_COUNT; d++) {
+        uint8_t mask = 1 << d;
+        if (!(adc_ctx.din.enabled & mask)) {
+            continue;
+        }
+        uint16_t v = block_avg[ADC_CHANNEL_INDEX(din_channels[d])];
+
+        if (!(adc_ctx.din.valid & mask)) {
+            // Первое сравнение после изменения порогов: без гистерезиса и без подсчёта фронта
+            if (v > adc_ctx.din.high_raw[d]) {
+                states |= mask;
+            } else {
+                states &= ~mask;
+            }
+            adc_ctx.din.valid |= mask;
+        } else if (states & mask) {
+            if (v < adc_ctx.din.low_raw[d]) {
+                states &= ~mask;
+                adc_ctx.din.falling_count[d]++;
+            }
+        } else {
+            if (v > adc_ctx.din.high_raw[d]) {
+                states |= mask;
+                adc_ctx.din.rising_count[d]++;
+            }
+        }
+    }
+    adc_ctx.din.states = states;
+}
+
+// Усредняет блок из ADC_BLOCK_SEQUENCES опросов и подаёт результат на lowpass фильтр
+static void process_block(const uint16_t *block)
+{
+    uint16_t block_avg[ADC_CHANNEL_COUNT];
+
+    if (!adc_ctx.initialized) {
+        return;
+    }
+
+    for (uint8_t j = 0; j < ADC_BLOCK_SEQUENCES; j++) {
+        capture_process_sequence(&block[j * ADC_CHANNEL_COUNT]);
+    }
+
+    for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
+        uint32_t sum = 0;
+        for (uint8_t j = 0; j < ADC_BLOCK_SEQUENCES; j++) {
+            sum += median_filter(i, block[j * ADC_CHANNEL_COUNT + i]);
+        }
+        block_avg[i] = sum >> ADC_BLOCK_SEQUENCES_BITS;
+        fix16_t avg = (fix16_t)(sum << (16 - ADC_OVERSAMPLING_EXTRA_BITS - ADC_BLOCK_SEQUENCES_BITS));
+
+        adc_ctx.lowpass_values[i] += fix16_mul(
+            adc_ctx.lowpass_factors[i],
+            fix16_sub(avg, adc_ctx.lowpass_values[i])
+        );
+    }
+    stats_process_block(block_avg);
+    din_process_block(block_avg);
+    adc_ctx.block_ready = true;
+    scheduler_set_event(SCHEDULER_EVENT_ADC);
+}
+
+static void dma_transfer_irq(void)
+{
+    uint32_t isr = DMA1->ISR;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+
+    if (isr & DMA_ISR_HTIF1) {
+        process_block(&adc_ctx.raw_values[0]);
+    }
+    if (isr & DMA_ISR_TCIF1) {
+        process_block(&adc_ctx.raw_values[ADC_DMA_BUFFER_LEN / 2]);
+    }
+    if (adc_ctx.awd_apply_pending) {
+        awd_apply_registers();
+    }
+}
+
+// TIM1 запускает опрос всех каналов АЦП через TRGO2 по переполнению
+static void trigger_timer_init(void)
+{
+    RCC->APBENR2 |= RCC_APBENR2_TIM1EN;
+    RCC->APBRSTR2 |= RCC_APBRSTR2_TIM1RST;
+    RCC->APBRSTR2 &= ~RCC_APBRSTR2_TIM1RST;
+
+    TIM1->PSC = SystemCoreClock / 1000000 - 1;                  // 1 MHz
+    TIM1->ARR = ADC_SAMPLE_PERIOD_US - 1;
+    TIM1->CR2 |= 2 << TIM_CR2_MMS2_Pos;                         // TRGO2 = update event
+    TIM1->EGR = TIM_EGR_UG;
+}
+
+// Калибровка нужна один раз: при переинициализации после переключения частоты
+// коэффициент не меняется и записывается обратно в CALFACT (RM0454, 14.3.3)
+// Вызывается при включенном регуляторе АЦП и ADEN = 0
+static void calibrate(void)
+{
+    if (!adc_ctx.calibrated) {
+        ADC1->CR |= ADC_CR_ADCAL;
+        while (ADC1->CR & ADC_CR_ADCAL) {};
+        adc_ctx.calfact = ADC1->CALFACT & ADC_CALFACT_CALFACT_Msk;
+        adc_ctx.calibrated = true;
+    }
+}
+
+// Одно преобразование канала по программному запуску, АЦП включен, ADSTART = 0
+static uint16_t convert_once(enum adc_channel channel)
+{
+    // Запускать преобразование можно только после применения CHSELR (флаг CCRDY)
+    ADC1->ISR = ADC_ISR_CCRDY;
+    ADC1->CHSELR = adc_cfg[channel].channel;
+    while ((ADC1->ISR & ADC_ISR_CCRDY) == 0) {};
+
+    ADC1->CR |= ADC_CR_ADSTART;
+    while ((ADC1->ISR & ADC_ISR_EOC) == 0) {};
+    return ADC1->DR;
+}
+
+int32_t adc_measure_once_mv(enum adc_channel channel)
+{
+    RCC->APBENR2 |= RCC_APBENR2_ADCEN;
+
+    ADC1->CR |= ADC_CR_ADVREGEN;
+    delay_blocking_us(20);
+    calibrate();
+
+    // Время выборки канала как в основном режиме, INT_VREF - всегда длинное
+    ADC1->SMPR = (ADC_SMP_LONG_CYCLES_CODE << ADC_SMPR_SMP1_Pos) | (ADC_SMP_SHORT_CYCLES_CODE << ADC_SMPR_SMP2_Pos);
+    if (adc_cfg[channel].smp == ADC_SMP_SHORT) {
+        ADC1->SMPR |= adc_cfg[channel].channel << ADC_SMPR_SMPSEL0_Pos;
+    }
+    if (adc_cfg[channel].port != ADC_NO_GPIO_PIN) {
+        GPIO_SET_ANALOG(adc_cfg[channel].port, adc_cfg[channel].pin);
+    }
+
+    ADC->CCR |= ADC_CCR_VREFEN;
+    delay_blocking_us(10);
+
+    ADC1->ISR = ADC_ISR_ADRDY;
+    ADC1->CR |= ADC_CR_ADEN;
+    while ((ADC1->ISR & ADC_ISR_ADRDY) == 0) {};
+    ADC1->CALFACT = adc_ctx.calfact;
+
+    uint32_t int_vref_raw = convert_once(ADC_CHANNEL_ADC_INT_VREF);
+    uint32_t ch_raw = convert_once(channel);
+
+    // Выключаем АЦП, adc_init всё равно сбрасывает его целиком
+    ADC1->CR |= ADC_CR_ADDIS;
+    while (ADC1->CR & ADC_CR_ADEN) {};
+    ADC->CCR &= ~ADC_CCR_VREFEN;
+    ADC1->CR &= ~ADC_CR_ADVREGEN;
+
+    if (int_vref_raw == 0) {
+        return 0;
+    }
+    // Опорное АЦП - VDDA, измеряется по INT_VREF; все промежуточные значения умещаются в 32 бита
+    uint32_t vdda_mv = ADC_INT_VREF_FACTORY_CAL_MV * ADC_INT_VREF_CAL_VALUE / int_vref_raw;
+    uint32_t pin_mv = (ch_raw * vdda_mv) >> ADC_RESOLUTION_BIT;
+    return pin_mv * adc_cfg[channel].full_scale_mv / ADC_VREF_EXT_MV;
+}
+
 void adc_init(enum adc_clock clock_divider, enum adc_vref vref)
 {
     adc_ctx.initialized = 0;
     adc_ctx.vref = vref;
+    // После сброса АЦП настройки watchdog нужно применить заново
+    adc_ctx.awd_apply_pending = false;
+    adc_ctx.awd_setup_changed = true;
+    adc_ctx.capture.threshold_changed = true;
+    adc_ctx.din.threshold_changed = true;
+    stats_reset();
 
     // Enable clock
     RCC->APBENR2 |= RCC_APBENR2_ADCEN;
@@ -149,11 +774,11 @@ void adc_init(enum adc_clock clock_divider, enum adc_vref vref)
     DMA1_Channel1->CPAR = (uint32_t)&(ADC1->DR);                // peripheral address
     DMA1_Channel1->CMAR = (uint32_t)adc_ctx.raw_values;         // memory address
 
-    DMA1_Channel1->CNDTR = ADC_CHANNEL_COUNT;
+    DMA1_Channel1->CNDTR = ADC_DMA_BUFFER_LEN;
 
-    // Прерывание по DMA нужно, чтобы инициализировать lowpass фильтр первым измерением
-    DMA1_Channel1->CCR |= DMA_CCR_TCIE;
-    NVIC_SetHandler(DMA1_Channel1_IRQn, dma_end_transfer_irq);
+    // Прерывания по заполнению половин буфера - обработка блоков
+    DMA1_Channel1->CCR |= DMA_CCR_HTIE | DMA_CCR_TCIE;
+    NVIC_SetHandler(DMA1_Channel1_IRQn, dma_transfer_irq);
     NVIC_EnableIRQ(DMA1_Channel1_IRQn);
 
     DMA1_Channel1->CCR |= DMA_CCR_EN;
@@ -171,13 +796,18 @@ void adc_init(enum adc_clock clock_divider, enum adc_vref vref)
     // Wait about 20 us
     delay_blocking_us(20);
 
-    ADC1->CR |= ADC_CR_ADCAL;
-    while (ADC1->CR & ADC_CR_ADCAL) {};
+    calibrate();
 
     ADC1->CFGR1 |= ADC_CFGR1_DMACFG | ADC_CFGR1_DMAEN;          // DMA enable, DMA circular mode
-    ADC1->CFGR1 |= ADC_CFGR1_CONT;                              // Continuous conversion mode
+    ADC1->CFGR1 |= 1 << ADC_CFGR1_EXTEN_Pos;                    // Trigger on rising edge, EXTSEL = 0 (TIM1_TRGO2)
+
+    // Два времени выборки, выбор для каждого канала - битами SMPSEL ниже
+    ADC1->SMPR = (ADC_SMP_LONG_CYCLES_CODE << ADC_SMPR_SMP1_Pos) | (ADC_SMP_SHORT_CYCLES_CODE << ADC_SMPR_SMP2_Pos);
 
-    ADC1->SMPR |= ADC_SMPR_SMP1;                                // 160.5 ADC clock cycles
+    // Аппаратный oversampling для всех каналов
+    ADC1->CFGR2 |= ADC_CFGR2_OVSE |
+        ((ADC_OVERSAMPLING_RATIO_BITS - 1) << ADC_CFGR2_OVSR_Pos) |
+        (ADC_OVERSAMPLING_SHIFT << ADC_CFGR2_OVSS_Pos);
 
     if (vref == ADC_VREF_INT) {
         ADC->CCR |= ADC_CCR_VREFEN;
@@ -204,6 +834,10 @@ void adc_init(enum adc_clock clock_divider, enum adc_vref vref)
         }
         // Enable all ADC channels
         ADC1->CHSELR |= adc_cfg[i].channel;
+        // Битовые маски SMPSEL совпадают с масками CHSEL, только сдвинуты
+        if (adc_cfg[i].smp == ADC_SMP_SHORT) {
+            ADC1->SMPR |= adc_cfg[i].channel << ADC_SMPR_SMPSEL0_Pos;
+        }
 
         // Prepare mapping ADC channel to dma buffer for quick data access using just channel
         // chan_index_in_dma_buff имеет байт на каждый enum ADC_CHANNEL_XXX и по сути это индекс, по которому значение на данном канале лежит в буффере дма
@@ -220,17 +854,66 @@ void adc_init(enum adc_clock clock_divider, enum adc_vref vref)
         adc_set_lowpass_rc(i, adc_cfg[i].rc_factor);
     }
 
+    // Прерывание по окончании первого опроса нужно, чтобы инициализировать lowpass фильтр
+    ADC1->IER |= ADC_IER_EOSIE;
+    NVIC_SetHandler(ADC1_IRQn, adc_irq);
+    NVIC_EnableIRQ(ADC1_IRQn);
+
+    trigger_timer_init();
+
     while ((ADC1->ISR & ADC_ISR_ADRDY) == 0) {};
+    // Сброс АЦП стирает CALFACT, записать его можно только при ADEN = 1 и ADSTART = 0
+    ADC1->CALFACT = adc_ctx.calfact;
     ADC1->CR |= ADC_CR_ADSTART;
+    TIM1->CR1 |= TIM_CR1_CEN;
 }
 
 void adc_set_lowpass_rc(enum adc_channel channel, uint16_t rc_ms)
 {
     uint8_t ch_index_in_dma_buff = ADC_CHANNEL_INDEX(channel);
 
+    if (rc_ms > ADC_LOWPASS_RC_MAX_MS) {
+        rc_ms = ADC_LOWPASS_RC_MAX_MS;
+    }
+    adc_ctx.lowpass_rc_ms[channel] = rc_ms;
     adc_ctx.lowpass_factors[ch_index_in_dma_buff] = calculate_rc_factor(rc_ms);
 }
 
+uint16_t adc_get_lowpass_rc(enum adc_channel channel)
+{
+    return adc_ctx.lowpass_rc_ms[channel];
+}
+
+// Включает медианный фильтр по n последним измерениям
+// n меньше 3 - фильтр выключен, чётное n уменьшается до нечётного
+void adc_set_median_window(enum adc_channel channel, uint8_t n)
+{
+    uint8_t ch_index_in_dma_buff = ADC_CHANNEL_INDEX(channel);
+
+    if (n > ADC_MEDIAN_WINDOW_MAX) {
+        n = ADC_MEDIAN_WINDOW_MAX;
+    }
+    if (n < 3) {
+        n = 1;
+    } else if ((n & 1) == 0) {
+        n--;
+    }
+
+    // История заполняется текущим значением, чтобы не было скачка при включении
+    uint16_t value = fix16_to_int(adc_ctx.lowpass_values[ch_index_in_dma_buff] << ADC_OVERSAMPLING_EXTRA_BITS);
+    ATOMIC {
+        for (uint8_t k = 0; k < ADC_MEDIAN_WINDOW_MAX - 1; k++) {
+            adc_ctx.median_history[ch_index_in_dma_buff][k] = value;
+        }
+        adc_ctx.median_window[ch_index_in_dma_buff] = n;
+    }
+}
+
+uint8_t adc_get_median_window(enum adc_channel channel)
+{
+    return adc_ctx.median_window[ADC_CHANNEL_INDEX(channel)];
+}
+
 void adc_set_offset_mv(enum adc_channel channel, int16_t offset_mv)
 {
     adc_ctx.offset_mv[channel] = offset_mv;
@@ -249,35 +932,14 @@ fix16_t adc_get_ch_adc_raw(enum adc_channel channel)
 // Возвращает милливольты с учётом делителя (K) и оффсета после lowpass фильтра
 int32_t adc_get_ch_mv(enum adc_channel channel)
 {
-    uint8_t ch_index_in_dma_buff = ADC_CHANNEL_INDEX(channel);
-    fix16_t ch_raw = adc_ctx.lowpass_values[ch_index_in_dma_buff];
-
-    uint32_t raw_value;
-    if (adc_ctx.vref == ADC_VREF_INT) {
-        raw_value = fix16_to_int(
-            fix16_mul(ch_raw, adc_ctx.int_vref_coeff)
-        );
-    } else {
-        raw_value = fix16_to_int(ch_raw);
-    }
-    // full_scale_mv - коэффициент из расчета, референс АЦП равен ADC_EXT_VREF_MV
-    int32_t mv = (raw_value * adc_cfg[channel].full_scale_mv) >> ADC_RESOLUTION_BIT;
-    return mv + adc_ctx.offset_mv[channel];
+    return adc_ctx.mv[channel] + adc_ctx.offset_mv[channel];
 }
 
 // Возвращает милливольты с учётом делителя (K) и оффсета в формате fix16
 // Максимальное значение 32767 мВ, переполнение не проверяется!
 fix16_t adc_get_ch_mv_f16(enum adc_channel channel)
 {
-    uint8_t ch_index_in_dma_buff = ADC_CHANNEL_INDEX(channel);
-    fix16_t ch_raw = adc_ctx.lowpass_values[ch_index_in_dma_buff];
-
-    if (adc_ctx.vref == ADC_VREF_INT) {
-        ch_raw = fix16_mul(ch_raw, adc_ctx.int_vref_coeff);
-    }
-    fix16_t k = fix16_div(fix16_from_int(adc_cfg[channel].full_scale_mv), F16(4095));
-    fix16_t mv = fix16_mul(ch_raw, k);
-    return mv;
+    return adc_ctx.mv_f16[channel];
 }
 
 bool adc_get_ready(void)
@@ -285,25 +947,193 @@ bool adc_get_ready(void)
     return adc_ctx.initialized;
 }
 
+void adc_awd_set_handler(adc_awd_handler_t handler)
+{
+    adc_ctx.awd_handler = handler;
+}
+
+// Настраивает watchdog на окно [low_mv, high_mv] канала
+// Прерывание watchdog остаётся выключенным до вызова adc_awd_rearm()
+void adc_awd_setup(enum adc_awd awd, enum adc_channel channel, int32_t low_mv, int32_t high_mv)
+{
+    ATOMIC {
+        ADC1->IER &= ~(ADC_IER_AWD1IE << awd);
+    }
+
+    adc_ctx.awd[awd].enabled = true;
+    adc_ctx.awd[awd].channel = channel;
+    adc_ctx.awd[awd].low_mv = low_mv;
+    adc_ctx.awd[awd].high_mv = high_mv;
+    adc_ctx.awd_setup_changed = true;
+}
+
+void adc_awd_rearm(enum adc_awd awd)
+{
+    ATOMIC {
+        ADC1->ISR = ADC_ISR_AWD1 << awd;
+        ADC1->IER |= ADC_IER_AWD1IE << awd;
+    }
+}
+
+void adc_awd_disarm(enum adc_awd awd)
+{
+    ATOMIC {
+        ADC1->IER &= ~(ADC_IER_AWD1IE << awd);
+    }
+}
+
 void adc_do_periodic_work(void)
 {
     if (!adc_ctx.initialized) {
         return;
     }
 
-    if (systick_get_time_since_timestamp(adc_ctx.timestamp) < ADC_FILTRATION_PERIOD_MS) {
+    // Фильтрация выполняется в прерывании DMA, здесь пересчёт коэффициента по VREF и таблицы mV
+    if (!adc_ctx.block_ready) {
         return;
     }
-    adc_ctx.timestamp += ADC_FILTRATION_PERIOD_MS;
+    adc_ctx.block_ready = false;
 
-    for (uint8_t i = 0; i < ADC_CHANNEL_COUNT; i++) {
-        adc_ctx.lowpass_values[i] += fix16_mul(
-            adc_ctx.lowpass_factors[i],
-            fix16_sub(
-                fix16_from_int(adc_ctx.raw_values[i]),
-                adc_ctx.lowpass_values[i]
-            )
-        );
-    }
     update_int_vref_coeff();
+    update_mv_cache();
+
+    // Пороги watchdog пересчитываются один раз после изменения настроек:
+    // коэффициент по VREF к этому моменту уже известен
+    if ((adc_ctx.awd_setup_changed) && (!adc_ctx.awd_apply_pending)) {
+        adc_ctx.awd_setup_changed = false;
+        awd_prepare_registers();
+        adc_ctx.awd_apply_pending = true;
+    }
+
+    if (adc_ctx.capture.threshold_changed) {
+        adc_ctx.capture.threshold_changed = false;
+        capture_prepare_thresholds();
+    }
+
+    if (adc_ctx.din.threshold_changed) {
+        adc_ctx.din.threshold_changed = false;
+        din_prepare_thresholds();
+    }
+}
+
+// Запускает запись в буфер захвата, предыдущая осциллограмма теряется
+void adc_capture_arm(uint8_t post_trigger_samples)
+{
+    if (post_trigger_samples > ADC_CAPTURE_DEPTH - 1) {
+        post_trigger_samples = ADC_CAPTURE_DEPTH - 1;
+    }
+    ATOMIC {
+        adc_ctx.capture.pos = 0;
+        adc_ctx.capture.count = 0;
+        adc_ctx.capture.trigger = ADC_CAPTURE_TRIGGER_NONE;
+        adc_ctx.capture.trigger_channel = 0;
+        adc_ctx.capture.trigger_pos = 0;
+        adc_ctx.capture.post_trigger_samples = post_trigger_samples;
+        adc_ctx.capture.state = ADC_CAPTURE_STATE_ARMED;
+    }
+}
+
+// Внешнее событие захвата, можно вызывать из прерываний
+void adc_capture_trigger(void)
+{
+    ATOMIC {
+        if (adc_ctx.capture.state == ADC_CAPTURE_STATE_ARMED) {
+            capture_set_triggered(ADC_CAPTURE_TRIGGER_EXTERNAL, 0);
+        }
+    }
+}
+
+// Порог захвата в mV, 0 - выключен
+void adc_capture_set_threshold_mv(enum adc_capture_channel channel, int32_t mv)
+{
+    adc_ctx.capture.threshold_mv[channel] = mv;
+    adc_ctx.capture.threshold_changed = true;
+}
+
+void adc_capture_get_info(struct adc_capture_info * info)
+{
+    ATOMIC {
+        info->state = adc_ctx.capture.state;
+        info->trigger = adc_ctx.capture.trigger;
+        info->trigger_channel = adc_ctx.capture.trigger_channel;
+        info->samples_count = adc_ctx.capture.count;
+        // Индексы считаются от самого старого измерения в буфере
+        uint8_t first = (adc_ctx.capture.count < ADC_CAPTURE_DEPTH) ? 0 : adc_ctx.capture.pos;
+        info->trigger_index = (adc_ctx.capture.trigger_pos - first) & (ADC_CAPTURE_DEPTH - 1);
+    }
+}
+
+// Возвращает измерение из буфера захвата в mV, index отсчитывается от самого старого измерения
+// Данные неизменны только в состоянии ADC_CAPTURE_STATE_DONE
+int32_t adc_capture_get_sample_mv(enum adc_capture_channel channel, uint8_t index)
+{
+    if (index >= adc_ctx.capture.count) {
+        return 0;
+    }
+    uint8_t first = (adc_ctx.capture.count < ADC_CAPTURE_DEPTH) ? 0 : adc_ctx.capture.pos;
+    uint8_t pos = (first + index) & (ADC_CAPTURE_DEPTH - 1);
+    uint16_t raw = adc_ctx.capture.samples[pos][channel];
+
+    enum adc_channel adc_ch = capture_channels[channel];
+    return adc_raw_to_mv(adc_ch, adc_raw_to_fix16(raw)) + adc_ctx.offset_mv[adc_ch];
+}
+
+// Забирает статистику всех каналов в mV и начинает накопление заново
+// Если измерений не было, count = 0, а значения нулевые
+void adc_stats_take(struct adc_stats stats[ADC_STATS_CHANNEL_COUNT])
+{
+    uint16_t min[ADC_STATS_CHANNEL_COUNT];
+    uint16_t max[ADC_STATS_CHANNEL_COUNT];
+    uint32_t sum[ADC_STATS_CHANNEL_COUNT];
+    uint16_t count;
+
+    ATOMIC {
+        for (enum adc_stats_channel c = 0; c < ADC_STATS_CHANNEL_COUNT; c++) {
+            min[c] = adc_ctx.stats.min[c];
+            max[c] = adc_ctx.stats.max[c];
+            sum[c] = adc_ctx.stats.sum[c];
+        }
+        count = adc_ctx.stats.count;
+        stats_reset();
+    }
+
+    for (enum adc_stats_channel c = 0; c < ADC_STATS_CHANNEL_COUNT; c++) {
+        enum adc_channel ch = stats_channels[c];
+        stats[c].count = count;
+        if (count == 0) {
+            stats[c].min_mv = 0;
+            stats[c].max_mv = 0;
+            stats[c].avg_mv = 0;
+            continue;
+        }
+        uint16_t avg = sum[c] / count;
+        stats[c].min_mv = adc_raw_to_mv(ch, adc_raw_to_fix16(min[c])) + adc_ctx.offset_mv[ch];
+        stats[c].max_mv = adc_raw_to_mv(ch, adc_raw_to_fix16(max[c])) + adc_ctx.offset_mv[ch];
+        stats[c].avg_mv = adc_raw_to_mv(ch, adc_raw_to_fix16(avg)) + adc_ctx.offset_mv[ch];
+    }
+}
+
+// Пороги цифрового входа в mV: переключение в "1" выше high_mv, в "0" ниже low_mv
+// Если high_mv не больше low_mv, вход выключен и читается как "0"
+void adc_din_set_thresholds(enum adc_din din, int32_t low_mv, int32_t high_mv)
+{
+    adc_ctx.din.low_mv[din] = low_mv;
+    adc_ctx.din.high_mv[din] = high_mv;
+    adc_ctx.din.threshold_changed = true;
+}
+
+// Возвращает состояния входов, бит на вход
+uint8_t adc_din_get_states(void)
+{
+    return adc_ctx.din.states;
+}
+
+uint16_t adc_din_get_rising_count(enum adc_din din)
+{
+    return adc_ctx.din.rising_count[din];
+}
+
+uint16_t adc_din_get_falling_count(enum adc_din din)
+{
+    return adc_ctx.din.falling_count[din];
 }
@@ -0,0 +1,78 @@
+#include "boot-timeline.h"
+#include "regmap-int.h"
+#include "systick.h"
+#include "mcu-pwr.h"
+#include "array_size.h"
+#include <assert.h>
+
+/**
+ * Время прохождения этапов загрузки EC, мс от старта МК
+ *
+ * Запоминается только первое прохождение этапа после старта МК.
+ * Нужно, чтобы видеть из Linux, сколько времени прошло до включения его питания
+ * и на каком этапе оно тратится.
+ *
+ * BOOT_TIMELINE: ms[i] - время этапа enum boot_milestone,
+ * BOOT_TIMELINE_NOT_REACHED - этап ещё не пройден
+ *
+ * STANDBY_WAKEUP: сколько раз EC засыпал в standby до этого включения
+ * и сколько мкс он бодрствовал перед последним засыпанием (стоимость периодического пробуждения)
+ */
+
+#define BOOT_TIMELINE_NOT_REACHED       UINT16_MAX
+
+static_assert(BOOT_MILESTONE_COUNT == ARRAY_SIZE(((struct REGMAP_BOOT_TIMELINE *)0)->ms), "Regmap must hold all boot milestones");
+static_assert(BOOT_MILESTONE_COUNT <= 8, "Boot milestones must fit into uint8_t mask");
+
+static struct {
+    uint16_t ms[BOOT_MILESTONE_COUNT];
+    uint8_t reached;
+    bool publish_pending;
+} boot_ctx;
+
+static void publish_timeline(void)
+{
+    struct REGMAP_BOOT_TIMELINE t;
+
+    for (unsigned i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+        t.ms[i] = (boot_ctx.reached & (1U << i)) ? boot_ctx.ms[i] : BOOT_TIMELINE_NOT_REACHED;
+    }
+
+    if (regmap_set_region_data(REGMAP_REGION_BOOT_TIMELINE, &t, sizeof(t))) {
+        boot_ctx.publish_pending = false;
+    }
+}
+
+void boot_timeline_init(void)
+{
+    struct mcu_standby_stats stats;
+    mcu_take_standby_stats(&stats);
+
+    struct REGMAP_STANDBY_WAKEUP w = {
+        .wakeups = stats.wakeups,
+        .last_awake_us = stats.last_awake_us,
+    };
+    regmap_set_region_data(REGMAP_REGION_STANDBY_WAKEUP, &w, sizeof(w));
+
+    publish_timeline();
+}
+
+void boot_timeline_mark(enum boot_milestone m)
+{
+    if ((m >= BOOT_MILESTONE_COUNT) || (boot_ctx.reached & (1U << m))) {
+        return;
+    }
+
+    systime_t t = systick_get_system_time_ms();
+    // Значение BOOT_TIMELINE_NOT_REACHED зарезервировано
+    boot_ctx.ms[m] = (t < BOOT_TIMELINE_NOT_REACHED) ? t : BOOT_TIMELINE_NOT_REACHED - 1;
+    boot_ctx.reached |= 1U << m;
+    boot_ctx.publish_pending = true;
+}
+
+void boot_timeline_do_periodic_work(void)
+{
+    if (boot_ctx.publish_pending) {
+        publish_timeline();
+    }
+}
@@ -0,0 +1,95 @@
+#include "brownout-capture.h"
+#include "adc.h"
+#include "regmap-int.h"
+#include "array_size.h"
+#include <assert.h>
+
+/**
+ * Модуль связывает захват осциллограммы питания в АЦП с regmap:
+ *  - ADC_CAPTURE_CTRL: запуск захвата (arm), количество измерений после события,
+ *    пороги захвата по каналам в mV (0 - выключен) и положение окна чтения
+ *  - ADC_CAPTURE_STATUS: состояние захвата, источник и положение события в буфере
+ *  - ADC_CAPTURE_DATA: окно из 32 измерений выбранного канала в mV, начиная с window_offset.
+ *    Заполняется, только когда буфер заморожен
+ *
+ * При старте захват запускается без порогов, событием служит срабатывание voltage monitor.
+ * Так осциллограмма провала питания, из-за которого перезагрузился линукс,
+ * доступна после его загрузки.
+ */
+
+#define BROWNOUT_CAPTURE_DEFAULT_POST_SAMPLES       (ADC_CAPTURE_DEPTH / 2)
+
+static_assert(ADC_CAPTURE_CHANNEL_COUNT == 3, "ADC_CAPTURE_CTRL has thresholds for 3 channels");
+
+static struct {
+    struct REGMAP_ADC_CAPTURE_CTRL ctrl;
+    bool data_published;
+} bc_ctx;
+
+static void publish_ctrl(void)
+{
+    bc_ctx.ctrl.arm = 0;
+    regmap_set_region_data(REGMAP_REGION_ADC_CAPTURE_CTRL, &bc_ctx.ctrl, sizeof(bc_ctx.ctrl));
+}
+
+void brownout_capture_init(void)
+{
+    bc_ctx.ctrl.post_trigger_samples = BROWNOUT_CAPTURE_DEFAULT_POST_SAMPLES;
+    bc_ctx.data_published = false;
+    adc_capture_arm(bc_ctx.ctrl.post_trigger_samples);
+    publish_ctrl();
+}
+
+void brownout_capture_do_periodic_work(void)
+{
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_ADC_CAPTURE_CTRL, &bc_ctx.ctrl, sizeof(bc_ctx.ctrl))) {
+        adc_capture_set_threshold_mv(ADC_CAPTURE_CHANNEL_V_IN, bc_ctx.ctrl.threshold_v_in);
+        adc_capture_set_threshold_mv(ADC_CAPTURE_CHANNEL_5V, bc_ctx.ctrl.threshold_v_5_0);
+        adc_capture_set_threshold_mv(ADC_CAPTURE_CHANNEL_3V3, bc_ctx.ctrl.threshold_v_3_3);
+        if (bc_ctx.ctrl.post_trigger_samples > ADC_CAPTURE_DEPTH - 1) {
+            bc_ctx.ctrl.post_trigger_samples = ADC_CAPTURE_DEPTH - 1;
+        }
+        if (bc_ctx.ctrl.window_channel >= ADC_CAPTURE_CHANNEL_COUNT) {
+            bc_ctx.ctrl.window_channel = 0;
+        }
+        if (bc_ctx.ctrl.arm) {
+            adc_capture_arm(bc_ctx.ctrl.post_trigger_samples);
+        }
+        publish_ctrl();
+        // Окно могло сдвинуться
+        bc_ctx.data_published = false;
+    }
+
+    struct adc_capture_info info;
+    adc_capture_get_info(&info);
+
+    struct REGMAP_ADC_CAPTURE_STATUS status = {
+        .state = info.state,
+        .trigger = info.trigger,
+        .trigger_channel = info.trigger_channel,
+        .samples_count = info.samples_count,
+        .trigger_index = info.trigger_index,
+        .depth = ADC_CAPTURE_DEPTH,
+    };
+    regmap_set_region_data(REGMAP_REGION_ADC_CAPTURE_STATUS, &status, sizeof(status));
+
+    if (info.state != ADC_CAPTURE_STATE_DONE) {
+        bc_ctx.data_published = false;
+        return;
+    }
+    if (bc_ctx.data_published) {
+        return;
+    }
+
+    struct REGMAP_ADC_CAPTURE_DATA data;
+    for (unsigned i = 0; i < ARRAY_SIZE(data.mv); i++) {
+        // За пределами буфера adc_capture_get_sample_mv() возвращает 0
+        unsigned index = bc_ctx.ctrl.window_offset + i;
+        if (index < ADC_CAPTURE_DEPTH) {
+            data.mv[i] = adc_capture_get_sample_mv(bc_ctx.ctrl.window_channel, index);
+        } else {
+            data.mv[i] = 0;
+        }
+    }
+    bc_ctx.data_published = regmap_set_region_data(REGMAP_REGION_ADC_CAPTURE_DATA, &data, sizeof(data));
+}
@@ -0,0 +1,438 @@
+#include "config-store.h"
+#include "regmap-int.h"
+#include "flash.h"
+#include "event-log.h"
+#include "array_size.h"
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+
+/**
+ * Хранилище настроек во flash
+ *
+ * Сохраняет содержимое выбранных RW регионов regmap, чтобы после включения
+ * UART и GPIO модулей сразу работали с настройками Linux, не дожидаясь загрузки драйверов.
+ * Сохранённые настройки записываются в regmap при старте EC и при включении
+ * питания Linux (linux_poweron_handler) так, как будто их записали снаружи,
+ * и применяются модулями через обычный regmap_get_data_if_region_changed.
+ *
+ * Износ flash: записи добавляются друг за другом в активную страницу,
+ * действительна запись с наибольшим seq. Когда страница заполнена, стирается
+ * вторая страница и следующая запись пишется в её начало, поэтому стирание
+ * происходит раз в FLASH_STORAGE_PAGE_SIZE / sizeof(record) сохранений.
+ * Одинаковые настройки повторно не записываются.
+ * Если питание пропало во время записи, запись не пройдёт проверку CRC
+ * и останутся действительными предыдущие настройки.
+ *
+ * Формат данных задаётся явно полем format. Регионы добавляются только в конец
+ * CONFIG_STORE_REGIONS, поля - только в конец последнего региона, при этом CONFIG_STORE_FORMAT
+ * увеличивается, а в config_store_format_size дописывается размер данных нового формата.
+ * Из записи прежнего формата восстанавливается известная ей часть данных: регионов и полей,
+ * которых в ней нет, остаются со значениями по умолчанию. Об этом, как и о том, что
+ * сохранённые настройки не удалось прочитать, пишется событие в лог.
+ * Записи занимают слоты фиксированного размера, поэтому раскладка страниц от формата не зависит.
+ * Если порядок или размер существующего региона меняется, нужно сменить CONFIG_STORE_MAGIC,
+ * тогда все старые записи будут проигнорированы.
+ *
+ * В тех же страницах хранится журнал питания (power-journal.c): записи с CONFIG_STORE_JOURNAL_MAGIC
+ * в таких же слотах. seq общий для записей обоих типов, активна страница с самой новой записью.
+ * При переходе на другую страницу в неё сначала переписывается последняя запись другого типа,
+ * иначе она была бы стёрта при следующем переходе. Стирание настроек журнал не затрагивает.
+ *
+ * CONFIG_CTRL:
+ *  - save: сохранить текущие настройки, сбрасывается после выполнения
+ *  - clear: стереть сохранённые настройки, сбрасывается после выполнения
+ *  - stored: есть сохранённые настройки
+ *  - error: ошибка последней операции с flash
+ */
+
+#define CONFIG_STORE_REGIONS(m) \
+    m(RTC_CFG) \
+    m(ADC_FILTER) \
+    m(GPIO_DIR) \
+    m(GPIO_AF) \
+    m(GPIO_DIN_CFG) \
+    m(WDT) \
+    m(UART_CTRL_MOD1) \
+    m(UART_CTRL_MOD2) \
+    m(PWR_SEQ_CFG) \
+
+#define CONFIG_STORE_MAGIC                  0xC0F6
+#define CONFIG_STORE_FORMAT                 3
+#define CONFIG_STORE_JOURNAL_MAGIC          0x7E51
+#define CONFIG_STORE_JOURNAL_FORMAT         1
+#define CONFIG_STORE_ERASED_HALFWORD        0xFFFF
+#define CONFIG_STORE_RECORD_SIZE            128
+#define CONFIG_STORE_HEADER_SIZE            16
+
+#define __CONFIG_STORE_MEMBER(name)         struct REGMAP_##name name;
+#define __CONFIG_STORE_DESCR(name)          { REGMAP_REGION_##name, offsetof(struct config_store_data, name), sizeof(struct REGMAP_##name) },
+
+struct config_store_data {
+    CONFIG_STORE_REGIONS(__CONFIG_STORE_MEMBER)
+};
+
+struct config_store_record {
+    uint16_t magic;
+    uint16_t format;
+    uint16_t seq;
+    uint16_t size;
+    uint16_t crc;
+    uint16_t reserved[3];
+    union {
+        struct config_store_data data;
+        uint8_t raw[CONFIG_STORE_RECORD_SIZE - CONFIG_STORE_HEADER_SIZE];
+    };
+};
+
+// Буфер под любой регион
+union config_store_region_buf {
+    CONFIG_STORE_REGIONS(__CONFIG_STORE_MEMBER)
+};
+
+static_assert(sizeof(struct config_store_data) <= CONFIG_STORE_RECORD_SIZE - CONFIG_STORE_HEADER_SIZE, "Config data does not fit in record");
+static_assert(sizeof(struct config_store_record) == CONFIG_STORE_RECORD_SIZE, "Wrong config record size");
+static_assert(CONFIG_STORE_JOURNAL_SIZE == CONFIG_STORE_RECORD_SIZE - CONFIG_STORE_HEADER_SIZE, "Journal must fill record data");
+static_assert(CONFIG_STORE_RECORD_SIZE % FLASH_STORAGE_WRITE_UNIT == 0, "Config record must be aligned to flash write unit");
+
+// Размер данных каждого формата
+static const uint16_t config_store_format_size[CONFIG_STORE_FORMAT + 1] = {
+    [1] = offsetof(struct config_store_data, PWR_SEQ_CFG),      // без PWR_SEQ_CFG
+    [2] = offsetof(struct config_store_data, PWR_SEQ_CFG) +     // PWR_SEQ_CFG без порогов 3.3В
+          offsetof(struct REGMAP_PWR_SEQ_CFG, v33_on_mv),
+    [3] = sizeof(struct config_store_data),
+};
+
+struct config_store_region {
+    enum regmap_region region;
+    uint16_t offset;
+    uint16_t size;
+};
+
+static const struct config_store_region config_regions[] = {
+    CONFIG_STORE_REGIONS(__CONFIG_STORE_DESCR)
+};
+
+static struct {
+    const struct config_store_record *last;             // последняя действительная запись настроек
+    const struct config_store_record *journal;          // последняя действительная запись журнала питания
+    const struct config_store_record *newest;           // самая новая запись любого типа
+    uint8_t page;                                       // активная страница, в ней newest
+    uint16_t free_offset[FLASH_STORAGE_PAGES_COUNT];    // начало свободного места в странице
+    bool invalid_found;                                 // во flash есть испорченные или неизвестные записи
+    bool error;
+    bool save_pending;
+    bool clear_pending;
+    bool publish_pending;
+} store_ctx;
+
+// CRC-16/CCITT, побитово: считается только при сохранении и загрузке
+static uint16_t crc16(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (unsigned i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t record_crc(const struct config_store_record *r)
+{
+    uint16_t crc = crc16(0xFFFF, (const uint8_t *)&r->format, sizeof(r->format) + sizeof(r->seq) + sizeof(r->size));
+    return crc16(crc, r->raw, sizeof(r->raw));
+}
+
+static bool record_valid(const struct config_store_record *r)
+{
+    return (r->magic == CONFIG_STORE_MAGIC) &&
+           (r->format > 0) && (r->format <= CONFIG_STORE_FORMAT) &&
+           (r->size == config_store_format_size[r->format]) &&
+           (r->crc == record_crc(r));
+}
+
+static bool journal_record_valid(const struct config_store_record *r)
+{
+    return (r->magic == CONFIG_STORE_JOURNAL_MAGIC) &&
+           (r->format == CONFIG_STORE_JOURNAL_FORMAT) &&
+           (r->size == CONFIG_STORE_JOURNAL_SIZE) &&
+           (r->crc == record_crc(r));
+}
+
+// seq заворачивается через 0, новее та запись, которая впереди меньше чем на половину диапазона
+static inline bool seq_newer(uint16_t a, uint16_t b)
+{
+    return (int16_t)(a - b) > 0;
+}
+
+static inline const struct config_store_record * record_at(uint8_t page, uint16_t offset)
+{
+    return (const struct config_store_record *)(flash_storage_page_addr(page) + offset);
+}
+
+static void scan_page(uint8_t page)
+{
+    uint16_t offset = 0;
+
+    // Записи одного размера, испорченные записи пропускаются целиком
+    while (offset + sizeof(struct config_store_record) <= FLASH_STORAGE_PAGE_SIZE) {
+        const struct config_store_record *r = record_at(page, offset);
+        if (r->magic == CONFIG_STORE_ERASED_HALFWORD) {
+            break;
+        }
+        offset += sizeof(struct config_store_record);
+
+        if (record_valid(r)) {
+            if ((store_ctx.last == NULL) || seq_newer(r->seq, store_ctx.last->seq)) {
+                store_ctx.last = r;
+            }
+        } else if (journal_record_valid(r)) {
+            if ((store_ctx.journal == NULL) || seq_newer(r->seq, store_ctx.journal->seq)) {
+                store_ctx.journal = r;
+            }
+        } else {
+            // Испорченная запись журнала к потере настроек не относится
+            if (r->magic != CONFIG_STORE_JOURNAL_MAGIC) {
+                store_ctx.invalid_found = true;
+            }
+            continue;
+        }
+        if ((store_ctx.newest == NULL) || seq_newer(r->seq, store_ctx.newest->seq)) {
+            store_ctx.newest = r;
+            store_ctx.page = page;
+        }
+    }
+    store_ctx.free_offset[page] = offset;
+}
+
+// Дописывает запись в страницу с новым seq, возвращает записанную запись или NULL
+static const struct config_store_record * program_record(uint8_t page, struct config_store_record *r)
+{
+    r->seq = store_ctx.newest ? (store_ctx.newest->seq + 1) : 0;
+    r->crc = record_crc(r);
+
+    uint16_t offset = store_ctx.free_offset[page];
+    // Место занято, даже если запись не удалась
+    store_ctx.free_offset[page] += sizeof(struct config_store_record);
+
+    if (!flash_storage_program(page, offset, r, sizeof(*r))) {
+        return NULL;
+    }
+
+    const struct config_store_record *written = record_at(page, offset);
+    if (memcmp(written, r, sizeof(*r))) {
+        return NULL;
+    }
+    store_ctx.newest = written;
+    store_ctx.page = page;
+    return written;
+}
+
+// Записывает запись настроек или журнала, r->seq и r->crc заполняются здесь
+static bool write_record(struct config_store_record *r)
+{
+    bool is_journal = (r->magic == CONFIG_STORE_JOURNAL_MAGIC);
+    uint8_t page = store_ctx.page;
+
+    if (store_ctx.free_offset[page] + sizeof(struct config_store_record) > FLASH_STORAGE_PAGE_SIZE) {
+        // Пишем в начало другой страницы. Активной она станет только после успешной записи,
+        // так что страница с последней действительной записью не стирается
+        page = (page + 1) % FLASH_STORAGE_PAGES_COUNT;
+        if (!flash_storage_erase(page)) {
+            return false;
+        }
+        store_ctx.free_offset[page] = 0;
+
+        // Последняя запись другого типа переносится, пока она ещё есть в старой странице
+        const struct config_store_record *other = is_journal ? store_ctx.last : store_ctx.journal;
+        if (other) {
+            struct config_store_record copy = *other;
+            const struct config_store_record *moved = program_record(page, &copy);
+            if (moved == NULL) {
+                return false;
+            }
+            if (is_journal) {
+                store_ctx.last = moved;
+            } else {
+                store_ctx.journal = moved;
+            }
+        }
+    }
+
+    const struct config_store_record *written = program_record(page, r);
+    if (written == NULL) {
+        return false;
+    }
+    if (is_journal) {
+        store_ctx.journal = written;
+    } else {
+        store_ctx.last = written;
+    }
+    return true;
+}
+
+// Возвращает false, если regmap занят и данные нужно прочитать позже
+static bool save(void)
+{
+    struct config_store_record r = {};
+
+    for (unsigned i = 0; i < ARRAY_SIZE(config_regions); i++) {
+        const struct config_store_region *c = &config_regions[i];
+        if (!regmap_get_region_data(c->region, &r.raw[c->offset], c->size)) {
+            return false;
+        }
+    }
+    // Команды и флаги состояния не сохраняются
+    r.data.WDT.reset = 0;
+    r.data.UART_CTRL_MOD1.ctrl.ctrl_applyed = 0;
+    r.data.UART_CTRL_MOD2.ctrl.ctrl_applyed = 0;
+
+    if ((store_ctx.last) && (store_ctx.last->format == CONFIG_STORE_FORMAT) &&
+        (memcmp(store_ctx.last->raw, r.raw, sizeof(r.raw)) == 0))
+    {
+        store_ctx.error = false;
+        return true;
+    }
+
+    r.magic = CONFIG_STORE_MAGIC;
+    r.format = CONFIG_STORE_FORMAT;
+    r.size = sizeof(struct config_store_data);
+
+    store_ctx.error = !write_record(&r);
+    return true;
+}
+
+static void clear(void)
+{
+    bool ok = true;
+
+    // Журнал питания к настройкам не относится и переписывается в чистую страницу
+    struct config_store_record journal;
+    bool has_journal = (store_ctx.journal != NULL);
+    if (has_journal) {
+        journal = *store_ctx.journal;
+    }
+
+    for (uint8_t page = 0; page < FLASH_STORAGE_PAGES_COUNT; page++) {
+        ok = flash_storage_erase(page) && ok;
+        store_ctx.free_offset[page] = 0;
+    }
+    store_ctx.last = NULL;
+    store_ctx.journal = NULL;
+    store_ctx.newest = NULL;
+    store_ctx.page = 0;
+
+    if (has_journal && ok) {
+        ok = write_record(&journal);
+    }
+    store_ctx.error = !ok;
+}
+
+static void publish_ctrl(void)
+{
+    struct REGMAP_CONFIG_CTRL ctrl = {
+        .stored = (store_ctx.last != NULL),
+        .error = store_ctx.error,
+    };
+    if (regmap_set_region_data(REGMAP_REGION_CONFIG_CTRL, &ctrl, sizeof(ctrl))) {
+        store_ctx.publish_pending = false;
+    }
+}
+
+void config_store_init(void)
+{
+    store_ctx.last = NULL;
+    store_ctx.journal = NULL;
+    store_ctx.newest = NULL;
+    store_ctx.page = 0;
+    store_ctx.error = false;
+    store_ctx.save_pending = false;
+    store_ctx.clear_pending = false;
+    store_ctx.invalid_found = false;
+
+    for (uint8_t page = 0; page < FLASH_STORAGE_PAGES_COUNT; page++) {
+        scan_page(page);
+    }
+
+    // Испорченная запись рядом с действительной - обычное дело после пропадания питания при записи
+    if (store_ctx.last == NULL) {
+        if (store_ctx.invalid_found) {
+            event_log(EVENT_LOG_CONFIG_DROPPED);
+        }
+    } else if (store_ctx.last->format != CONFIG_STORE_FORMAT) {
+        event_log(EVENT_LOG_CONFIG_OLD_FORMAT);
+    }
+
+    publish_ctrl();
+    config_store_apply();
+}
+
+void config_store_apply(void)
+{
+    if (store_ctx.last == NULL) {
+        return;
+    }
+    for (unsigned i = 0; i < ARRAY_SIZE(config_regions); i++) {
+        const struct config_store_region *c = &config_regions[i];
+        const uint8_t *stored = &store_ctx.last->raw[c->offset];
+
+        // В записи прежнего формата новых регионов нет
+        if (c->offset >= store_ctx.last->size) {
+            break;
+        }
+        // ...а у последнего региона может не быть новых полей: они остаются текущими
+        uint16_t stored_size = store_ctx.last->size - c->offset;
+        if (stored_size < c->size) {
+            union config_store_region_buf buf;
+            if (!regmap_get_region_data(c->region, &buf, c->size)) {
+                continue;
+            }
+            memcpy(&buf, stored, stored_size);
+            regmap_set_region_data_as_changed(c->region, &buf, c->size);
+            continue;
+        }
+        regmap_set_region_data_as_changed(c->region, stored, c->size);
+    }
+}
+
+void config_store_do_periodic_work(void)
+{
+    struct REGMAP_CONFIG_CTRL ctrl;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_CONFIG_CTRL, &ctrl, sizeof(ctrl))) {
+        store_ctx.save_pending |= ctrl.save;
+        store_ctx.clear_pending |= ctrl.clear;
+        store_ctx.publish_pending = true;
+    }
+
+    if (store_ctx.clear_pending) {
+        clear();
+        store_ctx.clear_pending = false;
+    }
+    if (store_ctx.save_pending) {
+        if (save()) {
+            store_ctx.save_pending = false;
+        }
+    }
+
+    if (store_ctx.publish_pending && !store_ctx.save_pending) {
+        publish_ctrl();
+    }
+}
+
+const void * config_store_get_journal(void)
+{
+    return store_ctx.journal ? store_ctx.journal->raw : NULL;
+}
+
+bool config_store_save_journal(const void *data)
+{
+    struct config_store_record r = {};
+
+    r.magic = CONFIG_STORE_JOURNAL_MAGIC;
+    r.format = CONFIG_STORE_JOURNAL_FORMAT;
+    r.size = CONFIG_STORE_JOURNAL_SIZE;
+    memcpy(r.raw, data, CONFIG_STORE_JOURNAL_SIZE);
+
+    return write_record(&r);
+}
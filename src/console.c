@@ -2,10 +2,16 @@
 #include "config.h"
 #include "usart_tx.h"
 #include "rtc.h"
+#include "event-log.h"
 
 void console_print(const char str[])
 {
-    usart_tx_str_blocking(str);
+    usart_tx_str(str);
+}
+
+void console_print_buf(const char buf[], size_t size)
+{
+    usart_tx_buf(buf, size);
 }
 
 void console_print_dec_pad(int val, unsigned int padding, char padding_char)
@@ -70,6 +76,8 @@ void console_print_time_now(void)
 
 void console_print_prefix(void)
 {
+    // Отложенные события должны попасть в консоль раньше нового сообщения
+    event_log_print_pending();
     console_print(WBEC_DEBUG_MSG_PREFIX);
 }
 
@@ -0,0 +1,226 @@
+#include "event-log.h"
+#include "regmap-int.h"
+#include "systick.h"
+#include "console.h"
+#include "usart_tx.h"
+#include "config.h"
+#include "array_size.h"
+#include <assert.h>
+
+/**
+ * Лог событий в двоичном виде
+ *
+ * В месте возникновения события в кольцевой буфер кладётся только запись:
+ * номер события, время в мс и до двух аргументов. Текст события хранится
+ * в таблице EVENT_LOG_EVENTS и форматируется позже, в задаче с низким
+ * приоритетом (event_log_do_periodic_work), когда в буфере UART есть место.
+ *
+ * Записи читаются двумя независимыми читателями:
+ *  - консоль (UART) - в event_log_do_periodic_work
+ *  - Linux через regmap - так видны события, случившиеся до загрузки Linux
+ *
+ * При переполнении буфера затираются самые старые записи.
+ *
+ * LOG: окно из двух самых старых непрочитанных записей. seq - номер первой
+ * записи в окне, count - число записей в окне, pending - всего непрочитанных
+ * записей, dropped - число записей, затёртых до того, как Linux их прочитал.
+ *
+ * LOG_CTRL:
+ *  - level_mask: маска уровней событий, которые попадают в лог (бит 0 - ERROR, ...)
+ *  - read_seq: номер первой ещё не прочитанной Linux записи. Linux записывает сюда
+ *    seq + count после чтения окна, после чего в окне появляются следующие записи
+ */
+
+#define EVENT_LOG_RECORDS_COUNT     32
+#define EVENT_LOG_RECORDS_MASK      (EVENT_LOG_RECORDS_COUNT - 1)
+// Место в буфере UART, при котором выводится очередная запись
+#define EVENT_LOG_LINE_MAX          128
+
+static_assert((EVENT_LOG_RECORDS_COUNT & EVENT_LOG_RECORDS_MASK) == 0, "Event log records count must be power of 2");
+static_assert(EVENT_LOG_ID_COUNT <= UINT8_MAX, "Event id must fit into uint8_t");
+
+struct event_log_descr {
+    const char *text;
+    uint8_t level;
+};
+
+#define __EVENT_LOG_DESCR(name, lvl, txt)       { .text = txt, .level = EVENT_LOG_LEVEL_##lvl },
+
+static const struct event_log_descr events[] = {
+    EVENT_LOG_EVENTS(__EVENT_LOG_DESCR)
+};
+
+struct event_log_record {
+    uint32_t timestamp;
+    uint8_t id;
+    int16_t arg[2];
+};
+
+// Номера записей не заворачиваются по размеру буфера
+static struct {
+    struct event_log_record records[EVENT_LOG_RECORDS_COUNT];
+    uint16_t head;              // номер следующей записи
+    uint16_t console_tail;      // первая не выведенная в консоль запись
+    uint16_t regmap_tail;       // первая не прочитанная Linux запись
+    uint16_t dropped;
+    uint16_t level_mask;
+    bool publish_pending;
+} log_ctx = {
+    .level_mask = EVENT_LOG_LEVEL_MASK_DEFAULT,
+};
+
+static void print_arg(const char **fmt, int16_t arg)
+{
+    const char *p = *fmt;
+    unsigned fractional_digits = 0;
+
+    if ((p[0] == '.') && (p[1] >= '1') && (p[1] <= '3')) {
+        fractional_digits = p[1] - '0';
+        p += 2;
+    }
+    if (*p != 'd') {
+        // Не аргумент - выводим '%' как есть
+        console_print("%");
+        return;
+    }
+
+    if (fractional_digits) {
+        console_print_fixed_point(arg, fractional_digits);
+    } else {
+        console_print_dec(arg);
+    }
+    *fmt = p + 1;
+}
+
+static void print_record(const struct event_log_record *r)
+{
+    const char *text = events[r->id].text;
+    const char *span = text;
+    unsigned arg_n = 0;
+
+    console_print(WBEC_DEBUG_MSG_PREFIX);
+    while (*text) {
+        if (*text == '%') {
+            console_print_buf(span, text - span);
+            text++;
+            print_arg(&text, (arg_n < ARRAY_SIZE(r->arg)) ? r->arg[arg_n] : 0);
+            arg_n++;
+            span = text;
+        } else {
+            text++;
+        }
+    }
+    console_print_buf(span, text - span);
+    console_print("\r\n");
+}
+
+static void publish_log(void)
+{
+    struct REGMAP_LOG l = {};
+    uint16_t pending = log_ctx.head - log_ctx.regmap_tail;
+
+    l.seq = log_ctx.regmap_tail;
+    l.pending = pending;
+    l.dropped = log_ctx.dropped;
+    l.count = (pending < ARRAY_SIZE(l.record)) ? pending : ARRAY_SIZE(l.record);
+
+    for (unsigned i = 0; i < l.count; i++) {
+        const struct event_log_record *r = &log_ctx.records[(uint16_t)(l.seq + i) & EVENT_LOG_RECORDS_MASK];
+        l.record[i].id = r->id;
+        l.record[i].level = events[r->id].level;
+        l.record[i].timestamp_lo = r->timestamp & 0xFFFF;
+        l.record[i].timestamp_hi = r->timestamp >> 16;
+        l.record[i].arg[0] = r->arg[0];
+        l.record[i].arg[1] = r->arg[1];
+    }
+
+    if (regmap_set_region_data(REGMAP_REGION_LOG, &l, sizeof(l))) {
+        log_ctx.publish_pending = false;
+    }
+}
+
+void event_log_init(void)
+{
+    struct REGMAP_LOG_CTRL ctrl = {
+        .level_mask = log_ctx.level_mask,
+        .read_seq = log_ctx.regmap_tail,
+    };
+    regmap_set_region_data(REGMAP_REGION_LOG_CTRL, &ctrl, sizeof(ctrl));
+
+    publish_log();
+}
+
+void event_log_put(enum event_log_id id, int16_t arg0, int16_t arg1)
+{
+    if (id >= EVENT_LOG_ID_COUNT) {
+        return;
+    }
+    if ((log_ctx.level_mask & (1U << events[id].level)) == 0) {
+        return;
+    }
+
+    // Буфер полон - затираем самую старую запись
+    if ((uint16_t)(log_ctx.head - log_ctx.regmap_tail) >= EVENT_LOG_RECORDS_COUNT) {
+        log_ctx.regmap_tail++;
+        log_ctx.dropped++;
+    }
+    if ((uint16_t)(log_ctx.head - log_ctx.console_tail) >= EVENT_LOG_RECORDS_COUNT) {
+        log_ctx.console_tail++;
+    }
+
+    struct event_log_record *r = &log_ctx.records[log_ctx.head & EVENT_LOG_RECORDS_MASK];
+    r->timestamp = systick_get_system_time_ms();
+    r->id = id;
+    r->arg[0] = arg0;
+    r->arg[1] = arg1;
+
+    log_ctx.head++;
+    log_ctx.publish_pending = true;
+}
+
+// Выводит записи, пока они помещаются в буфер UART, не дожидаясь отправки.
+// Остальные выведет event_log_do_periodic_work
+void event_log_print_pending(void)
+{
+    while ((log_ctx.console_tail != log_ctx.head) && (usart_tx_get_free_space() >= EVENT_LOG_LINE_MAX)) {
+        print_record(&log_ctx.records[log_ctx.console_tail & EVENT_LOG_RECORDS_MASK]);
+        log_ctx.console_tail++;
+    }
+}
+
+// Выводит все записи, дожидаясь отправки, если не хватает места. Только перед standby
+void event_log_flush(void)
+{
+    while (log_ctx.console_tail != log_ctx.head) {
+        if (usart_tx_get_free_space() < EVENT_LOG_LINE_MAX) {
+            usart_tx_flush();
+        }
+        event_log_print_pending();
+    }
+}
+
+void event_log_do_periodic_work(void)
+{
+    struct REGMAP_LOG_CTRL ctrl;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_LOG_CTRL, &ctrl, sizeof(ctrl))) {
+        log_ctx.level_mask = ctrl.level_mask & EVENT_LOG_LEVEL_MASK_ALL;
+
+        // Записи до read_seq прочитаны. Номер за пределами непрочитанных
+        // записей (например, повторная запись старого значения) игнорируется
+        uint16_t read = ctrl.read_seq - log_ctx.regmap_tail;
+        if (read <= (uint16_t)(log_ctx.head - log_ctx.regmap_tail)) {
+            log_ctx.regmap_tail = ctrl.read_seq;
+            log_ctx.publish_pending = true;
+        }
+    }
+
+    if (log_ctx.publish_pending) {
+        publish_log();
+    }
+
+    // За один вызов выводится одна запись, и только если она поместится в буфер UART
+    if ((log_ctx.console_tail != log_ctx.head) && (usart_tx_get_free_space() >= EVENT_LOG_LINE_MAX)) {
+        print_record(&log_ctx.records[log_ctx.console_tail & EVENT_LOG_RECORDS_MASK]);
+        log_ctx.console_tail++;
+    }
+}
@@ -0,0 +1,106 @@
+#include "flash.h"
+#include "wbmcu_system.h"
+#include "atomic.h"
+#include <string.h>
+
+/**
+ * Запись во flash (RM0454, раздел 3.3)
+ *
+ * Пока идёт стирание или запись, чтение flash останавливается, т.е. ядро
+ * стоит до окончания операции. Прерывания при этом не запрещены, но их обработчики
+ * и таблица векторов тоже во flash, поэтому задержка реакции на прерывание
+ * достигает времени операции: стирание страницы 22-40 мс, запись двойного слова ~85 мкс.
+ * Под запретом прерываний выполняется только запуск операции.
+ *
+ * Поэтому стирание и запись вызываются только из периодических задач основного цикла
+ * и редко - только по команде из Linux.
+ */
+
+#define FLASH_KEY1                      0x45670123
+#define FLASH_KEY2                      0xCDEF89AB
+
+#define FLASH_SR_ERRORS                 (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | \
+                                         FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_PGSERR | \
+                                         FLASH_SR_MISERR | FLASH_SR_FASTERR)
+
+// Задаются в ldscript
+extern uint8_t __storage_start[];
+
+static inline void flash_wait_ready(void)
+{
+    while (FLASH->SR & FLASH_SR_BSY1) {};
+}
+
+static void flash_unlock(void)
+{
+    flash_wait_ready();
+    if (FLASH->CR & FLASH_CR_LOCK) {
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+    // Сбрасываем ошибки от прошлых операций, иначе новая не запустится
+    FLASH->SR = FLASH_SR_ERRORS | FLASH_SR_EOP;
+}
+
+static bool flash_lock(void)
+{
+    flash_wait_ready();
+    bool ok = ((FLASH->SR & FLASH_SR_ERRORS) == 0);
+    FLASH->CR = FLASH_CR_LOCK;
+    return ok;
+}
+
+static inline unsigned storage_page_number(unsigned page)
+{
+    return ((uint32_t)__storage_start - FLASH_BASE) / FLASH_STORAGE_PAGE_SIZE + page;
+}
+
+const uint8_t * flash_storage_page_addr(unsigned page)
+{
+    return &__storage_start[page * FLASH_STORAGE_PAGE_SIZE];
+}
+
+bool flash_storage_erase(unsigned page)
+{
+    if (page >= FLASH_STORAGE_PAGES_COUNT) {
+        return false;
+    }
+
+    ATOMIC {
+        flash_unlock();
+        FLASH->CR = FLASH_CR_PER | (storage_page_number(page) << FLASH_CR_PNB_Pos);
+        FLASH->CR |= FLASH_CR_STRT;
+    }
+    return flash_lock();
+}
+
+bool flash_storage_program(unsigned page, uint16_t offset, const void *data, uint16_t size)
+{
+    if ((page >= FLASH_STORAGE_PAGES_COUNT) ||
+        (offset % FLASH_STORAGE_WRITE_UNIT) || (size % FLASH_STORAGE_WRITE_UNIT) ||
+        (offset + size > FLASH_STORAGE_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    volatile uint32_t *dst = (volatile uint32_t *)&__storage_start[page * FLASH_STORAGE_PAGE_SIZE + offset];
+    const uint8_t *src = data;
+    bool ok = true;
+
+    for (uint16_t i = 0; (i < size) && ok; i += FLASH_STORAGE_WRITE_UNIT) {
+        uint32_t w[2];
+        // data может быть не выровнен
+        memcpy(w, &src[i], sizeof(w));
+
+        ATOMIC {
+            flash_unlock();
+            FLASH->CR = FLASH_CR_PG;
+            // Двойное слово записывается двумя словами подряд, запись стартует после второго
+            dst[0] = w[0];
+            dst[1] = w[1];
+        }
+        ok = flash_lock();
+        dst += 2;
+    }
+    return ok;
+}
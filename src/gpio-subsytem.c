@@ -6,12 +6,20 @@
 #include "voltage-monitor.h"
 #include "shared-gpio.h"
 #include "bits.h"
+#include "adc.h"
+#include "irq-subsystem.h"
+#include <assert.h>
 
 /**
  * Модуль занимается работой с регионом GPIO в regmap
  *
  * Устанавливает состояния GPIO в regmap, если это входы
  * Управляет GPIO, если это выходы
+ *
+ * Входы A1-A4 - аналоговые, цифровое состояние получается в АЦП сравнением
+ * с порогами с гистерезисом из GPIO_DIN_CFG (вход выключен, если high не больше low).
+ * Количество переключений каждого входа - в GPIO_DIN_CNT, при любом переключении
+ * выставляется флаг IRQ_GPIO_DIN.
  */
 
 // Значения в регионе GPIO_AF (по 2 бита на пин)
@@ -57,12 +65,15 @@ enum ec_ext_gpio {
 
 static const gpio_pin_t v_out_gpio = { EC_GPIO_VOUT_EN };
 
+static_assert((EC_EXT_GPIO_A1 == 0) && (EC_EXT_GPIO_A4 == ADC_DIN_COUNT - 1), "A1-A4 GPIO bits must match ADC digital inputs");
+
 struct gpio_ctx {
     uint16_t gpio_ctrl_req_val;
     uint16_t gpio_ctrl_req_mask;
     uint16_t gpio_ctrl;
     uint16_t gpio_dir;
     uint16_t gpio_af;
+    struct REGMAP_GPIO_DIN_CNT din_cnt;
 };
 
 static struct gpio_ctx gpio_ctx = {
@@ -186,16 +197,38 @@ static void set_mod_gpio_values(uint16_t new_ctrl)
     #endif
 }
 
+static void set_din_thresholds(const struct REGMAP_GPIO_DIN_CFG *cfg)
+{
+    for (enum adc_din din = 0; din < ADC_DIN_COUNT; din++) {
+        adc_din_set_thresholds(din, cfg->a[din].low_mv, cfg->a[din].high_mv);
+    }
+}
+
+// Обновляет счётчики переключений входов A1-A4, возвращает true, если что-то переключилось
+static bool collect_din_counters(void)
+{
+    bool changed = false;
+    for (enum adc_din din = 0; din < ADC_DIN_COUNT; din++) {
+        uint16_t rising = adc_din_get_rising_count(din);
+        uint16_t falling = adc_din_get_falling_count(din);
+        if ((rising != gpio_ctx.din_cnt.rising[din]) || (falling != gpio_ctx.din_cnt.falling[din])) {
+            gpio_ctx.din_cnt.rising[din] = rising;
+            gpio_ctx.din_cnt.falling[din] = falling;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
 static void collect_gpio_states(void)
 {
-    // Планировали сделать гистерезис на Analog Watchdog
-    // вместо использования аппаратных внешних компараторов
-    gpio_ctx.gpio_ctrl &= ~(
-        BIT(EC_EXT_GPIO_A1) |
-        BIT(EC_EXT_GPIO_A2) |
-        BIT(EC_EXT_GPIO_A3) |
-        BIT(EC_EXT_GPIO_A4)
-    );
+    const uint16_t din_mask = BIT(EC_EXT_GPIO_A1) | BIT(EC_EXT_GPIO_A2) | BIT(EC_EXT_GPIO_A3) | BIT(EC_EXT_GPIO_A4);
+    gpio_ctx.gpio_ctrl &= ~din_mask;
+    gpio_ctx.gpio_ctrl |= adc_din_get_states() & din_mask;
+
+    if (collect_din_counters()) {
+        irq_set_flag(IRQ_GPIO_DIN);
+    }
 
     #if defined EC_MOD1_MOD2_GPIO_CONTROL
         for (unsigned mod = 0; mod < MOD_COUNT; mod++) {
@@ -238,6 +271,11 @@ void gpio_reset(void)
     set_mod_gpio_dir(OUTPUTS_ONLY_GPIOS);
     set_mod_gpio_af();
 
+    // Цифровые входы A1-A4 выключены
+    struct REGMAP_GPIO_DIN_CFG din_cfg = {};
+    set_din_thresholds(&din_cfg);
+    regmap_set_region_data(REGMAP_REGION_GPIO_DIN_CFG, &din_cfg, sizeof(din_cfg));
+
     regmap_set_region_data(REGMAP_REGION_GPIO_CTRL, &gpio_ctx.gpio_ctrl, sizeof(gpio_ctx.gpio_ctrl));
     regmap_set_region_data(REGMAP_REGION_GPIO_DIR, &gpio_ctx.gpio_dir, sizeof(gpio_ctx.gpio_dir));
     regmap_set_region_data(REGMAP_REGION_GPIO_AF, &gpio_ctx.gpio_af, sizeof(gpio_ctx.gpio_af));
@@ -262,10 +300,16 @@ void gpio_do_periodic_work(void)
         set_mod_gpio_af();
     }
 
+    struct REGMAP_GPIO_DIN_CFG din_cfg;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_GPIO_DIN_CFG, &din_cfg, sizeof(din_cfg))) {
+        set_din_thresholds(&din_cfg);
+    }
+
     // V_OUT нужно мониторить постоянно, т.к. его состояние зависит от входного напряжения
     control_v_out();
 
     collect_gpio_states();
 
     regmap_set_region_data(REGMAP_REGION_GPIO_CTRL, &gpio_ctx.gpio_ctrl, sizeof(gpio_ctx.gpio_ctrl));
+    regmap_set_region_data(REGMAP_REGION_GPIO_DIN_CNT, &gpio_ctx.din_cnt, sizeof(gpio_ctx.din_cnt));
 }
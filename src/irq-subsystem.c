@@ -3,6 +3,7 @@
 #include "regmap-int.h"
 #include "config.h"
 #include "gpio.h"
+#include "atomic.h"
 
 /**
  * IRQ subsystem представляет интерфейс для работы с флагами прерываний в regmap
@@ -18,6 +19,9 @@
  * Чтобы сбросить флаг прерывания - нужно записать "1" в соответствующий бит регистра сброса
  *
  * В линуксе для этого есть удобный интерфейс regmap_irq_chip
+ *
+ * irq_set_flag можно вызывать из прерываний: INT GPIO в этом случае выставляется сразу,
+ * не дожидаясь основного цикла
  */
 
 static_assert((sizeof(irq_flags_t) * 8) >= IRQ_COUNT, "IRQ flags not fitted to `irq_flags` type");
@@ -26,7 +30,7 @@ static_assert((sizeof(irq_flags_t) * 8) >= IRQ_COUNT, "IRQ flags not fitted to `
     static const gpio_pin_t int_gpio = { EC_GPIO_INT };
 #endif
 
-static irq_flags_t flags = 0;
+static volatile irq_flags_t flags = 0;
 static irq_flags_t mask = 0;
 
 #if defined EC_GPIO_INT
@@ -72,7 +76,12 @@ irq_flags_t irq_get_flags(void)
 
 void irq_set_flag(enum irq_flag f)
 {
-    flags |= (1 << f);
+    ATOMIC {
+        flags |= (1 << f);
+        if (flags & mask) {
+            set_int_gpio_active();
+        }
+    }
 }
 
 void irq_set_mask(irq_flags_t m)
@@ -82,7 +91,9 @@ void irq_set_mask(irq_flags_t m)
 
 void irq_clear_flags(irq_flags_t f)
 {
-    flags &= ~f;
+    ATOMIC {
+        flags &= ~f;
+    }
 }
 
 void irq_do_periodic_work(void)
@@ -8,10 +8,30 @@
 #include "mcu-pwr.h"
 #include "adc.h"
 #include "system-led.h"
-#include "console.h"
+#include "event-log.h"
+#include "power-journal.h"
+#include "boot-timeline.h"
 #include "regmap-int.h"
 #include "wbmz-common.h"
 #include "wdt-stm32.h"
+#include <string.h>
+
+/**
+ * Тайминги последовательности включения и сброса питания задаются таблицей PWR_SEQ_CFG:
+ * значения по умолчанию - в config.h (модель может их переопределить), Linux может изменить их
+ * через regmap (значения ограничиваются допустимыми и записываются обратно) и сохранить во flash.
+ * Там же задаются условия досрочного выхода из шагов: порог 3.3В, при котором питание
+ * считается включенным (STEP1, STEP2), и порог, ниже которого сброс PMIC закончен.
+ * Порог 0 - по статусу канала V33 voltage monitor, как было до появления настройки.
+ *
+ * PWR_SEQ_TIMES: сколько времени последняя последовательность включения провела в каждом шаге
+ * и сколько раз нажимался PWRON. Считается заново при каждом включении/сбросе,
+ * публикуется по окончании включения (PS_ON_COMPLETE).
+ *
+ * Пока питание Linux отключается штатно (выключение, сброс 5В, сброс PMIC), watchdog АЦП
+ * на отключаемых линиях запрещён, иначе это считалось бы аварией питания (IRQ_PWR_FAIL).
+ * Разрешается снова, когда включение закончено.
+ */
 
 static const gpio_pin_t gpio_linux_power = { EC_GPIO_LINUX_POWER };
 static const gpio_pin_t gpio_pmic_pwron = { EC_GPIO_LINUX_PMIC_PWRON };
@@ -33,15 +53,46 @@ enum pwr_state {
     PS_RESET_PMIC_WAIT,                 // Сброс PMIC через PMIC_RESET_PWROK. Ждём, пока пропадёт 3.3В
 };
 
+// Линия 3.3В не разрядилась за время сброса питания
+#define POWER_RESET_NOT_DISCHARGED      UINT16_MAX
+
+// Допустимые значения PWR_SEQ_CFG
+#define PWR_SEQ_CFG_TIME_MIN_MS         100
+#define PWR_SEQ_CFG_TIME_MAX_MS         10000
+#define PWR_SEQ_CFG_ATTEMPTS_MAX        10
+#define PWR_SEQ_CFG_DISCHARGED_MV_MAX   3000    // 0 - не ждать разрядки 3.3В при сбросе
+#define PWR_SEQ_CFG_V33_MV_MAX          3300    // 0 - по статусу vmon
+
+#define PWR_SEQ_CFG_DEFAULT { \
+    .wait_3v3_ms = WBEC_LINUX_POWER_WAIT_3V3_MS, \
+    .pmic_pwron_ms = WBEC_LINUX_POWER_PMIC_PWRON_MS, \
+    .pmic_pwron_pause_ms = WBEC_LINUX_POWER_PMIC_PWRON_PAUSE_MS, \
+    .pmic_pwron_attempts = WBEC_LINUX_POWER_PMIC_PWRON_ATTEMPTS, \
+    .pmic_reset_ms = WBEC_LINUX_POWER_PMIC_RESET_MS, \
+    .reset_min_ms = WBEC_POWER_RESET_TIME_MIN_MS, \
+    .reset_max_ms = WBEC_POWER_RESET_TIME_MS, \
+    .reset_v33_discharged_mv = WBEC_POWER_RESET_V33_DISCHARGED_MV, \
+    .v33_on_mv = WBEC_LINUX_POWER_V33_ON_MV, \
+    .v33_off_mv = WBEC_LINUX_POWER_V33_OFF_MV, \
+}
+
 struct pwr_ctx {
     enum pwr_state state;
     systime_t timestamp;
     unsigned attempt;
     bool initialized;
+    // Последний сброс питания через 5В: время от выключения 5В, мс
+    uint16_t v33_discharge_ms;
+    uint16_t reset_off_ms;
+    bool reset_publish_pending;
+    struct REGMAP_PWR_SEQ_CFG cfg;
+    struct REGMAP_PWR_SEQ_TIMES times;
+    bool times_publish_pending;
 };
 
 static struct pwr_ctx pwr_ctx = {
     .state = PS_INIT_OFF,
+    .cfg = PWR_SEQ_CFG_DEFAULT,
 };
 
 static inline void linux_cpu_pwr_5v_gpio_on(void)   { GPIO_S_SET(gpio_linux_power); }
@@ -51,10 +102,24 @@ static inline void pmic_pwron_gpio_off(void)        { GPIO_S_RESET(gpio_pmic_pwr
 static inline void pmic_reset_gpio_on(void)         { GPIO_S_SET(gpio_pmic_reset_pwrok); }
 static inline void pmic_reset_gpio_off(void)        { GPIO_S_RESET(gpio_pmic_reset_pwrok); }
 
-static inline void new_state(enum pwr_state s)
+// 5В процессорного модуля EC не измеряет (ADC_5V - до ключа питания Linux),
+// поэтому при сбросе запрещается только watchdog 3.3В
+static inline void planned_v33_off(void)
 {
-    pwr_ctx.state = s;
-    pwr_ctx.timestamp = systick_get_system_time_ms();
+    vmon_awd_inhibit(VMON_CHANNEL_V33, true);
+}
+
+// Выключение: отключается WBMZ и может пропасть и 5В
+static inline void planned_v50_v33_off(void)
+{
+    vmon_awd_inhibit(VMON_CHANNEL_V33, true);
+    vmon_awd_inhibit(VMON_CHANNEL_V50, true);
+}
+
+static inline void rails_on_complete(void)
+{
+    vmon_awd_inhibit(VMON_CHANNEL_V33, false);
+    vmon_awd_inhibit(VMON_CHANNEL_V50, false);
 }
 
 static inline systime_t in_state_time_ms(void)
@@ -62,20 +127,163 @@ static inline systime_t in_state_time_ms(void)
     return systick_get_time_since_timestamp(pwr_ctx.timestamp);
 }
 
+static inline uint16_t add_step_time(uint16_t t, systime_t ms)
+{
+    return (t + ms < UINT16_MAX) ? (t + ms) : UINT16_MAX;
+}
+
+// Добавляет время, проведённое в текущем шаге, в PWR_SEQ_TIMES
+static void account_step_time(void)
+{
+    systime_t ms = in_state_time_ms();
+
+    switch (pwr_ctx.state) {
+    case PS_ON_STEP1_WAIT_3V3:
+        pwr_ctx.times.wait_3v3_ms = add_step_time(pwr_ctx.times.wait_3v3_ms, ms);
+        break;
+    case PS_ON_STEP2_PMIC_PWRON:
+        pwr_ctx.times.pmic_pwron_ms = add_step_time(pwr_ctx.times.pmic_pwron_ms, ms);
+        break;
+    case PS_ON_STEP3_PMIC_PWRON_OFF_WAIT:
+        pwr_ctx.times.pmic_pwron_pause_ms = add_step_time(pwr_ctx.times.pmic_pwron_pause_ms, ms);
+        break;
+    case PS_RESET_PMIC_WAIT:
+        pwr_ctx.times.pmic_reset_ms = add_step_time(pwr_ctx.times.pmic_reset_ms, ms);
+        break;
+    default:
+        break;
+    }
+}
+
+static void publish_step_times(void)
+{
+    pwr_ctx.times_publish_pending = !regmap_set_region_data(REGMAP_REGION_PWR_SEQ_TIMES, &pwr_ctx.times, sizeof(pwr_ctx.times));
+}
+
+// Начало новой последовательности: время шагов считается заново
+static inline void restart_step_times(void)
+{
+    memset(&pwr_ctx.times, 0, sizeof(pwr_ctx.times));
+}
+
+static void new_state(enum pwr_state s)
+{
+    account_step_time();
+
+    pwr_ctx.state = s;
+    pwr_ctx.timestamp = systick_get_system_time_ms();
+
+    if (s == PS_ON_STEP2_PMIC_PWRON) {
+        pwr_ctx.times.pmic_pwron_count++;
+    } else if (s == PS_ON_COMPLETE) {
+        rails_on_complete();
+        publish_step_times();
+    }
+}
+
+static uint16_t limit_value(uint16_t value, uint16_t min, uint16_t max)
+{
+    if (value < min) {
+        return min;
+    }
+    if (value > max) {
+        return max;
+    }
+    return value;
+}
+
+static void publish_config(void)
+{
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &pwr_ctx.cfg, sizeof(pwr_ctx.cfg));
+}
+
+// Новые тайминги применяются со следующего шага
+static void apply_config(const struct REGMAP_PWR_SEQ_CFG * c)
+{
+    struct REGMAP_PWR_SEQ_CFG * cfg = &pwr_ctx.cfg;
+
+    cfg->wait_3v3_ms = limit_value(c->wait_3v3_ms, PWR_SEQ_CFG_TIME_MIN_MS, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->pmic_pwron_ms = limit_value(c->pmic_pwron_ms, PWR_SEQ_CFG_TIME_MIN_MS, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->pmic_pwron_pause_ms = limit_value(c->pmic_pwron_pause_ms, PWR_SEQ_CFG_TIME_MIN_MS, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->pmic_pwron_attempts = limit_value(c->pmic_pwron_attempts, 0, PWR_SEQ_CFG_ATTEMPTS_MAX);
+    cfg->pmic_reset_ms = limit_value(c->pmic_reset_ms, PWR_SEQ_CFG_TIME_MIN_MS, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->reset_min_ms = limit_value(c->reset_min_ms, PWR_SEQ_CFG_TIME_MIN_MS, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->reset_max_ms = limit_value(c->reset_max_ms, cfg->reset_min_ms, PWR_SEQ_CFG_TIME_MAX_MS);
+    cfg->reset_v33_discharged_mv = limit_value(c->reset_v33_discharged_mv, 0, PWR_SEQ_CFG_DISCHARGED_MV_MAX);
+    cfg->v33_on_mv = limit_value(c->v33_on_mv, 0, PWR_SEQ_CFG_V33_MV_MAX);
+    cfg->v33_off_mv = limit_value(c->v33_off_mv, 0, PWR_SEQ_CFG_V33_MV_MAX);
+}
+
+// Условия досрочного выхода из шагов. Значение АЦП отфильтровано, как и статус vmon
+static bool v33_on(void)
+{
+    if (pwr_ctx.cfg.v33_on_mv == 0) {
+        return vmon_get_ch_status(VMON_CHANNEL_V33);
+    }
+    return (adc_get_ch_mv(ADC_CHANNEL_ADC_3V3) >= pwr_ctx.cfg.v33_on_mv);
+}
+
+static bool v33_off(void)
+{
+    if (pwr_ctx.cfg.v33_off_mv == 0) {
+        return !vmon_get_ch_status(VMON_CHANNEL_V33);
+    }
+    return (adc_get_ch_mv(ADC_CHANNEL_ADC_3V3) < pwr_ctx.cfg.v33_off_mv);
+}
+
+
+static void start_5v_reset(void)
+{
+    planned_v33_off();
+    linux_cpu_pwr_5v_gpio_off();
+    pwr_ctx.v33_discharge_ms = POWER_RESET_NOT_DISCHARGED;
+    new_state(PS_RESET_5V_WAIT);
+}
+
+// Запоминает время, когда линия 3.3В впервые опустилась ниже порога разрядки
+// Значение АЦП отфильтровано, т.е. отстаёт от реального - это в безопасную сторону
+static bool v33_discharged(void)
+{
+    if ((pwr_ctx.v33_discharge_ms == POWER_RESET_NOT_DISCHARGED) &&
+        (adc_get_ch_mv(ADC_CHANNEL_ADC_3V3) < pwr_ctx.cfg.reset_v33_discharged_mv))
+    {
+        pwr_ctx.v33_discharge_ms = in_state_time_ms();
+    }
+    return (pwr_ctx.v33_discharge_ms != POWER_RESET_NOT_DISCHARGED);
+}
+
+static void publish_reset_times(void)
+{
+    struct REGMAP_POWER_RESET r = {
+        .v33_discharge_ms = pwr_ctx.v33_discharge_ms,
+        .off_ms = pwr_ctx.reset_off_ms,
+    };
+    pwr_ctx.reset_publish_pending = !regmap_set_region_data(REGMAP_REGION_POWER_RESET, &r, sizeof(r));
+}
 
 static void goto_standby_and_save_5v_status(void)
 {
     if (vmon_get_ch_status(VMON_CHANNEL_V50)) {
-        console_print_w_prefix("5V line status: voltage present\r\n");
+        event_log(EVENT_LOG_V50_PRESENT);
         mcu_save_vcc_5v_last_state(MCU_VCC_5V_STATE_ON);
     } else {
-        console_print_w_prefix("5V line status: no voltage\r\n");
+        event_log(EVENT_LOG_V50_ABSENT);
         mcu_save_vcc_5v_last_state(MCU_VCC_5V_STATE_OFF);
     }
-    console_print_w_prefix("Power off and go to standby now\r\n");
+    event_log(EVENT_LOG_GOTO_STANDBY);
+    power_journal_add(POWER_JOURNAL_STANDBY, 0);
     linux_cpu_pwr_seq_off_and_goto_standby(WBEC_PERIODIC_WAKEUP_FIRST_TIMEOUT_S);
 }
 
+/**
+ * @brief Публикует тайминги по умолчанию в regmap.
+ * Вызывается до восстановления сохранённых настроек (config_store_init)
+ */
+void linux_cpu_pwr_seq_config_init(void)
+{
+    publish_config();
+}
+
 /**
  * @brief Инициализирует GPIO управления питанием как выходы.
  * При включении питания WB питание на процессор не подается, пока не зарядится RC-цепочка
@@ -137,7 +345,9 @@ void linux_cpu_pwr_seq_on(void)
     }
 
     linux_cpu_pwr_5v_gpio_on();
+    boot_timeline_mark(BOOT_MILESTONE_LINUX_POWER_ON);
     new_state(PS_ON_STEP1_WAIT_3V3);
+    restart_step_times();
 }
 
 /**
@@ -146,20 +356,21 @@ void linux_cpu_pwr_seq_on(void)
  */
 void linux_cpu_pwr_seq_hard_off(void)
 {
+    planned_v50_v33_off();
     linux_cpu_pwr_5v_gpio_off();
     pmic_pwron_gpio_off();
     new_state(PS_OFF_COMPLETE);
 }
 
 /**
- * @brief Сброс питания (выключение и через 1с включение)
+ * @brief Сброс питания (выключение и включение после разрядки 3.3В, но не дольше 1с)
  * Через отключение 5В (без PMIC)
  */
 void linux_cpu_pwr_seq_hard_reset()
 {
-    linux_cpu_pwr_5v_gpio_off();
     pmic_pwron_gpio_off();
-    new_state(PS_RESET_5V_WAIT);
+    start_5v_reset();
+    restart_step_times();
 }
 
 /**
@@ -169,8 +380,10 @@ void linux_cpu_pwr_seq_hard_reset()
  */
 void linux_cpu_pwr_seq_reset_pmic(void)
 {
+    planned_v33_off();
     pmic_reset_gpio_on();
     new_state(PS_RESET_PMIC_WAIT);
+    restart_step_times();
 }
 
 /**
@@ -189,14 +402,20 @@ bool linux_cpu_pwr_seq_is_busy(void)
 
 void linux_cpu_pwr_seq_do_periodic_work(void)
 {
+    struct REGMAP_PWR_SEQ_CFG c;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_PWR_SEQ_CFG, &c, sizeof(c))) {
+        apply_config(&c);
+        publish_config();
+    }
+
     if (!vmon_ready() || !pwr_ctx.initialized) {
         return;
     }
 
     if (pwrkey_handle_long_press()) {
+        planned_v50_v33_off();
         linux_cpu_pwr_5v_gpio_off();
-        console_print("\r\n\n");
-        console_print_w_prefix("Power off after power key long press detected.\r\n");
+        event_log(EVENT_LOG_PWRKEY_LONG_PRESS_OFF);
         system_led_disable();
         wbmz_disable_stepup();
         // Ждём отпускания кнопки
@@ -212,10 +431,17 @@ void linux_cpu_pwr_seq_do_periodic_work(void)
     // или Vin < 9V или выдернули USB (WBMZ при этом не был включен)
     // В общем случае - не важно почему +5В пропало. Нужно перейти в спящий режим
     if (!vmon_get_ch_status(VMON_CHANNEL_V50)) {
-        console_print_w_prefix("Voltage on 5V line is lost, power off and go to standby now\r\n");
+        event_log(EVENT_LOG_V50_LOST);
         goto_standby_and_save_5v_status();
     }
 
+    if (pwr_ctx.reset_publish_pending) {
+        publish_reset_times();
+    }
+    if (pwr_ctx.times_publish_pending) {
+        publish_step_times();
+    }
+
     switch (pwr_ctx.state) { // GCOVR_EXCL_LINE
     // Если алгоритм ещё не начался - ничего не делаем
     case PS_INIT_OFF:
@@ -238,13 +464,13 @@ void linux_cpu_pwr_seq_do_periodic_work(void)
 
     // Первый шаг включения питания: проверка, что 3.3В появилось, после того как подали 5В
     case PS_ON_STEP1_WAIT_3V3:
-        if (vmon_get_ch_status(VMON_CHANNEL_V33)) {
+        if (v33_on()) {
             // Если 3.3В появилось, то считаем что питание включено
             new_state(PS_ON_COMPLETE);
         }
-        if (in_state_time_ms() > 1000) {
+        if (in_state_time_ms() > pwr_ctx.cfg.wait_3v3_ms) {
             // Если 3.3В не появилось, то попробуем включить PMIC через PWRON
-            console_print_w_prefix("No voltage on 3.3V line, try to switch on PMIC throught PWRON\r\n");
+            event_log(EVENT_LOG_PMIC_PWRON_NO_3V3);
             pmic_pwron_gpio_on();
             pwr_ctx.attempt = 0;
             new_state(PS_ON_STEP2_PMIC_PWRON);
@@ -256,39 +482,42 @@ void linux_cpu_pwr_seq_do_periodic_work(void)
     // Это не штатный режим и сюда попадать по идее не должны
     // PMIC должен включаться сам после подачи 5В
     case PS_ON_STEP2_PMIC_PWRON:
-        if (vmon_get_ch_status(VMON_CHANNEL_V33)) {
+        if (v33_on()) {
             // Если 3.3В
             pmic_pwron_gpio_off();
             new_state(PS_ON_COMPLETE);
         }
-        if (in_state_time_ms() > 1500) {
+        if (in_state_time_ms() > pwr_ctx.cfg.pmic_pwron_ms) {
             pwr_ctx.attempt++;
             pmic_pwron_gpio_off();
-            if (pwr_ctx.attempt <= 3) {
+            if (pwr_ctx.attempt <= pwr_ctx.cfg.pmic_pwron_attempts) {
                 // Если попытки не исчерпаны - отключаем PWRON и пробуем ещё
                 new_state(PS_ON_STEP3_PMIC_PWRON_OFF_WAIT);
             } else {
                 // Если попытки кончились - сбрасываем 5В и начинаем заново
-                console_print_w_prefix("Still no voltage on 3.3V line, reset 5V line and try to switch on again\r\n");
-                // Выключаем линию 5В на время WBEC_POWER_RESET_TIME_MS
-                linux_cpu_pwr_5v_gpio_off();
-                new_state(PS_RESET_5V_WAIT);
+                event_log(EVENT_LOG_PMIC_PWRON_FAILED);
+                // Выключаем линию 5В до разрядки 3.3В, но не дольше reset_max_ms
+                start_5v_reset();
             }
         }
         break;
 
     // Третий шаг включения - отпускаем PWRON, ждём, пробуем ещё раз
     case PS_ON_STEP3_PMIC_PWRON_OFF_WAIT:
-        if (in_state_time_ms() > 500) {
-            console_print_w_prefix("One more attempt to switch on PMIC throught PWRON\r\n");
+        if (in_state_time_ms() > pwr_ctx.cfg.pmic_pwron_pause_ms) {
+            event_log(EVENT_LOG_PMIC_PWRON_RETRY);
             pmic_pwron_gpio_on();
             new_state(PS_ON_STEP2_PMIC_PWRON);
         }
         break;
 
-    // Сброс питания 5В
+    // Сброс питания 5В: ждём разрядки 3.3В, но не меньше минимального и не больше максимального времени
     case PS_RESET_5V_WAIT:
-        if (in_state_time_ms() > WBEC_POWER_RESET_TIME_MS) {
+        if ((v33_discharged() && (in_state_time_ms() > pwr_ctx.cfg.reset_min_ms)) ||
+            (in_state_time_ms() > pwr_ctx.cfg.reset_max_ms))
+        {
+            pwr_ctx.reset_off_ms = in_state_time_ms();
+            publish_reset_times();
             linux_cpu_pwr_5v_gpio_on();
             new_state(PS_ON_STEP1_WAIT_3V3);
         }
@@ -296,8 +525,8 @@ void linux_cpu_pwr_seq_do_periodic_work(void)
 
     // Сброс PMIC через RESET самого PMIC
     case PS_RESET_PMIC_WAIT:
-        if ((!vmon_get_ch_status(VMON_CHANNEL_V33)) || (in_state_time_ms() > 2000)) {
-            console_print_w_prefix("PMIC was reset throught RESET line\r\n");
+        if ((v33_off()) || (in_state_time_ms() > pwr_ctx.cfg.pmic_reset_ms)) {
+            event_log(EVENT_LOG_PMIC_RESET_DONE);
             pmic_reset_gpio_off();
             pmic_pwron_gpio_off();
             new_state(PS_ON_STEP1_WAIT_3V3);
@@ -309,11 +538,12 @@ void linux_cpu_pwr_seq_do_periodic_work(void)
 }
 
 #ifdef __unittest_env__
-    #include <string.h>
-
     void utest_linux_power_control_reset_state(void)
     {
+        static const struct REGMAP_PWR_SEQ_CFG cfg_default = PWR_SEQ_CFG_DEFAULT;
+
         memset(&pwr_ctx, 0, sizeof(pwr_ctx));
         pwr_ctx.state = PS_INIT_OFF;
+        pwr_ctx.cfg = cfg_default;
     }
 #endif
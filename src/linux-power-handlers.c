@@ -2,6 +2,7 @@
 #include "uart-regmap-subsystem.h"
 #include "usart_tx.h"
 #include "gpio-subsystem.h"
+#include "config-store.h"
 
 // Дёргается, когда включается питание процессора (начинает грузиться линукс)
 void linux_poweron_handler(void)
@@ -12,4 +13,8 @@ void linux_poweron_handler(void)
     #if defined EC_UART_REGMAP_SUPPORT
         uart_regmap_subsystem_init();
     #endif
+
+    // После сброса в значения по умолчанию применяем сохранённые настройки,
+    // чтобы UART и GPIO работали ещё до загрузки драйверов в Linux
+    config_store_apply();
 }
@@ -25,6 +25,16 @@
 #include "software_i2c.h"
 #include "uart-regmap-subsystem.h"
 #include "wdt-stm32.h"
+#include "brownout-capture.h"
+#include "adc-subsystem.h"
+#include "scheduler.h"
+#include "perf-subsystem.h"
+#include "event-log.h"
+#include "power-journal.h"
+#include "config-store.h"
+#include "boot-timeline.h"
+#include "array_size.h"
+#include <assert.h>
 
 int main(void)
 {
@@ -47,15 +57,6 @@ int main(void)
     system_led_disable();
 
     rtc_init();
-    // После подачи питания на ЕС или пробуждения из standby
-    // Мы находимся в режиме low power run 1 MHz
-    // Также тут может быть питание ниже чем 3.3В (от WBMZ BATSENSE)
-    // Инициализируем АЦП на внутренний VREF и частоту 1 MHz
-    // Это нужно для того, чтобы измерить напряжение на линии +5В и решить что делать дальше
-    // Измерение проиходит в wbec_init()
-    adc_init(ADC_CLOCK_NO_DIV, ADC_VREF_INT);
-    while (!adc_get_ready()) {};
-
     mcu_init_poweron_reason();
 
     // Кнопка питания инициализируется после mcu_init_poweron_reason, т.к.
@@ -64,9 +65,23 @@ int main(void)
     // Errata 2.2.2
     // Ещё особенность: при длинном нажатии EC_RESET причина включения переопределяется
     // на RTC_PERIODIC_WAKEUP и в этом случае pwrkey_init тоже нужно вызывать.
-    // То есть оно должно быть до wbec_init()
+    // То есть оно должно быть до wbec_init() и до засыпания в быстром пути
     pwrkey_init();
 
+    // Периодическое пробуждение без +5В (питание от WBMZ) - самый частый случай,
+    // поэтому проверяется однократным измерением без полной инициализации, и EC сразу засыпает
+    wbec_periodic_wakeup_fast_path();
+
+    // После подачи питания на ЕС или пробуждения из standby
+    // Мы находимся в режиме low power run 1 MHz
+    // Также тут может быть питание ниже чем 3.3В (от WBMZ BATSENSE)
+    // Инициализируем АЦП на внутренний VREF и частоту 1 MHz
+    // Это нужно для того, чтобы измерить напряжение на линии +5В и решить что делать дальше
+    // Измерение проиходит в wbec_init()
+    adc_init(ADC_CLOCK_NO_DIV, ADC_VREF_INT);
+    while (!adc_get_ready()) {};
+    boot_timeline_mark(BOOT_MILESTONE_ADC_READY);
+
     hwrev_init_and_check();
 
     // WBMZ нужно инициализировать до wbec_init, т.к. возможно что нужно будет включаться от WBMZ
@@ -75,11 +90,14 @@ int main(void)
     // Первым инициализируется WBEC, т.к. он в начале проверяет причину включения
     // и может заснуть обратно, если решит.
     wbec_init();
+    boot_timeline_mark(BOOT_MILESTONE_WBEC_INIT);
 
     // Дальше попадаем, только если хотим включаться
     rcc_set_hsi_pll_64mhz_clock();
     systick_init();
-    adc_init(ADC_CLOCK_DIV_64, ADC_VREF_INT);
+    // 8 МГц: опрос всех каналов должен укладываться в период запуска АЦП от таймера
+    // Калибровка при этом не повторяется, используется коэффициент с первой инициализации
+    adc_init(ADC_CLOCK_DIV_8, ADC_VREF_INT);
 
     // Init drivers
     gpio_init();
@@ -98,32 +116,57 @@ int main(void)
     irq_init();
     vmon_init();
     buzzer_init();
-
-    while (1) {
+    brownout_capture_init();
+    adc_subsystem_init();
+    event_log_init();
+    linux_cpu_pwr_seq_config_init();
+    // Сохранённые настройки - после инициализации всех модулей, чтобы их не перетёрли значения по умолчанию
+    config_store_init();
+    // Журнал питания хранится в страницах настроек
+    power_journal_init();
+    boot_timeline_mark(BOOT_MILESTONE_INIT_DONE);
+    boot_timeline_init();
+
+    static const struct scheduler_task tasks[] = {
         // Drivers
-        adc_do_periodic_work();
-        system_led_do_periodic_work();
-        pwrkey_do_periodic_work();
-        wdt_do_periodic_work();
-        gpio_do_periodic_work();
-        temperature_control_do_periodic_work();
+        { adc_do_periodic_work,                     5,      SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) },
+        { system_led_do_periodic_work,              10,     0 },
+        { pwrkey_do_periodic_work,                  0,      0 },
+        { wdt_do_periodic_work,                     100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { gpio_do_periodic_work,                    0,      0 },
+        { temperature_control_do_periodic_work,     100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) },
 
         // Sybsystems
-        rtc_alarm_do_periodic_work();
-        irq_do_periodic_work();
-        vmon_do_periodic_work();
-        test_do_periodic_work();
-        buzzer_subsystem_do_periodic_work();
-        wbmz_subsystem_do_periodic_work();
+        { rtc_alarm_do_periodic_work,               10,     SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { irq_do_periodic_work,                     0,      0 },
+        { vmon_do_periodic_work,                    5,      SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) },
+        { brownout_capture_do_periodic_work,        5,      SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) },
+        { adc_subsystem_do_periodic_work,           5,      SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) | SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { test_do_periodic_work,                    100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { buzzer_subsystem_do_periodic_work,        10,     SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { wbmz_subsystem_do_periodic_work,          10,     0 },
+        { power_journal_do_periodic_work,           100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { boot_timeline_do_periodic_work,           100,    0 },
+        { perf_subsystem_do_periodic_work,          100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
+        { config_store_do_periodic_work,            100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_REGMAP) },
 
         #if defined EC_UART_REGMAP_SUPPORT
-            uart_regmap_subsystem_do_periodic_work();
+            { uart_regmap_subsystem_do_periodic_work,   0,      0 },
         #endif
 
         // Main algorithm
-        linux_cpu_pwr_seq_do_periodic_work();
-        wbec_do_periodic_work();
+        { linux_cpu_pwr_seq_do_periodic_work,       0,      0 },
+        { wbec_do_periodic_work,                    0,      0 },
+
+        // Вывод лога в консоль - в конце прохода, когда основная работа сделана
+        { event_log_do_periodic_work,               0,      0 },
+
+        { watchdog_reload,                          0,      0 },
+    };
+    static_assert(ARRAY_SIZE(tasks) <= SCHEDULER_TASKS_MAX, "Too many scheduler tasks");
 
-        watchdog_reload();
-    }
+    // Задачи вызываются по порядку таблицы, между проходами ядро спит до прерывания
+    scheduler_init(tasks, ARRAY_SIZE(tasks));
+    perf_subsystem_init();
+    scheduler_run();
 }
@@ -2,9 +2,58 @@
 #include "config.h"
 #include "wbmcu_system.h"
 #include "rtc.h"
+#include "usart_tx.h"
+#include "event-log.h"
+#include "systick.h"
+#include <assert.h>
+
+// Регистр 0 RTC домена: состояние линии 5В, только 0 или 1 (прежние прошивки сравнивают значение целиком)
+#define MCU_PWR_VCC_5V_TAMPER_REG       0
+// Регистр 4 RTC домена: статистика пробуждений из standby (регистры 1-3 свободны)
+#define MCU_PWR_STANDBY_TAMPER_REG      4
+#define MCU_STANDBY_WAKEUPS_MAX         UINT16_MAX
+#define MCU_STANDBY_AWAKE_US_MAX        UINT16_MAX
+
+union mcu_standby_backup {
+    uint32_t reg_val;
+    struct {
+        uint32_t wakeups : 16;          // количество засыпаний с последнего mcu_take_standby_stats
+        uint32_t last_awake_us : 16;    // время от старта systick в начале main до последнего засыпания
+    } fields;
+};
+
+static_assert(sizeof(union mcu_standby_backup) == sizeof(uint32_t), "MCU standby stats must fit into tamper register");
 
 static enum mcu_poweron_reason mcu_poweron_reason = MCU_POWERON_REASON_UNKNOWN;
 
+static inline union mcu_standby_backup get_standby_backup(void)
+{
+    union mcu_standby_backup b;
+    b.reg_val = rtc_get_tamper_reg(MCU_PWR_STANDBY_TAMPER_REG);
+    return b;
+}
+
+static inline void save_standby_backup(union mcu_standby_backup b)
+{
+    rtc_save_to_tamper_reg(MCU_PWR_STANDBY_TAMPER_REG, b.reg_val);
+}
+
+// Запоминает время бодрствования перед засыпанием: по нему видно, сколько стоит
+// каждое периодическое пробуждение при питании от WBMZ
+// systick запускается в начале main до быстрого пути периодического пробуждения,
+// поэтому время корректно при засыпании из любого места
+static void save_standby_stats(void)
+{
+    union mcu_standby_backup b = get_standby_backup();
+    uint32_t awake_us = systick_get_time_us();
+
+    if (b.fields.wakeups < MCU_STANDBY_WAKEUPS_MAX) {
+        b.fields.wakeups++;
+    }
+    b.fields.last_awake_us = (awake_us < MCU_STANDBY_AWAKE_US_MAX) ? awake_us : MCU_STANDBY_AWAKE_US_MAX;
+    save_standby_backup(b);
+}
+
 // Вызывать один раз в начале main
 void mcu_init_poweron_reason(void)
 {
@@ -38,6 +87,14 @@ void mcu_goto_standby(uint16_t wakeup_after_s)
     }
     rtc_set_periodic_wakeup(wakeup_after_s);
 
+    // Отладочные сообщения перед standby должны успеть уйти в UART
+    // Из быстрого пути и wbec_init сюда попадаем до event_log_init и usart_tx_init:
+    // событий в логе тогда нет, а usart_tx_flush без инициализации UART ничего не делает
+    event_log_flush();
+    usart_tx_flush();
+
+    save_standby_stats();
+
     // Подробнее про особенности перехода в standby тут:
     // https://community.st.com/t5/stm32-mcus-embedded-software/how-to-enter-standby-or-shutdown-mode-on-stm32/td-p/145849
 
@@ -63,7 +120,7 @@ void mcu_goto_standby(uint16_t wakeup_after_s)
 
 enum mcu_vcc_5v_state mcu_get_vcc_5v_last_state(void)
 {
-    if (rtc_get_tamper_reg(0) == MCU_VCC_5V_STATE_OFF) {
+    if (rtc_get_tamper_reg(MCU_PWR_VCC_5V_TAMPER_REG) == MCU_VCC_5V_STATE_OFF) {
         return MCU_VCC_5V_STATE_OFF;
     }
     return MCU_VCC_5V_STATE_ON;
@@ -71,5 +128,15 @@ enum mcu_vcc_5v_state mcu_get_vcc_5v_last_state(void)
 
 void mcu_save_vcc_5v_last_state(enum mcu_vcc_5v_state state)
 {
-    rtc_save_to_tamper_reg(0, state);
+    rtc_save_to_tamper_reg(MCU_PWR_VCC_5V_TAMPER_REG, state);
+}
+
+void mcu_take_standby_stats(struct mcu_standby_stats * stats)
+{
+    union mcu_standby_backup b = get_standby_backup();
+    stats->wakeups = b.fields.wakeups;
+    stats->last_awake_us = b.fields.last_awake_us;
+
+    b.fields.wakeups = 0;
+    save_standby_backup(b);
 }
@@ -2,6 +2,7 @@
 
 #include "ntc.h"
 #include "array_size.h"
+#include "ntc-adc-table.h"
 
 #define ADC_MAX_VAL             4095
 
@@ -50,35 +51,6 @@ static const fix16_t table_ntc[] = {
 #endif
 
 
-static fix16_t ntc_get_res_kohm(fix16_t adc_val)
-{
-    // Vntc = VREF * (Rntc / (Rntc + Rpullup))
-    // Vntc = ADC_VAL / ADC_MAX_VAL * VREF
-    // ...
-    //           ADC_VAL * Rpullup
-    // Rntc = -----------------------
-    //         ADC_MAX_VAL - ADC_VAL
-    //
-    // To prevent overflow, use division first, then multiplication
-
-    const fix16_t adc_max_val = F16(ADC_MAX_VAL);
-    const fix16_t pullup_res = F16(NTC_PULLUP_RES_KOHM);
-
-    fix16_t r_ntc_kom = 0;
-
-    if (adc_val < adc_max_val) {
-        r_ntc_kom = fix16_mul(
-            fix16_div(
-                adc_val,
-                fix16_sub(adc_max_val, adc_val)
-            ),
-            pullup_res
-        );
-    }
-
-    return r_ntc_kom;
-}
-
 fix16_t ntc_kohm_to_temp(fix16_t ntc_kohm)
 {
     const uint32_t table_size = ARRAY_SIZE(table_ntc);
@@ -126,7 +98,29 @@ fix16_t ntc_kohm_to_temp(fix16_t ntc_kohm)
 
 fix16_t ntc_convert_adc_raw_to_temp(fix16_t adc_val)
 {
-    fix16_t kohm = ntc_get_res_kohm(adc_val);
+    // Температура берётся из таблицы, индексированной кодом АЦП (include/ntc-adc-table.h),
+    // с линейной интерполяцией между соседними точками. Делений нет - на Cortex-M0+
+    // каждый fix16_div стоит дорого, а функция вызывается на каждом периоде АЦП.
+    //
+    // ADC_VAL >= ADC_MAX_VAL: Rntc = 0 (так же, как в расчёте через сопротивление)
+
+    if (adc_val >= F16(ADC_MAX_VAL)) {
+        return table_info_ntc.out_max;
+    }
+    if (adc_val <= 0) {
+        return ntc_adc_table[0] * (1 << (16 - NTC_ADC_TABLE_TEMP_SHIFT));
+    }
 
-    return ntc_kohm_to_temp(kohm);
+    // Индекс точки и дробная часть внутри шага таблицы в формате fix16
+    uint32_t i = (uint32_t)adc_val >> (16 + NTC_ADC_TABLE_STEP_SHIFT);
+    int32_t frac = ((uint32_t)adc_val >> NTC_ADC_TABLE_STEP_SHIFT) & 0xFFFF;
+
+    int32_t t0 = ntc_adc_table[i];
+    int32_t t1 = ntc_adc_table[i + 1];
+
+    // Результат в fix16: t * 2^16 / 2^TEMP_SHIFT
+    fix16_t temp = t0 * (1 << (16 - NTC_ADC_TABLE_TEMP_SHIFT)) +
+                   (((t1 - t0) * frac) >> NTC_ADC_TABLE_TEMP_SHIFT);
+
+    return temp;
 }
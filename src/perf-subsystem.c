@@ -0,0 +1,87 @@
+#include "perf-subsystem.h"
+#include "scheduler.h"
+#include "regmap-int.h"
+#include "array_size.h"
+
+/**
+ * Модуль публикует в regmap профилирование основного цикла
+ *
+ * PERF: параметры прохода по таблице задач планировщика и время выполнения
+ * задач в мкс (последнее, максимальное, среднее).
+ * Задачи нумеруются по порядку таблицы в main.c. Все задачи в регион не помещаются,
+ * поэтому в нём публикуются 3 задачи, начиная с PERF_CTRL.first_task.
+ * worst_task - номер задачи с наибольшим максимальным временем выполнения.
+ *
+ * PERF_CTRL: запись reset = 1 сбрасывает максимумы и средние, бит сбрасывается
+ * после обработки.
+ */
+
+static uint8_t first_task;
+
+static void publish_ctrl(void)
+{
+    struct REGMAP_PERF_CTRL ctrl = {
+        .reset = 0,
+        .first_task = first_task,
+    };
+    regmap_set_region_data(REGMAP_REGION_PERF_CTRL, &ctrl, sizeof(ctrl));
+}
+
+static void publish_perf(void)
+{
+    struct REGMAP_PERF p = {};
+    struct scheduler_loop_perf loop;
+    struct scheduler_task_perf task;
+    uint8_t count = scheduler_get_tasks_count();
+    uint16_t worst_max_us = 0;
+
+    scheduler_get_loop_perf(&loop);
+
+    p.tasks_count = count;
+    p.first_task = first_task;
+    p.loop_time_us = loop.loop_time_us;
+    p.loop_time_max_us = loop.loop_time_max_us;
+    p.loop_period_us = loop.loop_period_us;
+    p.loops_per_sec = loop.loops_per_sec;
+    p.load_permille = loop.load_permille;
+
+    for (uint8_t i = 0; i < count; i++) {
+        scheduler_get_task_perf(i, &task);
+        if (task.max_us > worst_max_us) {
+            worst_max_us = task.max_us;
+            p.worst_task = i;
+        }
+    }
+
+    for (unsigned i = 0; i < ARRAY_SIZE(p.task); i++) {
+        // Для номеров за пределами таблицы scheduler_get_task_perf вернёт нули
+        scheduler_get_task_perf(first_task + i, &task);
+        p.task[i].last_us = task.last_us;
+        p.task[i].max_us = task.max_us;
+        p.task[i].avg_us = task.avg_us;
+    }
+
+    // Если regmap занят, данные опубликуются на следующем запуске задачи
+    regmap_set_region_data(REGMAP_REGION_PERF, &p, sizeof(p));
+}
+
+void perf_subsystem_init(void)
+{
+    first_task = 0;
+    publish_ctrl();
+    publish_perf();
+}
+
+void perf_subsystem_do_periodic_work(void)
+{
+    struct REGMAP_PERF_CTRL ctrl;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_PERF_CTRL, &ctrl, sizeof(ctrl))) {
+        if (ctrl.reset) {
+            scheduler_reset_perf();
+        }
+        first_task = (ctrl.first_task < scheduler_get_tasks_count()) ? ctrl.first_task : 0;
+        publish_ctrl();
+    }
+
+    publish_perf();
+}
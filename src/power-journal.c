@@ -0,0 +1,171 @@
+#include "power-journal.h"
+#include "regmap-int.h"
+#include "config-store.h"
+#include "rtc.h"
+#include "wbmz-common.h"
+#include "array_size.h"
+#include <string.h>
+#include <assert.h>
+
+/**
+ * Журнал событий питания
+ *
+ * Хранит последние POWER_JOURNAL_SIZE событий питания с временем RTC (с точностью до минуты).
+ * Журнал хранится во flash отдельной записью в страницах настроек (config-store.c),
+ * поэтому переживает полное пропадание питания EC. Копия журнала в RAM обновляется
+ * при добавлении события, и журнал целиком сразу пишется во flash: события редкие,
+ * а после некоторых из них (STANDBY) EC сразу засыпает. Запись останавливает ядро
+ * примерно на 1.5 мс, раз в ~15 записей добавляется стирание страницы на 22-40 мс (см. flash.c),
+ * так что износ страницы - одно стирание на ~15 событий.
+ * Если запись во flash не удалась, она повторяется в power_journal_do_periodic_work
+ * не более POWER_JOURNAL_SAVE_RETRIES раз, чтобы неисправная flash не стиралась непрерывно.
+ *
+ * При добавлении события записи сдвигаются, событие 0 всегда самое новое.
+ *
+ * Весь журнал в regmap не помещается, поэтому публикуется окном:
+ * PWR_JOURNAL_CTRL: first_entry - номер первого события в окне PWR_JOURNAL.
+ * PWR_JOURNAL: count - число событий в журнале, first_entry - номер первого события окна
+ * (копия PWR_JOURNAL_CTRL.first_entry после обработки), entry[] - события окна.
+ */
+
+struct power_journal_entry {
+    uint8_t event;
+    uint8_t arg;
+    uint8_t minutes;
+    uint8_t hours;
+    uint8_t days;
+    uint8_t months;
+    uint8_t years;      // от 2000 года
+    uint8_t reserved;
+};
+
+#define POWER_JOURNAL_SIZE                  (CONFIG_STORE_JOURNAL_SIZE / sizeof(struct power_journal_entry))
+
+#define POWER_JOURNAL_SAVE_RETRIES          3
+#define REGMAP_JOURNAL_WINDOW_SIZE          ARRAY_SIZE(((struct REGMAP_PWR_JOURNAL *)0)->entry)
+
+static_assert(POWER_JOURNAL_SIZE * sizeof(struct power_journal_entry) == CONFIG_STORE_JOURNAL_SIZE, "Power journal must fill config store journal data");
+
+static struct {
+    struct power_journal_entry entry[POWER_JOURNAL_SIZE];
+    uint8_t count;
+    uint8_t first_entry;
+    bool powered_from_wbmz;
+    uint8_t save_retries;               // оставшиеся попытки записи во flash
+    bool publish_pending;
+} journal_ctx;
+
+static void publish_ctrl(void)
+{
+    struct REGMAP_PWR_JOURNAL_CTRL ctrl = {
+        .first_entry = journal_ctx.first_entry,
+    };
+    regmap_set_region_data(REGMAP_REGION_PWR_JOURNAL_CTRL, &ctrl, sizeof(ctrl));
+}
+
+static void publish_journal(void)
+{
+    struct REGMAP_PWR_JOURNAL j = {};
+
+    j.count = journal_ctx.count;
+    j.first_entry = journal_ctx.first_entry;
+
+    for (unsigned i = 0; i < REGMAP_JOURNAL_WINDOW_SIZE; i++) {
+        unsigned n = journal_ctx.first_entry + i;
+        if (n >= journal_ctx.count) {
+            break;
+        }
+        const struct power_journal_entry *e = &journal_ctx.entry[n];
+        j.entry[i].event = e->event;
+        j.entry[i].arg = e->arg;
+        j.entry[i].minutes = e->minutes;
+        j.entry[i].hours = e->hours;
+        j.entry[i].days = e->days;
+        j.entry[i].months = e->months;
+        j.entry[i].years = e->years;
+    }
+
+    if (regmap_set_region_data(REGMAP_REGION_PWR_JOURNAL, &j, sizeof(j))) {
+        journal_ctx.publish_pending = false;
+    }
+}
+
+static void count_entries(void)
+{
+    journal_ctx.count = 0;
+    while ((journal_ctx.count < POWER_JOURNAL_SIZE) &&
+           (journal_ctx.entry[journal_ctx.count].event != POWER_JOURNAL_EMPTY))
+    {
+        journal_ctx.count++;
+    }
+}
+
+void power_journal_init(void)
+{
+    const void *stored = config_store_get_journal();
+    if (stored) {
+        memcpy(journal_ctx.entry, stored, sizeof(journal_ctx.entry));
+    } else {
+        memset(journal_ctx.entry, 0, sizeof(journal_ctx.entry));
+    }
+    count_entries();
+
+    journal_ctx.first_entry = 0;
+    journal_ctx.save_retries = 0;
+    journal_ctx.powered_from_wbmz = wbmz_is_powered_from_wbmz();
+
+    publish_ctrl();
+    publish_journal();
+}
+
+void power_journal_add(enum power_journal_event e, uint8_t arg)
+{
+    struct rtc_time t;
+    rtc_get_datetime(&t);
+
+    memmove(&journal_ctx.entry[1], &journal_ctx.entry[0], sizeof(journal_ctx.entry[0]) * (POWER_JOURNAL_SIZE - 1));
+
+    struct power_journal_entry *r = &journal_ctx.entry[0];
+    r->event = e;
+    r->arg = arg;
+    r->minutes = BCD_TO_BIN(t.minutes);
+    r->hours = BCD_TO_BIN(t.hours);
+    r->days = BCD_TO_BIN(t.days);
+    r->months = BCD_TO_BIN(t.months);
+    r->years = BCD_TO_BIN(t.years);
+    r->reserved = 0;
+
+    if (journal_ctx.count < POWER_JOURNAL_SIZE) {
+        journal_ctx.count++;
+    }
+
+    journal_ctx.save_retries = config_store_save_journal(journal_ctx.entry) ? 0 : POWER_JOURNAL_SAVE_RETRIES;
+    journal_ctx.publish_pending = true;
+}
+
+void power_journal_do_periodic_work(void)
+{
+    bool powered_from_wbmz = wbmz_is_powered_from_wbmz();
+    if (powered_from_wbmz != journal_ctx.powered_from_wbmz) {
+        journal_ctx.powered_from_wbmz = powered_from_wbmz;
+        power_journal_add(powered_from_wbmz ? POWER_JOURNAL_WBMZ_ON : POWER_JOURNAL_WBMZ_OFF, 0);
+    }
+
+    if (journal_ctx.save_retries > 0) {
+        journal_ctx.save_retries--;
+        if (config_store_save_journal(journal_ctx.entry)) {
+            journal_ctx.save_retries = 0;
+        }
+    }
+
+    struct REGMAP_PWR_JOURNAL_CTRL ctrl;
+    if (regmap_get_data_if_region_changed(REGMAP_REGION_PWR_JOURNAL_CTRL, &ctrl, sizeof(ctrl))) {
+        journal_ctx.first_entry = (ctrl.first_entry < POWER_JOURNAL_SIZE) ? ctrl.first_entry : 0;
+        publish_ctrl();
+        journal_ctx.publish_pending = true;
+    }
+
+    if (journal_ctx.publish_pending) {
+        publish_journal();
+    }
+}
@@ -206,6 +206,57 @@ bool regmap_get_data_if_region_changed(enum regmap_region r, void * data, size_t
     return ret;
 }
 
+// Атомарно переписывает текущие данные региона во внешнюю структуру
+// В отличие от regmap_get_data_if_region_changed не трогает флаги изменения региона
+bool regmap_get_region_data(enum regmap_region r, void * data, size_t size)
+{
+    if (r >= REGMAP_REGION_COUNT) {
+        return 0;
+    }
+    if (size != region_size(r)) {
+        return 0;
+    }
+
+    uint16_t r_start = region_first_reg(r);
+
+    bool ret = 0;
+    ATOMIC {
+        if (!is_busy) {
+            memcpy(data, &regs[r_start], size);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+// Записывает данные в RW регион и выставляет флаги изменения, как при записи снаружи
+// Модуль, который обслуживает регион, получит их через regmap_get_data_if_region_changed
+// Используется для восстановления сохранённых настроек
+bool regmap_set_region_data_as_changed(enum regmap_region r, const void * data, size_t size)
+{
+    if (r >= REGMAP_REGION_COUNT) {
+        return 0;
+    }
+    if ((size != region_size(r)) || (!is_region_rw(r))) {
+        return 0;
+    }
+
+    uint16_t r_start = region_first_reg(r);
+    uint16_t r_end = region_last_reg(r);
+
+    bool ret = 0;
+    ATOMIC {
+        if (!is_busy) {
+            memcpy(&regs[r_start], data, size);
+            for (uint16_t i = r_start; i <= r_end; i++) {
+                set_bit_flag(i, written_flags);
+            }
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
 // Подготовка внешней операции с regmap
 // Устанавливает начальный адрес и флаг занятости
 // Выполняется в контексте прерывания
@@ -0,0 +1,218 @@
+#include "scheduler.h"
+#include "systick.h"
+#include "wbmcu_system.h"
+#include "atomic.h"
+#include <assert.h>
+
+/**
+ * Кооперативный планировщик задач основного цикла
+ *
+ * Задачи описываются таблицей (функция, период, маска событий) и вызываются
+ * по порядку таблицы. Задача запускается, если:
+ *  - истёк её период
+ *  - пришло одно из её событий (scheduler_set_event, в т.ч. из прерываний)
+ *  - период равен 0 - на каждом проходе
+ *
+ * События, пришедшие до начала прохода, обрабатываются за этот проход всеми
+ * подписанными задачами, поэтому задачи, зависящие от данных другой задачи,
+ * нужно располагать в таблице после неё.
+ *
+ * После прохода ядро засыпает (WFI) до ближайшего прерывания. SysTick будит его
+ * каждую 1 мс, так что задачи с периодом 0 выполняются не реже раза в 1 мс,
+ * а задачи с событиями - сразу после прерывания, которое выставило событие.
+ * В Sleep mode периферия и DMA продолжают работать.
+ *
+ * Профилирование: время выполнения каждой задачи (последнее, максимальное, среднее)
+ * и параметры прохода по таблице измеряются по systick_get_time_us.
+ * Среднее - экспоненциальное с весом нового значения 1/2^SCHEDULER_PERF_AVG_SHIFT,
+ * чтобы обойтись без деления.
+ */
+
+#define SCHEDULER_PERF_AVG_SHIFT        4
+#define SCHEDULER_PERF_WINDOW_US        1000000
+
+static_assert(SCHEDULER_EVENT_COUNT <= 8, "Scheduler events must fit into uint8_t mask");
+
+struct scheduler_ctx {
+    const struct scheduler_task *tasks;
+    uint8_t count;
+    bool started;
+    volatile uint8_t pending_events;
+    systime_t last_run[SCHEDULER_TASKS_MAX];
+    struct {
+        uint16_t last_us;
+        uint16_t max_us;
+        // среднее, умноженное на 2^SCHEDULER_PERF_AVG_SHIFT
+        uint32_t avg_scaled;
+    } task_perf[SCHEDULER_TASKS_MAX];
+    struct {
+        uint32_t pass_start_us;
+        uint32_t window_start_us;
+        uint32_t window_busy_us;
+        uint16_t window_passes;
+        struct scheduler_loop_perf published;
+    } loop_perf;
+};
+
+static struct scheduler_ctx sched_ctx;
+
+static inline uint16_t saturate_u16(uint32_t v)
+{
+    return (v > UINT16_MAX) ? UINT16_MAX : v;
+}
+
+static void update_task_perf(uint8_t i, uint32_t time_us)
+{
+    uint16_t t = saturate_u16(time_us);
+
+    sched_ctx.task_perf[i].last_us = t;
+    if (t > sched_ctx.task_perf[i].max_us) {
+        sched_ctx.task_perf[i].max_us = t;
+    }
+    if (sched_ctx.task_perf[i].avg_scaled == 0) {
+        sched_ctx.task_perf[i].avg_scaled = (uint32_t)t << SCHEDULER_PERF_AVG_SHIFT;
+    } else {
+        sched_ctx.task_perf[i].avg_scaled -= sched_ctx.task_perf[i].avg_scaled >> SCHEDULER_PERF_AVG_SHIFT;
+        sched_ctx.task_perf[i].avg_scaled += t;
+    }
+}
+
+static void update_loop_perf(uint32_t start_us, uint32_t end_us)
+{
+    struct scheduler_loop_perf *p = &sched_ctx.loop_perf.published;
+    uint32_t busy_us = end_us - start_us;
+
+    p->loop_period_us = saturate_u16(start_us - sched_ctx.loop_perf.pass_start_us);
+    sched_ctx.loop_perf.pass_start_us = start_us;
+
+    p->loop_time_us = saturate_u16(busy_us);
+    if (p->loop_time_us > p->loop_time_max_us) {
+        p->loop_time_max_us = p->loop_time_us;
+    }
+
+    sched_ctx.loop_perf.window_passes++;
+    sched_ctx.loop_perf.window_busy_us += busy_us;
+
+    if ((uint32_t)(end_us - sched_ctx.loop_perf.window_start_us) >= SCHEDULER_PERF_WINDOW_US) {
+        // Раз в секунду, деление здесь не критично
+        p->loops_per_sec = sched_ctx.loop_perf.window_passes;
+        p->load_permille = saturate_u16(sched_ctx.loop_perf.window_busy_us / (SCHEDULER_PERF_WINDOW_US / 1000));
+        if (p->load_permille > 1000) {
+            p->load_permille = 1000;
+        }
+        sched_ctx.loop_perf.window_start_us = end_us;
+        sched_ctx.loop_perf.window_passes = 0;
+        sched_ctx.loop_perf.window_busy_us = 0;
+    }
+}
+
+void scheduler_init(const struct scheduler_task tasks[], uint8_t count)
+{
+    if (count > SCHEDULER_TASKS_MAX) {
+        count = SCHEDULER_TASKS_MAX;
+    }
+    sched_ctx.tasks = tasks;
+    sched_ctx.count = count;
+    sched_ctx.started = false;
+    sched_ctx.pending_events = 0;
+
+    scheduler_reset_perf();
+    sched_ctx.loop_perf.published.loops_per_sec = 0;
+    sched_ctx.loop_perf.published.load_permille = 0;
+    sched_ctx.loop_perf.pass_start_us = systick_get_time_us();
+    sched_ctx.loop_perf.window_start_us = sched_ctx.loop_perf.pass_start_us;
+    sched_ctx.loop_perf.window_passes = 0;
+    sched_ctx.loop_perf.window_busy_us = 0;
+}
+
+void scheduler_set_event(enum scheduler_event e)
+{
+    ATOMIC {
+        sched_ctx.pending_events |= SCHEDULER_EVENT_MASK(e);
+    }
+}
+
+void scheduler_run_pass(void)
+{
+    uint8_t events;
+    ATOMIC {
+        events = sched_ctx.pending_events;
+        sched_ctx.pending_events = 0;
+    }
+
+    systime_t now = systick_get_system_time_ms();
+    uint32_t pass_start_us = systick_get_time_us();
+
+    for (uint8_t i = 0; i < sched_ctx.count; i++) {
+        const struct scheduler_task *t = &sched_ctx.tasks[i];
+
+        // На первом проходе запускаются все задачи
+        bool due = (!sched_ctx.started) ||
+                   (t->period_ms == 0) ||
+                   (events & t->events) ||
+                   ((systime_t)(now - sched_ctx.last_run[i]) >= t->period_ms);
+
+        if (due) {
+            sched_ctx.last_run[i] = now;
+
+            uint32_t task_start_us = systick_get_time_us();
+            t->work();
+            update_task_perf(i, systick_get_time_us() - task_start_us);
+        }
+    }
+    sched_ctx.started = true;
+
+    update_loop_perf(pass_start_us, systick_get_time_us());
+}
+
+void scheduler_sleep(void)
+{
+    // WFI выполняется с запрещёнными прерываниями: прерывание, пришедшее после проверки,
+    // всё равно разбудит ядро, а его обработчик выполнится при выходе из ATOMIC
+    ATOMIC {
+        if (sched_ctx.pending_events == 0) {
+            __WFI();
+        }
+    }
+}
+
+void scheduler_run(void)
+{
+    while (1) {
+        scheduler_run_pass();
+        scheduler_sleep();
+    }
+}
+
+uint8_t scheduler_get_tasks_count(void)
+{
+    return sched_ctx.count;
+}
+
+void scheduler_get_task_perf(uint8_t task, struct scheduler_task_perf *perf)
+{
+    if (task >= sched_ctx.count) {
+        perf->last_us = 0;
+        perf->max_us = 0;
+        perf->avg_us = 0;
+        return;
+    }
+    perf->last_us = sched_ctx.task_perf[task].last_us;
+    perf->max_us = sched_ctx.task_perf[task].max_us;
+    perf->avg_us = sched_ctx.task_perf[task].avg_scaled >> SCHEDULER_PERF_AVG_SHIFT;
+}
+
+void scheduler_get_loop_perf(struct scheduler_loop_perf *perf)
+{
+    *perf = sched_ctx.loop_perf.published;
+}
+
+void scheduler_reset_perf(void)
+{
+    for (uint8_t i = 0; i < SCHEDULER_TASKS_MAX; i++) {
+        sched_ctx.task_perf[i].last_us = 0;
+        sched_ctx.task_perf[i].max_us = 0;
+        sched_ctx.task_perf[i].avg_scaled = 0;
+    }
+    sched_ctx.loop_perf.published.loop_time_max_us = 0;
+}
@@ -120,6 +120,19 @@ void shared_gpio_set_value(enum mod mod, enum mod_gpio mod_gpio, bool value)
     }
 }
 
+// Тип выхода пина, действует в том числе в режиме AF
+// open-drain нужен для USART в режиме half-duplex (1-Wire), где линию тянут вниз и ведомые устройства
+void shared_gpio_set_open_drain(enum mod mod, enum mod_gpio mod_gpio, bool open_drain)
+{
+    gpio_pin_t g = mod_gpios[mod][mod_gpio];
+
+    if (open_drain) {
+        GPIO_S_SET_OD(g);
+    } else {
+        GPIO_S_SET_PUSHPULL(g);
+    }
+}
+
 void shared_gpio_init(void)
 {
     for (size_t i = 0; i < MOD_COUNT; i++) {
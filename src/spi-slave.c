@@ -3,6 +3,7 @@
 #include "gpio.h"
 #include "regmap-ext.h"
 #include "config.h"
+#include "scheduler.h"
 
 /**
  * Реализация SPI Slave с размером слова 16 бит
@@ -207,5 +208,7 @@ static void exti_irq_handler(void)
         // Также в regmap снимается флаг занятости
         regmap_ext_end_operation();
         reset_and_init_spi();
+        // Задачи, которые обрабатывают регионы regmap, запускаются без ожидания своего периода
+        scheduler_set_event(SCHEDULER_EVENT_REGMAP);
     }
 }
@@ -9,9 +9,15 @@
  *
  * Функция systick_get_time_since_timestamp позволяет получить время,
  * прошедшее с момента сохраненной метки времени
+ *
+ * Для измерения коротких интервалов (профилирование) есть systick_get_time_us:
+ * к счётчику мс добавляется текущее значение SysTick->VAL
+ * На Cortex-M0+ нет DWT, поэтому счётчик тактов недоступен
  */
 
-static systime_t system_time_ms = 0;
+static volatile systime_t system_time_ms = 0;
+// Коэффициент перевода тиков SysTick в мкс в формате Q16
+static uint32_t us_per_tick_q16 = 0;
 
 static void systick_irq_handler(void)
 {
@@ -24,6 +30,7 @@ void systick_init(void)
 
     SysTick->VAL = 0;
     SysTick->LOAD = SystemCoreClock / 8 / 1000 - 1;
+    us_per_tick_q16 = (1000UL << 16) / (SysTick->LOAD + 1);
     SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
     NVIC_SetHandler(SysTick_IRQn, systick_irq_handler);
     NVIC_EnableIRQ(SysTick_IRQn);
@@ -38,3 +45,19 @@ systime_t systick_get_time_since_timestamp(systime_t timestamp)
 {
     return (int32_t)(system_time_ms - timestamp);
 }
+
+// Время в мкс, переполняется раз в ~71 минуту
+// Вызывается из основного цикла: если SysTick уже перезагрузился, а его прерывание
+// ещё не обработано (внутри ATOMIC или прерывания), значение отстанет на 1 мс
+uint32_t systick_get_time_us(void)
+{
+    systime_t ms;
+    uint32_t val;
+
+    do {
+        ms = system_time_ms;
+        val = SysTick->VAL;
+    } while (ms != system_time_ms);
+
+    return ms * 1000 + (((SysTick->LOAD - val) * us_per_tick_q16) >> 16);
+}
@@ -8,12 +8,28 @@
 
 static const fix16_t minimum_working_temperature = F16(WBEC_MINIMUM_WORKING_TEMPERATURE);
 
-static inline fix16_t get_temperature(void)
+// Температура кешируется: отфильтрованное значение АЦП меняется только раз в период АЦП,
+// а температура нужна нескольким потребителям за один проход основного цикла
+// (нагреватель, проверка готовности, данные для regmap)
+struct temperature_cache {
+    bool valid;
+    fix16_t ntc_raw;
+    fix16_t temperature;
+};
+
+static struct temperature_cache temp_cache;
+
+static fix16_t get_temperature(void)
 {
     fix16_t ntc_raw = adc_get_ch_adc_raw(ADC_CHANNEL_ADC_NTC);
-    fix16_t temperature = ntc_convert_adc_raw_to_temp(ntc_raw);
 
-    return temperature;
+    if ((!temp_cache.valid) || (ntc_raw != temp_cache.ntc_raw)) {
+        temp_cache.ntc_raw = ntc_raw;
+        temp_cache.temperature = ntc_convert_adc_raw_to_temp(ntc_raw);
+        temp_cache.valid = true;
+    }
+
+    return temp_cache.temperature;
 }
 
 #if defined EC_GPIO_HEATER
@@ -73,6 +89,8 @@ static inline fix16_t get_temperature(void)
 
 void temperature_control_init(void)
 {
+    temp_cache.valid = false;
+
     #if defined EC_GPIO_HEATER
         heater_disable();
         GPIO_S_SET_PUSHPULL(heater_gpio);
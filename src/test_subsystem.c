@@ -1,6 +1,6 @@
 #include "regmap-structs.h"
 #include "regmap-int.h"
-#include "console.h"
+#include "event-log.h"
 #include "rtc.h"
 #include "temperature-control.h"
 #include "wbmz-common.h"
@@ -22,8 +22,7 @@ void test_do_periodic_work(void)
     struct REGMAP_TEST test = {};
     if (regmap_get_data_if_region_changed(REGMAP_REGION_TEST, &test, sizeof(test))) {
         if (test.send_test_message) {
-            console_print("\r\n");
-            console_print_w_prefix("Test message\r\n\n");
+            event_log(EVENT_LOG_TEST_MESSAGE);
             test.send_test_message = 0;
         }
 
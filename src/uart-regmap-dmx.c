@@ -0,0 +1,145 @@
+#include "config.h"
+
+#if defined EC_UART_REGMAP_SUPPORT
+
+#include "uart-regmap.h"
+#include "wbmcu_system.h"
+#include "rcc.h"
+#include "atomic.h"
+#include <assert.h>
+#include <string.h>
+
+/**
+ * Передатчик DMX512 на портах MOD
+ *
+ * Включается через UART_CTRL: mode = UART_MODE_DMX.
+ * ЕС непрерывно передаёт universe с заданной частотой обновления, линукс только обновляет
+ * значения каналов через регион UART_DMX (окно до 64 каналов за одну запись).
+ * Обмен через UART_EXCHANGE в этом режиме не используется.
+ *
+ * Кадр DMX512:
+ *  - BREAK: не менее 88 мкс низкого уровня
+ *  - MAB (mark after break): не менее 8 мкс высокого уровня
+ *  - стартовый код (0) и значения каналов, 250 кбит/с, 8N2
+ *
+ * BREAK формируется передачей байта 0x00 на пониженной скорости: 9 бит низкого уровня
+ * (старт + 8 бит данных) на 57600 бод дают ~156 мкс, а стоп-биты - MAB ~35 мкс.
+ * Скорость USART можно менять только при выключенном UE, поэтому USART перенастраивается
+ * в прерывании по окончании передачи BREAK.
+ */
+
+#define DMX_BAUDRATE                250000
+#define DMX_BREAK_BAUDRATE          57600
+#define DMX_START_CODE              0x00
+
+static_assert(UART_DMX_UNIVERSE_SIZE <= UART_REGMAP_CIRC_BUFFER_SIZE, "DMX universe must fit into UART TX buffer");
+
+static inline uint8_t * dmx_universe(const struct uart_descr *u)
+{
+    return u->ctx->circ_buf_tx.data;
+}
+
+static inline void dmx_set_baudrate(const struct uart_descr *u, uint32_t baudrate)
+{
+    u->uart->CR1 &= ~USART_CR1_UE;
+    u->uart->BRR = SystemCoreClock / baudrate;
+    u->uart->CR1 |= USART_CR1_UE;
+}
+
+// Вызывается из uart_apply_ctrl при включении порта в режиме DMX
+void uart_dmx_start(const struct uart_descr *u)
+{
+    struct uart_ctx *ctx = u->ctx;
+
+    ctx->dmx.state = UART_DMX_STATE_IDLE;
+    ctx->dmx.slot = 0;
+    // первый кадр передаём сразу
+    ctx->dmx.frame_timestamp = systick_get_system_time_ms() - 1000;
+}
+
+void uart_dmx_process_irq(const struct uart_descr *u)
+{
+    struct uart_ctx *ctx = u->ctx;
+
+    if (u->uart->ISR & USART_ISR_TC) {
+        u->uart->ICR = USART_ICR_TCCF;
+
+        if (ctx->dmx.state == UART_DMX_STATE_BREAK) {
+            // BREAK и MAB переданы - переходим на рабочую скорость и передаём каналы
+            dmx_set_baudrate(u, DMX_BAUDRATE);
+            ctx->dmx.slot = 0;
+            ctx->dmx.state = UART_DMX_STATE_DATA;
+            u->uart->CR1 |= USART_CR1_TXEIE_TXFNFIE;
+        } else if (ctx->dmx.state == UART_DMX_STATE_LAST_SLOT) {
+            ctx->dmx.state = UART_DMX_STATE_IDLE;
+        }
+    }
+
+    if ((u->uart->CR1 & USART_CR1_TXEIE_TXFNFIE) && (u->uart->ISR & USART_ISR_TXE_TXFNF)) {
+        if (ctx->dmx.slot == 0) {
+            u->uart->TDR = DMX_START_CODE;
+        } else {
+            u->uart->TDR = dmx_universe(u)[ctx->dmx.slot - 1];
+        }
+        ctx->dmx.slot++;
+
+        if (ctx->dmx.slot > ctx->ctrl.dmx_channels_count) {
+            u->uart->CR1 &= ~USART_CR1_TXEIE_TXFNFIE;
+            ctx->dmx.state = UART_DMX_STATE_LAST_SLOT;
+        }
+    }
+}
+
+void uart_dmx_process_window(const struct uart_descr *u, const struct uart_dmx_window *w)
+{
+    if (w->first_channel >= UART_DMX_UNIVERSE_SIZE) {
+        return;
+    }
+
+    uint16_t count = w->channels_count;
+    if (count > UART_DMX_WINDOW_SIZE) {
+        count = UART_DMX_WINDOW_SIZE;
+    }
+    uint16_t channels_left = UART_DMX_UNIVERSE_SIZE - w->first_channel;
+    if (count > channels_left) {
+        count = channels_left;
+    }
+
+    // Кадр передаётся в прерывании, но побайтное обновление на лету допустимо:
+    // каждый канал - независимое значение
+    memcpy(&dmx_universe(u)[w->first_channel], w->data, count);
+}
+
+// Очищает universe, вызывается при переключении порта в режим DMX
+void uart_dmx_clear_universe(const struct uart_descr *u)
+{
+    memset(dmx_universe(u), 0, UART_DMX_UNIVERSE_SIZE);
+}
+
+void uart_dmx_do_periodic_work(const struct uart_descr *u)
+{
+    struct uart_ctx *ctx = u->ctx;
+
+    if ((ctx->ctrl.enable == 0) || (ctx->ctrl.mode != UART_MODE_DMX)) {
+        return;
+    }
+
+    if (ctx->dmx.state != UART_DMX_STATE_IDLE) {
+        return;
+    }
+
+    if (systick_get_time_since_timestamp(ctx->dmx.frame_timestamp) < 1000 / ctx->ctrl.dmx_refresh_hz) {
+        return;
+    }
+    ctx->dmx.frame_timestamp = systick_get_system_time_ms();
+
+    // Передача BREAK: 0x00 на пониженной скорости, дальше кадр передаётся в прерывании
+    ATOMIC {
+        dmx_set_baudrate(u, DMX_BREAK_BAUDRATE);
+        u->uart->ICR = USART_ICR_TCCF;
+        ctx->dmx.state = UART_DMX_STATE_BREAK;
+        u->uart->TDR = 0x00;
+    }
+}
+
+#endif
@@ -0,0 +1,555 @@
+#include "config.h"
+
+#if defined EC_UART_REGMAP_SUPPORT
+
+#include "uart-regmap.h"
+#include "wbmcu_system.h"
+#include "rcc.h"
+#include "array_size.h"
+#include <assert.h>
+#include <string.h>
+
+/**
+ * Мастер шины 1-Wire на портах MOD
+ *
+ * Включается через UART_CTRL: mode = UART_MODE_ONEWIRE.
+ * USART работает в режиме half-duplex (HDSEL): TX и RX соединены внутри, линия TX - open-drain
+ * с внешней подтяжкой. Каждый тайм-слот 1-Wire - это один символ USART:
+ *  - RESET: 0xF0 на 9600 бод, если принято не 0xF0 - устройства ответили presence pulse
+ *  - запись 1 / чтение: 0xFF на 115200 бод, если принято 0xFF - прочитана 1
+ *  - запись 0: 0x00 на 115200 бод
+ *
+ * Символы передаются в прерывании, на место каждого переданного символа пишется принятый.
+ * Последовательность обменов для команд выполняется в uart_onewire_do_periodic_work.
+ *
+ * Команды (регион UART_ONEWIRE):
+ *  - SEARCH - поиск ROM всех устройств на шине, результаты кешируются
+ *  - CONVERT_ALL - запуск измерения на всех датчиках и чтение температуры найденных датчиков
+ *    (поддерживаются датчики с внешним питанием, паразитное питание не поддерживается).
+ *    Читаются только устройства семейств DS18x20 (DS18S20, DS1822, DS18B20, DS1825, DS28EA00),
+ *    остальные найденные устройства пропускаются и остаются с temperature_valid = 0
+ *  - READ_SCRATCHPAD - чтение scratchpad устройства device_index
+ * Измерение температуры можно запускать автоматически с периодом auto_convert_period_s,
+ * тогда чтение температуры из линукса не требует обращения к шине.
+ */
+
+#define ONEWIRE_RESET_BAUDRATE          9600
+#define ONEWIRE_DATA_BAUDRATE           115200
+
+#define ONEWIRE_SLOT_RESET              0xF0
+#define ONEWIRE_SLOT_1                  0xFF
+#define ONEWIRE_SLOT_0                  0x00
+
+#define ONEWIRE_CMD_SEARCH_ROM          0xF0
+#define ONEWIRE_CMD_MATCH_ROM           0x55
+#define ONEWIRE_CMD_SKIP_ROM            0xCC
+#define ONEWIRE_CMD_CONVERT_T           0x44
+#define ONEWIRE_CMD_READ_SCRATCHPAD     0xBE
+
+#define ONEWIRE_FAMILY_DS18S20          0x10
+#define ONEWIRE_FAMILY_DS1822           0x22
+#define ONEWIRE_FAMILY_DS18B20          0x28
+#define ONEWIRE_FAMILY_DS1825           0x3B
+#define ONEWIRE_FAMILY_DS28EA00         0x42
+
+#define ONEWIRE_CONVERT_TIME_MS         750
+#define ONEWIRE_JOB_TIMEOUT_MS          50
+
+#define ONEWIRE_SCRATCHPAD_SIZE         9
+
+enum onewire_step {
+    OW_STEP_IDLE = 0,
+    OW_STEP_SEARCH_RESET,
+    OW_STEP_SEARCH_CMD,
+    OW_STEP_SEARCH_READ_BITS,
+    OW_STEP_SEARCH_WRITE_BIT,
+    OW_STEP_CONVERT_RESET,
+    OW_STEP_CONVERT_CMD,
+    OW_STEP_CONVERT_WAIT,
+    OW_STEP_READ_RESET,
+    OW_STEP_READ_SCRATCHPAD,
+};
+
+struct onewire_device {
+    uint8_t rom[8];
+    int16_t temperature;
+    uint8_t temperature_valid;
+    uint8_t reserved;
+};
+
+#define ONEWIRE_MAX_DEVICES             32
+
+static_assert(sizeof(struct onewire_device) * ONEWIRE_MAX_DEVICES <= sizeof(((struct circ_buf_rx *)0)->data), "1-Wire devices cache must fit into UART RX buffer");
+
+static inline uint8_t * job_buf(const struct uart_descr *u)
+{
+    return u->ctx->circ_buf_tx.data;
+}
+
+static inline struct onewire_device * devices(const struct uart_descr *u)
+{
+    return (struct onewire_device *)u->ctx->circ_buf_rx.data;
+}
+
+static uint8_t crc8(const uint8_t *data, unsigned len)
+{
+    uint8_t crc = 0;
+    for (unsigned i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        for (unsigned j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static void set_baudrate(const struct uart_descr *u, uint32_t baudrate)
+{
+    u->uart->CR1 &= ~USART_CR1_UE;
+    u->uart->BRR = SystemCoreClock / baudrate;
+    u->uart->CR1 |= USART_CR1_UE;
+}
+
+static void start_job(const struct uart_descr *u, uint16_t len, uint32_t baudrate)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    set_baudrate(u, baudrate);
+    u->uart->ICR = USART_ICR_PECF | USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF;
+
+    ow->job_len = len;
+    ow->job_pos = 0;
+    ow->job_timestamp = systick_get_system_time_ms();
+    u->uart->TDR = job_buf(u)[0];
+}
+
+static inline bool job_done(const struct uart_descr *u)
+{
+    return u->ctx->onewire.job_pos >= u->ctx->onewire.job_len;
+}
+
+static void start_reset(const struct uart_descr *u)
+{
+    job_buf(u)[0] = ONEWIRE_SLOT_RESET;
+    start_job(u, 1, ONEWIRE_RESET_BAUDRATE);
+}
+
+static inline bool reset_presence(const struct uart_descr *u)
+{
+    return job_buf(u)[0] != ONEWIRE_SLOT_RESET;
+}
+
+// Раскладывает байты в тайм-слоты, для чтения байта нужно передавать 0xFF
+static void start_bytes(const struct uart_descr *u, const uint8_t *data, unsigned len)
+{
+    uint8_t *buf = job_buf(u);
+    for (unsigned i = 0; i < len; i++) {
+        for (unsigned bit = 0; bit < 8; bit++) {
+            *buf++ = (data[i] & (1 << bit)) ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0;
+        }
+    }
+    start_job(u, len * 8, ONEWIRE_DATA_BAUDRATE);
+}
+
+static uint8_t get_byte(const struct uart_descr *u, unsigned index)
+{
+    const uint8_t *buf = &job_buf(u)[index * 8];
+    uint8_t byte = 0;
+    for (unsigned bit = 0; bit < 8; bit++) {
+        if (buf[bit] == ONEWIRE_SLOT_1) {
+            byte |= (1 << bit);
+        }
+    }
+    return byte;
+}
+
+static void start_bits(const struct uart_descr *u, uint8_t slot, unsigned count)
+{
+    memset(job_buf(u), slot, count);
+    start_job(u, count, ONEWIRE_DATA_BAUDRATE);
+}
+
+static void update_pub_device(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    if (ow->pub.device_index < ow->pub.devices_count) {
+        const struct onewire_device *d = &devices(u)[ow->pub.device_index];
+        memcpy(ow->pub.rom, d->rom, sizeof(ow->pub.rom));
+        ow->pub.temperature = d->temperature;
+        ow->pub.temperature_valid = d->temperature_valid;
+    } else {
+        memset(ow->pub.rom, 0, sizeof(ow->pub.rom));
+        ow->pub.temperature = 0;
+        ow->pub.temperature_valid = 0;
+    }
+    ow->pub_changed = true;
+}
+
+static void finish_cmd(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    ow->step = OW_STEP_IDLE;
+    ow->cmd = UART_ONEWIRE_CMD_NONE;
+    ow->pub.busy = 0;
+    update_pub_device(u);
+}
+
+static void fail_cmd(const struct uart_descr *u, bool no_presence)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    if (no_presence) {
+        ow->pub.no_presence = 1;
+    } else {
+        ow->pub.bus_error = 1;
+    }
+    finish_cmd(u);
+}
+
+static void start_cmd(const struct uart_descr *u, enum uart_onewire_cmd cmd)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    ow->cmd = cmd;
+    ow->pub.busy = 1;
+    ow->pub.no_presence = 0;
+    ow->pub.bus_error = 0;
+    ow->pub_changed = true;
+
+    switch (cmd) {
+    case UART_ONEWIRE_CMD_SEARCH:
+        ow->pub.devices_count = 0;
+        ow->search_last_discrepancy = 0;
+        ow->step = OW_STEP_SEARCH_RESET;
+        break;
+
+    case UART_ONEWIRE_CMD_CONVERT_ALL:
+        ow->step = OW_STEP_CONVERT_RESET;
+        break;
+
+    case UART_ONEWIRE_CMD_READ_SCRATCHPAD:
+        if (ow->pub.device_index >= ow->pub.devices_count) {
+            fail_cmd(u, false);
+            return;
+        }
+        ow->dev = ow->pub.device_index;
+        ow->step = OW_STEP_READ_RESET;
+        break;
+
+    default:
+        finish_cmd(u);
+        return;
+    }
+    start_reset(u);
+}
+
+// Температуру в scratchpad отдают только датчики семейства DS18x20
+static bool is_thermometer(const struct onewire_device *d)
+{
+    switch (d->rom[0]) {
+    case ONEWIRE_FAMILY_DS18S20:
+    case ONEWIRE_FAMILY_DS1822:
+    case ONEWIRE_FAMILY_DS18B20:
+    case ONEWIRE_FAMILY_DS1825:
+    case ONEWIRE_FAMILY_DS28EA00:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Переходит к чтению следующего найденного термодатчика, начиная с ow->dev
+static void read_next_device(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    while ((ow->dev < ow->pub.devices_count) && !is_thermometer(&devices(u)[ow->dev])) {
+        ow->dev++;
+    }
+
+    if (ow->dev < ow->pub.devices_count) {
+        ow->step = OW_STEP_READ_RESET;
+        start_reset(u);
+    } else {
+        finish_cmd(u);
+    }
+}
+
+static void process_scratchpad(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+    struct onewire_device *d = &devices(u)[ow->dev];
+
+    uint8_t scratchpad[ONEWIRE_SCRATCHPAD_SIZE];
+    // данные scratchpad идут после MATCH ROM (1 + 8 байт) и READ SCRATCHPAD (1 байт)
+    for (unsigned i = 0; i < ONEWIRE_SCRATCHPAD_SIZE; i++) {
+        scratchpad[i] = get_byte(u, 10 + i);
+    }
+    bool crc_ok = (crc8(scratchpad, ONEWIRE_SCRATCHPAD_SIZE - 1) == scratchpad[ONEWIRE_SCRATCHPAD_SIZE - 1]);
+
+    if (ow->cmd == UART_ONEWIRE_CMD_READ_SCRATCHPAD) {
+        memcpy(ow->pub.scratchpad, scratchpad, ONEWIRE_SCRATCHPAD_SIZE);
+        if (!crc_ok) {
+            fail_cmd(u, false);
+        } else {
+            finish_cmd(u);
+        }
+        return;
+    }
+
+    if (crc_ok) {
+        int16_t t = (int16_t)(scratchpad[0] | (scratchpad[1] << 8));
+        if (d->rom[0] == ONEWIRE_FAMILY_DS18S20) {
+            // DS18S20: разрешение 0.5 °C
+            t *= 8;
+        }
+        d->temperature = t;
+        d->temperature_valid = 1;
+    } else {
+        d->temperature_valid = 0;
+        ow->pub.bus_error = 1;
+    }
+    ow->dev++;
+    read_next_device(u);
+}
+
+static void process_search_bits(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    // bit_number считается с 1, как в алгоритме из AN187
+    uint8_t bit_number = ow->search_bit + 1;
+    uint8_t byte_idx = ow->search_bit / 8;
+    uint8_t byte_mask = 1 << (ow->search_bit % 8);
+
+    bool id_bit = (job_buf(u)[0] == ONEWIRE_SLOT_1);
+    bool cmp_id_bit = (job_buf(u)[1] == ONEWIRE_SLOT_1);
+    bool dir;
+
+    if (id_bit && cmp_id_bit) {
+        // никто не ответил
+        fail_cmd(u, false);
+        return;
+    } else if (id_bit != cmp_id_bit) {
+        dir = id_bit;
+    } else {
+        // расхождение: у устройств на шине в этом бите и 0, и 1
+        if (bit_number < ow->search_last_discrepancy) {
+            dir = ow->search_rom[byte_idx] & byte_mask;
+        } else {
+            dir = (bit_number == ow->search_last_discrepancy);
+        }
+        if (!dir) {
+            ow->search_last_zero = bit_number;
+        }
+    }
+
+    if (dir) {
+        ow->search_rom[byte_idx] |= byte_mask;
+    } else {
+        ow->search_rom[byte_idx] &= ~byte_mask;
+    }
+    ow->step = OW_STEP_SEARCH_WRITE_BIT;
+    start_bits(u, dir ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0, 1);
+}
+
+static void process_search_rom_done(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    if (crc8(ow->search_rom, sizeof(ow->search_rom)) != 0) {
+        fail_cmd(u, false);
+        return;
+    }
+
+    struct onewire_device *d = &devices(u)[ow->pub.devices_count];
+    memcpy(d->rom, ow->search_rom, sizeof(d->rom));
+    d->temperature = 0;
+    d->temperature_valid = 0;
+    ow->pub.devices_count++;
+
+    ow->search_last_discrepancy = ow->search_last_zero;
+    if ((ow->search_last_discrepancy == 0) || (ow->pub.devices_count >= ONEWIRE_MAX_DEVICES)) {
+        finish_cmd(u);
+    } else {
+        ow->step = OW_STEP_SEARCH_RESET;
+        start_reset(u);
+    }
+}
+
+static void process_step(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    switch (ow->step) {
+    case OW_STEP_SEARCH_RESET:
+        if (!reset_presence(u)) {
+            fail_cmd(u, true);
+            break;
+        }
+        ow->search_bit = 0;
+        ow->search_last_zero = 0;
+        ow->step = OW_STEP_SEARCH_CMD;
+        start_bytes(u, (const uint8_t []){ ONEWIRE_CMD_SEARCH_ROM }, 1);
+        break;
+
+    case OW_STEP_SEARCH_WRITE_BIT:
+        ow->search_bit++;
+        if (ow->search_bit >= 64) {
+            process_search_rom_done(u);
+            break;
+        }
+        // fallthrough
+    case OW_STEP_SEARCH_CMD:
+        // бит ROM и его дополнение
+        ow->step = OW_STEP_SEARCH_READ_BITS;
+        start_bits(u, ONEWIRE_SLOT_1, 2);
+        break;
+
+    case OW_STEP_SEARCH_READ_BITS:
+        process_search_bits(u);
+        break;
+
+    case OW_STEP_CONVERT_RESET:
+        if (!reset_presence(u)) {
+            fail_cmd(u, true);
+            break;
+        }
+        ow->step = OW_STEP_CONVERT_CMD;
+        start_bytes(u, (const uint8_t []){ ONEWIRE_CMD_SKIP_ROM, ONEWIRE_CMD_CONVERT_T }, 2);
+        break;
+
+    case OW_STEP_CONVERT_CMD:
+        ow->convert_timestamp = systick_get_system_time_ms();
+        ow->step = OW_STEP_CONVERT_WAIT;
+        break;
+
+    case OW_STEP_READ_RESET: {
+        if (!reset_presence(u)) {
+            fail_cmd(u, true);
+            break;
+        }
+        uint8_t tx[1 + 8 + 1 + ONEWIRE_SCRATCHPAD_SIZE];
+        tx[0] = ONEWIRE_CMD_MATCH_ROM;
+        memcpy(&tx[1], devices(u)[ow->dev].rom, 8);
+        tx[9] = ONEWIRE_CMD_READ_SCRATCHPAD;
+        memset(&tx[10], 0xFF, ONEWIRE_SCRATCHPAD_SIZE);
+        ow->step = OW_STEP_READ_SCRATCHPAD;
+        start_bytes(u, tx, sizeof(tx));
+        break;
+    }
+
+    case OW_STEP_READ_SCRATCHPAD:
+        process_scratchpad(u);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Вызывается из uart_apply_ctrl при включении порта в режиме 1-Wire
+void uart_onewire_start(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    ow->step = OW_STEP_IDLE;
+    ow->cmd = UART_ONEWIRE_CMD_NONE;
+    ow->job_len = 0;
+    ow->job_pos = 0;
+    ow->pub.busy = 0;
+    ow->pub.devices_count = 0;
+    ow->convert_timestamp = systick_get_system_time_ms();
+    update_pub_device(u);
+}
+
+void uart_onewire_process_irq(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    if (u->uart->ISR & USART_ISR_RXNE_RXFNE) {
+        uint8_t rx = u->uart->RDR;
+        u->uart->ICR = USART_ICR_PECF | USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF;
+
+        if (ow->job_pos < ow->job_len) {
+            job_buf(u)[ow->job_pos] = rx;
+            ow->job_pos++;
+            if (ow->job_pos < ow->job_len) {
+                u->uart->TDR = job_buf(u)[ow->job_pos];
+            }
+        }
+    } else {
+        u->uart->ICR = USART_ICR_ORECF;
+    }
+}
+
+void uart_onewire_process_region(const struct uart_descr *u, const struct uart_onewire *ow_regmap)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    ow->pub.device_index = ow_regmap->device_index;
+    ow->pub.auto_convert_period_s = ow_regmap->auto_convert_period_s;
+    update_pub_device(u);
+
+    if ((ow_regmap->cmd != UART_ONEWIRE_CMD_NONE) && (ow_regmap->cmd <= UART_ONEWIRE_CMD_MAX_VALUE)) {
+        if ((u->ctx->ctrl.enable) && (u->ctx->ctrl.mode == UART_MODE_ONEWIRE) && (ow->step == OW_STEP_IDLE)) {
+            start_cmd(u, ow_regmap->cmd);
+        } else {
+            ow->pub.bus_error = 1;
+        }
+    }
+
+    ow->pub.cmd = UART_ONEWIRE_CMD_NONE;
+    ow->pub.applyed = 1;
+}
+
+void uart_onewire_do_periodic_work(const struct uart_descr *u)
+{
+    struct uart_onewire_ctx *ow = &u->ctx->onewire;
+
+    if (ow->pub_changed) {
+        if (regmap_set_region_data(u->onewire_region, &ow->pub, sizeof(ow->pub))) {
+            ow->pub_changed = false;
+        }
+    }
+
+    if ((u->ctx->ctrl.enable == 0) || (u->ctx->ctrl.mode != UART_MODE_ONEWIRE)) {
+        return;
+    }
+
+    if (ow->step == OW_STEP_IDLE) {
+        if ((ow->pub.auto_convert_period_s) && (ow->pub.devices_count) &&
+            (systick_get_time_since_timestamp(ow->convert_timestamp) >= ow->pub.auto_convert_period_s * 1000U))
+        {
+            start_cmd(u, UART_ONEWIRE_CMD_CONVERT_ALL);
+        }
+        return;
+    }
+
+    if (ow->step == OW_STEP_CONVERT_WAIT) {
+        if (systick_get_time_since_timestamp(ow->convert_timestamp) >= ONEWIRE_CONVERT_TIME_MS) {
+            ow->dev = 0;
+            read_next_device(u);
+        }
+        return;
+    }
+
+    if (!job_done(u)) {
+        if (systick_get_time_since_timestamp(ow->job_timestamp) >= ONEWIRE_JOB_TIMEOUT_MS) {
+            ow->job_len = 0;
+            fail_cmd(u, false);
+        }
+        return;
+    }
+
+    process_step(u);
+}
+
+#endif
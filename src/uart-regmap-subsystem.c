@@ -12,6 +12,9 @@
 
 #define UART_REGMAP_PORTS_COUNT         2
 
+// Минимальное время неактивного состояния линии прерывания между двумя обменами
+#define UART_IRQ_GPIO_MIN_INACTIVE_US   200
+
 static const gpio_pin_t usart_irq_gpio = { EC_GPIO_UART_INT };
 
 // Битовые флаги для обработки процесса обмена данными по spi
@@ -27,6 +30,7 @@ struct spi_exchange_flags {
 };
 
 static bool irq_handled = false;
+static uint32_t irq_inactive_timestamp_us;
 static bool uart_subsystem_initialized = false;
 
 static struct spi_exchange_flags spi_exchange_flags;
@@ -39,7 +43,11 @@ static const struct uart_descr uart_descr[MOD_COUNT] = {
         .irq_num = USART1_IRQn,
         .ctrl_region = REGMAP_REGION_UART_CTRL_MOD1,
         .start_tx_region = REGMAP_REGION_UART_TX_START_MOD1,
-        .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD1
+        .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD1,
+        .dmx_region = REGMAP_REGION_UART_DMX_MOD1,
+        .onewire_region = REGMAP_REGION_UART_ONEWIRE_MOD1,
+        .stats_region = REGMAP_REGION_UART_STATS_MOD1,
+        .mod = MOD1,
     },
     [MOD2] = {
         .ctx = &uart_ctx[MOD2],
@@ -47,7 +55,11 @@ static const struct uart_descr uart_descr[MOD_COUNT] = {
         .irq_num = USART2_IRQn,
         .ctrl_region = REGMAP_REGION_UART_CTRL_MOD2,
         .start_tx_region = REGMAP_REGION_UART_TX_START_MOD2,
-        .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD2
+        .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD2,
+        .dmx_region = REGMAP_REGION_UART_DMX_MOD2,
+        .onewire_region = REGMAP_REGION_UART_ONEWIRE_MOD2,
+        .stats_region = REGMAP_REGION_UART_STATS_MOD2,
+        .mod = MOD2,
     },
 };
 
@@ -63,9 +75,6 @@ static void mod2_uart_irq_handler(void)
 
 static inline void set_irq_gpio_active(void)
 {
-    // Нужно обеспечивать минимальный интервал сбросом и повторной установкой линии прерывания,
-    // иначе линукс может не увидеть его
-    // Необходимый интервао около 200 мкс обеспечивается длительностью основого цикла
     irq_handled = true;
     GPIO_S_SET(usart_irq_gpio);
 }
@@ -74,6 +83,17 @@ static inline void set_irq_gpio_inactive(void)
 {
     irq_handled = false;
     GPIO_S_RESET(usart_irq_gpio);
+    irq_inactive_timestamp_us = systick_get_time_us();
+}
+
+// Нужно обеспечивать минимальный интервал между сбросом и повторной установкой линии прерывания,
+// иначе линукс может не увидеть его. На длительность основного цикла полагаться нельзя:
+// планировщик выполняет проход по пробуждению от любого прерывания, и следующий проход может начаться сразу.
+// systick_get_time_us может отстать на 1 мс, поэтому отрицательная разность считается как "не прошло"
+static inline bool irq_gpio_inactive_time_elapsed(void)
+{
+    int32_t inactive_us = (int32_t)(systick_get_time_us() - irq_inactive_timestamp_us);
+    return inactive_us >= UART_IRQ_GPIO_MIN_INACTIVE_US;
 }
 
 void uart_regmap_subsystem_init(void)
@@ -106,6 +126,9 @@ void uart_regmap_subsystem_init(void)
         uart_ctx[i].ctrl.parity = UART_PARITY_NONE;
         uart_ctx[i].ctrl.stop_bits = UART_STOP_BITS_1;
         uart_ctx[i].ctrl.word_length = UART_WORD_LEN_8;
+        uart_ctx[i].ctrl.mode = UART_MODE_UART;
+        uart_ctx[i].ctrl.dmx_channels_count = UART_DMX_UNIVERSE_SIZE;
+        uart_ctx[i].ctrl.dmx_refresh_hz = 44;
 
         uart_ctx[i].rx_data.ready_for_tx = 1;
 
@@ -152,6 +175,29 @@ void uart_regmap_subsystem_do_periodic_work(void)
         }
     }
 
+    // Обработка региона DMX и передача кадров
+    for (int i = 0; i < MOD_COUNT; i++) {
+        struct uart_dmx_window dmx_window;
+        if (regmap_get_data_if_region_changed(uart_descr[i].dmx_region, &dmx_window, sizeof(dmx_window))) {
+            uart_dmx_process_window(&uart_descr[i], &dmx_window);
+        }
+        uart_dmx_do_periodic_work(&uart_descr[i]);
+    }
+
+    // Обработка региона 1-Wire и выполнение команд
+    for (int i = 0; i < MOD_COUNT; i++) {
+        struct uart_onewire onewire;
+        if (regmap_get_data_if_region_changed(uart_descr[i].onewire_region, &onewire, sizeof(onewire))) {
+            uart_onewire_process_region(&uart_descr[i], &onewire);
+        }
+        uart_onewire_do_periodic_work(&uart_descr[i]);
+    }
+
+    // Статистика портов: счётчики меняются в прерывании, regmap_set_region_data копирует их атомарно
+    for (int i = 0; i < MOD_COUNT; i++) {
+        regmap_set_region_data(uart_descr[i].stats_region, &uart_ctx[i].stats, sizeof(uart_ctx[i].stats));
+    }
+
     // Обработка региона обмена
     if (irq_handled) {
         for (int i = 0; i < MOD_COUNT; i++) {
@@ -201,7 +247,7 @@ void uart_regmap_subsystem_do_periodic_work(void)
                 }
             }
 
-            if (spi_exchange_flags.new_exchange_ready == BIT_MASK(MOD_COUNT)) {
+            if ((spi_exchange_flags.new_exchange_ready == BIT_MASK(MOD_COUNT)) && (irq_gpio_inactive_time_elapsed())) {
                 // все порты готовы к новому обмену - устанавливаем прерывание и сбрасываем флаги
                 spi_exchange_flags.new_exchange_ready = 0;
                 spi_exchange_flags.need_to_collect_data = 0;
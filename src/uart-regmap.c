@@ -47,12 +47,28 @@
  * 4) После того, как прозведен обмен данными, ЕС сбрасывает прерывание, заполняет UART_EXCHANGE и снова взводит прерывание
  * 5) Процесс продолжается до тех пор, пока во внутреннем кольцевом буфере ЕС есть данные
  *
+ * Режим 9 бит данных (multidrop):
+ * 9-й бит означает, что байт является адресным. Контроль чётности в этом режиме не поддерживается.
+ * - при приёме 9-й бит передаётся в флаге UART_RX_BYTE_ADDR_MARK, т.е. адресный байт всегда
+ *   приходит в формате "байты с ошибками"
+ * - при передаче 9-й бит устанавливается у первого байта порции, если в UART_EXCHANGE выставлен addr_mark_first
+ * - если в UART_CTRL включен addr_match_enabled, USART работает в mute mode с детектированием адреса:
+ *   кадры, адресованные другим узлам (адрес не равен node_addr), отбрасываются аппаратно
+ *   и не попадают в кольцевой буфер, прерывания на них не генерируются
+ *
+ * Режим DMX512 (mode = UART_MODE_DMX) описан в uart-regmap-dmx.c
+ * Режим мастера 1-Wire (mode = UART_MODE_ONEWIRE) описан в uart-regmap-onewire.c
+ *
  */
 
 #define UART_RX_BYTE_ERROR_PE               BIT(0)
 #define UART_RX_BYTE_ERROR_FE               BIT(1)
 #define UART_RX_BYTE_ERROR_NE               BIT(2)
 #define UART_RX_BYTE_ERROR_ORE              BIT(3)
+// Не ошибка: 9-й бит принятого байта в режиме 9 бит данных (адресный байт)
+#define UART_RX_BYTE_ADDR_MARK              BIT(7)
+
+#define UART_WORD_BIT8                      BIT(8)
 
 static_assert(sizeof(struct uart_rx) == sizeof(struct uart_tx), "Size of uart_rx and uart_tx must be equal");
 
@@ -111,7 +127,15 @@ static void uart_put_tx_data_from_regmap_to_circ_buffer(const struct uart_descr
     if ((u->ctx->rx_data.ready_for_tx) && (tx->bytes_to_send_count > 0)) {
         disable_txe_irq(u);
         for (size_t i = 0; i < tx->bytes_to_send_count; i++) {
-            circ_buffer_tx_push(&u->ctx->circ_buf_tx, tx->bytes_to_send[i]);
+            uint16_t word = tx->bytes_to_send[i];
+            if ((i == 0) && (tx->addr_mark_first) && (u->ctx->ctrl.word_length == UART_WORD_LEN_9)) {
+                word |= UART_WORD_BIT8;
+            }
+            circ_buffer_tx_push(&u->ctx->circ_buf_tx, word);
+        }
+        uint16_t tx_used = circ_buffer_get_used_space(&u->ctx->circ_buf_tx.i);
+        if (tx_used > u->ctx->stats.tx_buf_peak) {
+            u->ctx->stats.tx_buf_peak = tx_used;
         }
         u->ctx->rx_data.ready_for_tx = false;
         enable_txe_irq(u);
@@ -142,9 +166,14 @@ void uart_apply_ctrl(const struct uart_descr *u, bool enable_req)
 
     // word length:
     // Если включен контроль четности, то фактическая длина данных на передачу/прием увеличивается на 1 бит
-    // Разершённые комбинации (7 + 0), (7 + 1), (8 + 0), (8 + 1) (бит данных + бит четности).
+    // Разершённые комбинации (7 + 0), (7 + 1), (8 + 0), (8 + 1), (9 + 0) (бит данных + бит четности).
     // Остальные комбинации не поддерживается и отсеивается в uart_regmap_process_ctrl.
-    int word_len_data_with_parity = 8 - ctrl->word_length; // добавим бит чётности ниже...
+    int word_len_data_with_parity = 8; // добавим бит чётности ниже...
+    if (ctrl->word_length == UART_WORD_LEN_7) {
+        word_len_data_with_parity = 7;
+    } else if (ctrl->word_length == UART_WORD_LEN_9) {
+        word_len_data_with_parity = 9;
+    }
 
     // parity
     switch (ctrl->parity) {
@@ -167,7 +196,7 @@ void uart_apply_ctrl(const struct uart_descr *u, bool enable_req)
 
     // STM32 задаёт количество бит данных с учётом бита чётности
     switch (word_len_data_with_parity) {
-    case 9: // 8e, 8o modes
+    case 9: // 8e, 8o, 9n modes
         u->uart->CR1 &= ~USART_CR1_M1;
         u->uart->CR1 |= USART_CR1_M0;
         break;
@@ -181,6 +210,23 @@ void uart_apply_ctrl(const struct uart_descr *u, bool enable_req)
         break;
     }
 
+    // multidrop: mute mode с пробуждением по адресному байту (9-й бит = 1)
+    // в режиме 9 бит данных и ADDM7 = 1 сравниваются все 8 бит адреса ADD[7:0]
+    u->uart->CR1 &= ~(USART_CR1_MME | USART_CR1_WAKE);
+    u->uart->CR2 &= ~(USART_CR2_ADD | USART_CR2_ADDM7);
+    if ((ctrl->addr_match_enabled) && (ctrl->word_length == UART_WORD_LEN_9)) {
+        u->uart->CR2 |= (ctrl->node_addr << USART_CR2_ADD_Pos) | USART_CR2_ADDM7;
+        u->uart->CR1 |= USART_CR1_MME | USART_CR1_WAKE;
+    }
+
+    // 1-Wire: half-duplex, TX и RX соединены внутри, линия TX - open-drain
+    if (ctrl->mode == UART_MODE_ONEWIRE) {
+        u->uart->CR3 |= USART_CR3_HDSEL;
+    } else {
+        u->uart->CR3 &= ~USART_CR3_HDSEL;
+    }
+    shared_gpio_set_open_drain(u->mod, MOD_GPIO_TX, ctrl->mode == UART_MODE_ONEWIRE);
+
     if (ctrl->rs485_enabled) {
         u->uart->CR1 |= 0x08 << 21 | 0x08 << 16;     // driver enable assert and de-assert time;
         u->uart->CR3 |= USART_CR3_DEM;               // activate external transceiver control through the DE (Driver Enable) signal
@@ -195,17 +241,36 @@ void uart_apply_ctrl(const struct uart_descr *u, bool enable_req)
         u->ctx->rx_during_tx = true;
     }
 
-    u->uart->CR1 |= USART_CR1_TE | USART_CR1_UE | USART_CR1_RE | USART_CR1_RXNEIE_RXFNEIE | USART_CR1_TCIE;
+    if (ctrl->mode == UART_MODE_DMX) {
+        // DMX512 - только передача, кадры формируются в uart-regmap-dmx.c
+        u->uart->CR1 &= ~(USART_CR1_RE | USART_CR1_RXNEIE_RXFNEIE | USART_CR1_TXEIE_TXFNFIE);
+        u->uart->CR1 |= USART_CR1_TE | USART_CR1_UE | USART_CR1_TCIE;
+    } else if (ctrl->mode == UART_MODE_ONEWIRE) {
+        // 1-Wire - обмен тайм-слотами по приёму каждого символа, см. uart-regmap-onewire.c
+        u->uart->CR1 &= ~(USART_CR1_TCIE | USART_CR1_TXEIE_TXFNFIE);
+        u->uart->CR1 |= USART_CR1_TE | USART_CR1_UE | USART_CR1_RE | USART_CR1_RXNEIE_RXFNEIE;
+    } else {
+        u->uart->CR1 |= USART_CR1_TE | USART_CR1_UE | USART_CR1_RE | USART_CR1_RXNEIE_RXFNEIE | USART_CR1_TCIE;
+    }
 
     if ((ctrl->enable == 0) && (enable_req == 1)) {
         circ_buffer_reset(&u->ctx->circ_buf_tx.i);
         circ_buffer_reset(&u->ctx->circ_buf_rx.i);
 
         u->ctx->rx_buf_overflow = false;
+        u->ctx->rx_buf_overflowing = false;
 
         ctrl->enable = 1;
     }
 
+    if ((ctrl->enable) && (ctrl->mode == UART_MODE_DMX)) {
+        uart_dmx_start(u);
+    }
+
+    if ((ctrl->enable) && (ctrl->mode == UART_MODE_ONEWIRE)) {
+        uart_onewire_start(u);
+    }
+
     if ((ctrl->enable == 1) && (enable_req == 0)) {
 
         ctrl->enable = 0;
@@ -214,14 +279,44 @@ void uart_apply_ctrl(const struct uart_descr *u, bool enable_req)
     if (ctrl->enable) {
         u->uart->CR1 |= USART_CR1_UE;
         u->uart->ICR = USART_ICR_TCCF;
+        if (u->uart->CR1 & USART_CR1_MME) {
+            // Сразу уходим в mute mode, иначе до первого чужого адреса будут приниматься все данные
+            u->uart->RQR = USART_RQR_MMRQ;
+        }
         NVIC_EnableIRQ(u->irq_num);
     }
 }
 
+static inline void uart_stats_count_rx_errors(struct uart_stats *stats, uint8_t err_flags)
+{
+    if (err_flags & UART_RX_BYTE_ERROR_PE) {
+        stats->parity_errors++;
+    }
+    if (err_flags & UART_RX_BYTE_ERROR_FE) {
+        stats->framing_errors++;
+    }
+    if (err_flags & UART_RX_BYTE_ERROR_NE) {
+        stats->noise_errors++;
+    }
+    if (err_flags & UART_RX_BYTE_ERROR_ORE) {
+        stats->overrun_errors++;
+    }
+}
+
 void uart_regmap_process_irq(const struct uart_descr *u)
 {
     struct uart_ctx *ctx = u->ctx;
 
+    if (ctx->ctrl.mode == UART_MODE_DMX) {
+        uart_dmx_process_irq(u);
+        return;
+    }
+
+    if (ctx->ctrl.mode == UART_MODE_ONEWIRE) {
+        uart_onewire_process_irq(u);
+        return;
+    }
+
     if (u->uart->ISR & USART_ISR_TC) {
         u->uart->ICR = USART_ICR_TCCF;
         if ((u->ctx->ctrl.rs485_enabled) && (!u->ctx->rx_during_tx)) {
@@ -232,17 +327,30 @@ void uart_regmap_process_irq(const struct uart_descr *u)
 
     if (u->uart->ISR & USART_ISR_RXNE_RXFNE) {
         union uart_rx_byte_w_errors rx_data;
-        rx_data.byte = u->uart->RDR;
+        uint16_t rdr = u->uart->RDR;
+        uint32_t cr1 = u->uart->CR1;
+        rx_data.byte = rdr;
         // 7e, 7o, 7n modes need zeroing MSB bit in received byte:
-        // STM32 can also obtain 6e, 6o and 9n modes, but we dont use it in our software.
-        if (((u->uart->CR1 & (USART_CR1_M | USART_CR1_PCE)) == USART_CR1_PCE) || // 7e, 7o modes
-           ((u->uart->CR1 & USART_CR1_M) == USART_CR1_M1)) {  // 7n mode
+        // STM32 can also obtain 6e, 6o modes, but we dont use it in our software.
+        if (((cr1 & (USART_CR1_M | USART_CR1_PCE)) == USART_CR1_PCE) || // 7e, 7o modes
+           ((cr1 & USART_CR1_M) == USART_CR1_M1)) {  // 7n mode
             rx_data.byte &= 0x7F;
         }
         // максимально быстро считываем флаги ошибок и сбрасываем их, разгребем потом
         rx_data.err_flags = u->uart->ISR & (USART_ISR_PE | USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE);
         u->uart->ICR = USART_ICR_PECF | USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF;
 
+        ctx->stats.rx_bytes++;
+        if (rx_data.err_flags) {
+            uart_stats_count_rx_errors(&ctx->stats, rx_data.err_flags);
+        }
+
+        // 9n mode: 9-й бит - признак адресного байта
+        // (в режимах 8e, 8o в этом бите находится бит чётности)
+        if (((cr1 & (USART_CR1_M | USART_CR1_PCE)) == USART_CR1_M0) && (rdr & UART_WORD_BIT8)) {
+            rx_data.err_flags |= UART_RX_BYTE_ADDR_MARK;
+        }
+
         if (ctx->rx_buf_overflow) {
             ctx->rx_buf_overflow = false;
             rx_data.err_flags |= UART_RX_BYTE_ERROR_ORE;
@@ -250,7 +358,18 @@ void uart_regmap_process_irq(const struct uart_descr *u)
 
         if (circ_buffer_get_available_space(&ctx->circ_buf_rx.i) > 0) {
             circ_buffer_rx_push(&ctx->circ_buf_rx, &rx_data);
+            ctx->rx_buf_overflowing = false;
+            uint16_t rx_used = circ_buffer_get_used_space(&ctx->circ_buf_rx.i);
+            if (rx_used > ctx->stats.rx_buf_peak) {
+                ctx->stats.rx_buf_peak = rx_used;
+            }
         } else {
+            if (!ctx->rx_buf_overflowing) {
+                // считаем события переполнения, а не потерянные байты:
+                // событие длится до первого байта, который снова поместился в буфер
+                ctx->rx_buf_overflowing = true;
+                ctx->stats.rx_buf_overflows++;
+            }
             ctx->rx_buf_overflow = true;
         }
     }
@@ -259,6 +378,7 @@ void uart_regmap_process_irq(const struct uart_descr *u)
         if (circ_buffer_get_used_space(&ctx->circ_buf_tx.i) > 0) {
             // also clears TXFNF flag
             u->uart->TDR = circ_buffer_tx_pop(&ctx->circ_buf_tx);
+            ctx->stats.tx_bytes++;
         } else {
             u->uart->ICR = USART_ICR_TXFECF;
             disable_txe_irq(u);
@@ -270,6 +390,26 @@ void uart_regmap_process_ctrl(const struct uart_descr *u, const struct uart_ctrl
 {
     struct uart_ctx *ctx = u->ctx;
 
+    if ((ctrl->mode <= UART_MODE_MAX_VALUE) && (ctrl->mode != ctx->ctrl.mode)) {
+        ctx->ctrl.mode = ctrl->mode;
+        // в режимах DMX и 1-Wire кольцевые буферы используются под другие данные
+        circ_buffer_reset(&ctx->circ_buf_tx.i);
+        circ_buffer_reset(&ctx->circ_buf_rx.i);
+        if (ctx->ctrl.mode == UART_MODE_DMX) {
+            // в режиме DMX буфер передачи используется для хранения universe
+            uart_dmx_clear_universe(u);
+        }
+    }
+
+    if ((ctrl->dmx_channels_count >= 1) && (ctrl->dmx_channels_count <= UART_DMX_UNIVERSE_SIZE)) {
+        ctx->ctrl.dmx_channels_count = ctrl->dmx_channels_count;
+    }
+
+    // 44 Гц - максимальная частота обновления для полного кадра из 512 каналов
+    if ((ctrl->dmx_refresh_hz >= 1) && (ctrl->dmx_refresh_hz <= 44)) {
+        ctx->ctrl.dmx_refresh_hz = ctrl->dmx_refresh_hz;
+    }
+
     // valid baud 1200..115200
     if ((ctrl->baud_x100 >= 12) && (ctrl->baud_x100 <= 1152)) {
         ctx->ctrl.baud_x100 = ctrl->baud_x100;
@@ -283,10 +423,42 @@ void uart_regmap_process_ctrl(const struct uart_descr *u, const struct uart_ctrl
         ctx->ctrl.parity = ctrl->parity;
     }
 
+    // 9 бит данных + бит чётности не поддерживается аппаратно
+    if (ctx->ctrl.word_length == UART_WORD_LEN_9) {
+        ctx->ctrl.parity = UART_PARITY_NONE;
+    }
+
     // all values are valid
     ctx->ctrl.stop_bits = ctrl->stop_bits;
     ctx->ctrl.rs485_enabled = ctrl->rs485_enabled;
     ctx->ctrl.rs485_rx_during_tx = ctrl->rs485_rx_during_tx;
+    ctx->ctrl.addr_match_enabled = ctrl->addr_match_enabled;
+    ctx->ctrl.node_addr = ctrl->node_addr;
+
+    // больше, чем помещается в regmap, копить нет смысла
+    if (ctrl->irq_min_bytes <= UART_REGMAP_BUFFER_SIZE) {
+        ctx->ctrl.irq_min_bytes = ctrl->irq_min_bytes;
+    }
+    ctx->ctrl.irq_max_hold_ms = ctrl->irq_max_hold_ms;
+
+    if (ctx->ctrl.mode == UART_MODE_DMX) {
+        // формат кадра DMX512 фиксирован: 250 кбит/с, 8N2
+        ctx->ctrl.baud_x100 = 2500;
+        ctx->ctrl.word_length = UART_WORD_LEN_8;
+        ctx->ctrl.parity = UART_PARITY_NONE;
+        ctx->ctrl.stop_bits = UART_STOP_BITS_2;
+        ctx->ctrl.addr_match_enabled = 0;
+    }
+
+    if (ctx->ctrl.mode == UART_MODE_ONEWIRE) {
+        // скорость переключается при обмене (9600 для RESET, 115200 для тайм-слотов), формат 8N1
+        ctx->ctrl.baud_x100 = 1152;
+        ctx->ctrl.word_length = UART_WORD_LEN_8;
+        ctx->ctrl.parity = UART_PARITY_NONE;
+        ctx->ctrl.stop_bits = UART_STOP_BITS_1;
+        ctx->ctrl.rs485_enabled = 0;
+        ctx->ctrl.addr_match_enabled = 0;
+    }
 
     bool enable_req = false;
     if (ctrl->enable) {
@@ -301,10 +473,14 @@ void uart_regmap_process_ctrl(const struct uart_descr *u, const struct uart_ctrl
 void uart_regmap_process_exchange(const struct uart_descr *u, union uart_exchange *e)
 {
     // Это означает, что TX записали, а из RX всё прочитали за одну транзакцию
-    uart_put_tx_data_from_regmap_to_circ_buffer(u, &e->tx);
+    // В режиме DMX буфер передачи занят universe, данные на передачу игнорируются
+    if (u->ctx->ctrl.mode == UART_MODE_UART) {
+        uart_put_tx_data_from_regmap_to_circ_buffer(u, &e->tx);
+    }
 
     u->ctx->rx_data.read_bytes_count = 0;
     u->ctx->rx_data.tx_completed = 0;
+    u->ctx->stats.exchanges++;
 }
 
 void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u)
@@ -337,6 +513,7 @@ void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u)
             ctx->rx_data.read_bytes[0] = data.byte;
         }
         ctx->rx_data.read_bytes_count = 1;
+        ctx->rx_pending_timestamp = systick_get_system_time_ms();
     }
 
     uint8_t regmap_buf_size = UART_REGMAP_BUFFER_SIZE;
@@ -344,6 +521,7 @@ void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u)
         regmap_buf_size = ARRAY_SIZE(ctx->rx_data.bytes_with_errors);
     }
 
+    ctx->rx_regmap_full = false;
     while ((circ_buffer_get_used_space(&ctx->circ_buf_rx.i) > 0) &&
             (ctx->rx_data.read_bytes_count < regmap_buf_size))
     {
@@ -359,6 +537,7 @@ void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u)
                 // то прекращаем заполнять буфер в regmap.
                 // При следующем обмене данные будут в формате с ошибками
                 // Не пишем ошибки сразу, так как высока вероятность что буфер будет записан целиком полезными данными без ошибок
+                ctx->rx_regmap_full = true;
                 break;
             }
             ctx->rx_data.read_bytes[ctx->rx_data.read_bytes_count] = data.byte;
@@ -367,19 +546,48 @@ void uart_regmap_collect_data_for_new_exchange(const struct uart_descr *u)
         // Байт в итоге подходит по формату, извлекаем его из буфера
         circ_buffer_tail_inc(&ctx->circ_buf_rx.i);
     }
+    if (ctx->rx_data.read_bytes_count >= regmap_buf_size) {
+        ctx->rx_regmap_full = true;
+    }
     enable_rxne_irq(u);
 }
 
+// Объединение прерываний по приёму: вызывается, когда в regmap уже есть принятые байты
+static bool uart_rx_irq_hold_expired(struct uart_ctx *ctx)
+{
+    if ((ctx->ctrl.irq_min_bytes == 0) || (ctx->ctrl.irq_max_hold_ms == 0)) {
+        return true;
+    }
+
+    if (ctx->rx_data.read_bytes_count >= ctx->ctrl.irq_min_bytes) {
+        return true;
+    }
+
+    // В regmap больше ничего не поместится (буфер заполнен или следующий байт не подходит по формату) - ждать дальше нельзя
+    // Байты, принятые уже после сбора данных, ожидание не прерывают
+    if (ctx->rx_regmap_full) {
+        return true;
+    }
+
+    if (systick_get_time_since_timestamp(ctx->rx_pending_timestamp) >= ctx->ctrl.irq_max_hold_ms) {
+        return true;
+    }
+
+    return false;
+}
+
 bool uart_regmap_is_irq_needed(const struct uart_descr *u)
 {
     struct uart_ctx *ctx = u->ctx;
 
-    if (ctx->ctrl.enable == 0) {
+    if ((ctx->ctrl.enable == 0) || (ctx->ctrl.mode != UART_MODE_UART)) {
         return false;
     }
 
     if (ctx->rx_data.read_bytes_count > 0) {
-        return true;
+        if (uart_rx_irq_hold_expired(ctx)) {
+            return true;
+        }
     }
 
     if (ctx->rx_data.ready_for_tx) {
@@ -3,14 +3,36 @@
 #include "config.h"
 #include "rcc.h"
 #include "usart_tx.h"
+#include "atomic.h"
 #include <stdbool.h>
+#include <string.h>
+#include <assert.h>
 
 /**
  * Модуль позволяет передавать строки в отладочный UART.
- * Используется блокирующая передача.
  * Возможно передавать как null-terminated строки, так и явно указывать размер
+ *
+ * Передача неблокирующая: данные кладутся в кольцевой буфер, а из него
+ * по прерыванию TXE отправляются в UART. На 115200 один символ передаётся ~87 мкс,
+ * так что блокирующая отправка строки останавливала бы основной цикл на миллисекунды.
+ *
+ * Если данные не помещаются в буфер, они отбрасываются целиком (чтобы не было
+ * обрывков строк), количество отброшенных байт можно узнать usart_tx_get_dropped_bytes().
+ *
+ * Писать в буфер можно только из основного цикла, не из прерываний.
+ *
+ * Перед уходом в standby и перед отключением UART нужно дождаться отправки
+ * буфера: usart_tx_flush(). Это блокирующая отправка (до ~45 мс на полный буфер),
+ * в остальных местах её использовать нельзя. Прерывания при этом не запрещаются,
+ * отключается только прерывание TXE, чтобы буфер разбирал один читатель.
  */
 
+// Должен вмещать приветственное сообщение wbec, которое выводится за один проход
+#define USART_TX_BUF_SIZE           512
+#define USART_TX_BUF_MASK           (USART_TX_BUF_SIZE - 1)
+
+static_assert((USART_TX_BUF_SIZE & USART_TX_BUF_MASK) == 0, "USART TX buffer size must be power of 2");
+
 #ifdef EC_DEBUG_USART_USE_USART1
     static USART_TypeDef * const D_USART = USART1;
 #else
@@ -25,6 +47,16 @@
 
 static bool usart_initialized = false;
 
+struct usart_tx_ring {
+    char buf[USART_TX_BUF_SIZE];
+    // Индексы не заворачиваются по размеру буфера, занято head - tail байт
+    volatile uint16_t head;         // изменяется только основным циклом
+    volatile uint16_t tail;         // изменяется только прерыванием (или в usart_tx_flush)
+    uint32_t dropped_bytes;
+};
+
+static struct usart_tx_ring tx_ring;
+
 static inline void usart_transmit_char(char c)
 {
     while ((D_USART->ISR & USART_ISR_TXE_TXFNF) == 0) {};
@@ -33,7 +65,21 @@ static inline void usart_transmit_char(char c)
 
 static inline void usart_wait_tranmission_complete(void)
 {
-    while (D_USART->ISR & USART_ISR_TC) {};
+    while ((D_USART->ISR & USART_ISR_TC) == 0) {};
+}
+
+static void usart_tx_irq_handler(void)
+{
+    // Прерывание могло остаться в очереди NVIC после отключения TXEIE в usart_tx_flush
+    if ((D_USART->CR1 & USART_CR1_TXEIE_TXFNFIE) && (D_USART->ISR & USART_ISR_TXE_TXFNF)) {
+        uint16_t tail = tx_ring.tail;
+        if (tail != tx_ring.head) {
+            D_USART->TDR = tx_ring.buf[tail & USART_TX_BUF_MASK];
+            tx_ring.tail = tail + 1;
+        } else {
+            D_USART->CR1 &= ~USART_CR1_TXEIE_TXFNFIE;
+        }
+    }
 }
 
 static inline void init_debug_uart_if_not_initialized(void)
@@ -45,6 +91,9 @@ static inline void init_debug_uart_if_not_initialized(void)
 
 void usart_tx_init(void)
 {
+    // UART мог быть уже проинициализирован при первой отправке, не теряем данные
+    usart_tx_flush();
+
     #if defined EC_DEBUG_USART_GPIO
         GPIO_S_SET_OUTPUT(usart_tx_gpio);
         GPIO_S_SET_AF(usart_tx_gpio, EC_DEBUG_USART_GPIO_AF);
@@ -68,11 +117,19 @@ void usart_tx_init(void)
     D_USART->BRR = SystemCoreClock / EC_DEBUG_USART_BAUDRATE;
     D_USART->CR1 |= USART_CR1_TE | USART_CR1_UE;
 
+    #ifdef EC_DEBUG_USART_USE_USART1
+        NVIC_SetHandler(USART1_IRQn, usart_tx_irq_handler);
+        NVIC_EnableIRQ(USART1_IRQn);
+    #endif
+
     usart_initialized = true;
 }
 
 void usart_tx_deinit(void)
 {
+    // Дальше пин может использоваться другой периферией, отправим то, что осталось
+    usart_tx_flush();
+
     #if defined EC_DEBUG_USART_GPIO
         GPIO_S_SET_INPUT(usart_tx_gpio);
     #else
@@ -83,6 +140,9 @@ void usart_tx_deinit(void)
     #endif
 
     #ifdef EC_DEBUG_USART_USE_USART1
+        NVIC_DisableIRQ(USART1_IRQn);
+        NVIC_ClearPendingIRQ(USART1_IRQn);
+
         // Reset USART
         RCC->APBRSTR2 |= RCC_APBRSTR2_USART1RST;
         RCC->APBRSTR2 &= ~RCC_APBRSTR2_USART1RST;
@@ -93,23 +153,55 @@ void usart_tx_deinit(void)
     usart_initialized = false;
 }
 
-void usart_tx_buf_blocking(const void * buf, size_t size)
+void usart_tx_buf(const void * buf, size_t size)
 {
     init_debug_uart_if_not_initialized();
 
+    uint16_t head = tx_ring.head;
+    if (size > usart_tx_get_free_space()) {
+        tx_ring.dropped_bytes += size;
+        return;
+    }
+
     for (size_t i = 0; i < size; i++) {
-        usart_transmit_char(((const char *)buf)[i]);
+        tx_ring.buf[(head + i) & USART_TX_BUF_MASK] = ((const char *)buf)[i];
+    }
+    tx_ring.head = head + size;
+
+    ATOMIC {
+        D_USART->CR1 |= USART_CR1_TXEIE_TXFNFIE;
     }
-    usart_wait_tranmission_complete();
 }
 
-void usart_tx_str_blocking(const char str[])
+void usart_tx_str(const char str[])
 {
-    init_debug_uart_if_not_initialized();
+    usart_tx_buf(str, strlen(str));
+}
 
-    while (*str) {
-        usart_transmit_char(*str);
-        str++;
+void usart_tx_flush(void)
+{
+    if (!usart_initialized) {
+        return;
+    }
+
+    // Отправка опросом, без прерывания TXE: flush может вызываться и с запрещёнными прерываниями.
+    // Остальные прерывания не запрещаются - ожидание длится до десятков мс
+    ATOMIC {
+        D_USART->CR1 &= ~USART_CR1_TXEIE_TXFNFIE;
+    }
+    while (tx_ring.tail != tx_ring.head) {
+        usart_transmit_char(tx_ring.buf[tx_ring.tail & USART_TX_BUF_MASK]);
+        tx_ring.tail++;
     }
     usart_wait_tranmission_complete();
 }
+
+size_t usart_tx_get_free_space(void)
+{
+    return USART_TX_BUF_SIZE - (uint16_t)(tx_ring.head - tx_ring.tail);
+}
+
+uint32_t usart_tx_get_dropped_bytes(void)
+{
+    return tx_ring.dropped_bytes;
+}
@@ -1,6 +1,29 @@
 #include "voltage-monitor.h"
 #include "adc.h"
 #include "systick.h"
+#include "irq-subsystem.h"
+#include "boot-timeline.h"
+#include "array_size.h"
+#include <assert.h>
+
+/**
+ * Каналы напряжения проверяются в основном цикле по отфильтрованным значениям АЦП
+ * с гистерезисом между порогами OK и FAIL.
+ *
+ * Для критичных каналов (vmon_awd_channels) дополнительно используются аппаратные watchdog АЦП
+ * с порогами FAIL: выход за них сразу же, в прерывании, переводит канал в FAIL
+ * и выставляет флаг IRQ_PWR_FAIL для линукса, а также служит событием для захвата осциллограммы в АЦП.
+ * Watchdog взводится, только пока канал в OK - возврат в OK определяется как обычно,
+ * в основном цикле по порогам OK.
+ *
+ * Отфильтрованное значение может не успеть выйти за порог FAIL при коротком провале,
+ * поэтому срабатывание watchdog защёлкивается: канал остаётся в FAIL, пока отфильтрованное
+ * значение не побывает за порогом FAIL и не вернётся в OK, либо пока не пройдёт
+ * VOLTAGE_MONITOR_AWD_HOLD_MS и значение в OK.
+ *
+ * Когда питание отключается штатно (выключение и сброс Linux), watchdog канала
+ * запрещается через vmon_awd_inhibit(), чтобы это не считалось аварией.
+ */
 
 #define __VMON_CH_DATA(vmon_name, adc_name, ok_min, ok_max, fail_min, fail_max) \
     { ADC_CHANNEL_##adc_name, ok_min, ok_max, fail_min, fail_max },
@@ -17,14 +40,73 @@ static const struct vmon_ch_cfg vmon_ch_cfg[VMON_CHANNEL_COUNT] = {
     VOLTAGE_MONITOR_DESC(__VMON_CH_DATA)
 };
 
-static bool vmon_ch_status[VMON_CHANNEL_COUNT] = {};
+// Каналы с аппаратным watchdog, индекс в массиве - номер watchdog АЦП
+static const enum vmon_channel vmon_awd_channels[] = {
+    VMON_CHANNEL_V_IN,
+    VMON_CHANNEL_V50,
+    VMON_CHANNEL_V33,
+};
+
+static_assert(ARRAY_SIZE(vmon_awd_channels) <= ADC_AWD_COUNT, "Too many channels for ADC analog watchdogs");
+
+static volatile bool vmon_ch_status[VMON_CHANNEL_COUNT] = {};
+
+static struct {
+    volatile bool armed;
+    volatile bool latched;                  // сработал watchdog, канал держится в FAIL
+    volatile bool inhibited;                // watchdog запрещён (штатное отключение питания)
+    bool fail_seen;                         // после срабатывания отфильтрованное значение было за порогом FAIL
+    volatile systime_t latch_timestamp;
+} vmon_awd[ARRAY_SIZE(vmon_awd_channels)] = {};
+
 static bool vmon_initialized = 0;
 static systime_t start_timestamp;
 
-static void check_voltage(const struct vmon_ch_cfg * cfg, bool * status)
+// Возвращает индекс watchdog канала или -1, если у канала нет watchdog
+static int awd_index(enum vmon_channel ch)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(vmon_awd_channels); i++) {
+        if (vmon_awd_channels[i] == ch) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Возвращает true, пока канал нужно держать в FAIL после срабатывания watchdog
+static bool awd_latch_hold(unsigned i, uint32_t mv)
 {
+    if (!vmon_awd[i].latched) {
+        return false;
+    }
+
+    const struct vmon_ch_cfg * cfg = &vmon_ch_cfg[vmon_awd_channels[i]];
+    if ((mv < cfg->fail_min) || (mv > cfg->fail_max)) {
+        vmon_awd[i].fail_seen = true;
+    }
+    if ((mv >= cfg->ok_min) && (mv <= cfg->ok_max)) {
+        if ((vmon_awd[i].fail_seen) ||
+            (systick_get_time_since_timestamp(vmon_awd[i].latch_timestamp) >= VOLTAGE_MONITOR_AWD_HOLD_MS))
+        {
+            vmon_awd[i].latched = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_voltage(enum vmon_channel ch)
+{
+    const struct vmon_ch_cfg * cfg = &vmon_ch_cfg[ch];
+    volatile bool * status = &vmon_ch_status[ch];
     uint32_t mv = adc_get_ch_mv(cfg->adc_ch);
 
+    int awd = awd_index(ch);
+    if ((awd >= 0) && (awd_latch_hold(awd, mv))) {
+        *status = 0;
+        return;
+    }
+
     if (*status) {
         // If current status OK, check FAIL limits
         if ((mv < cfg->fail_min) || (mv > cfg->fail_max)) {
@@ -38,9 +120,44 @@ static void check_voltage(const struct vmon_ch_cfg * cfg, bool * status)
     }
 }
 
+// Вызывается из прерывания АЦП
+static void vmon_awd_handler(enum adc_awd awd)
+{
+    vmon_awd[awd].armed = false;
+    if (vmon_awd[awd].inhibited) {
+        return;
+    }
+    vmon_awd[awd].latched = true;
+    vmon_awd[awd].fail_seen = false;
+    vmon_awd[awd].latch_timestamp = systick_get_system_time_ms();
+    vmon_ch_status[vmon_awd_channels[awd]] = 0;
+    irq_set_flag(IRQ_PWR_FAIL);
+    adc_capture_trigger();
+}
+
+// Взводит watchdog на каналах в состоянии OK
+static void rearm_awd(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(vmon_awd_channels); i++) {
+        if ((!vmon_awd[i].armed) && (!vmon_awd[i].inhibited) && (vmon_ch_status[vmon_awd_channels[i]])) {
+            vmon_awd[i].armed = true;
+            adc_awd_rearm(i);
+        }
+    }
+}
+
 void vmon_init(void)
 {
     start_timestamp = systick_get_system_time_ms();
+
+    adc_awd_set_handler(vmon_awd_handler);
+    for (unsigned i = 0; i < ARRAY_SIZE(vmon_awd_channels); i++) {
+        const struct vmon_ch_cfg * cfg = &vmon_ch_cfg[vmon_awd_channels[i]];
+        vmon_awd[i].armed = false;
+        vmon_awd[i].latched = false;
+        vmon_awd[i].inhibited = false;
+        adc_awd_setup(i, cfg->adc_ch, cfg->fail_min, cfg->fail_max);
+    }
 }
 
 bool vmon_ready(void)
@@ -55,19 +172,53 @@ bool vmon_get_ch_status(enum vmon_channel ch)
 
 bool vmon_check_ch_once(enum vmon_channel ch)
 {
-    check_voltage(&vmon_ch_cfg[ch], &vmon_ch_status[ch]);
+    check_voltage(ch);
     return vmon_ch_status[ch];
 }
 
+/**
+ * @brief Запрещает или разрешает watchdog АЦП канала.
+ * Вызывается перед штатным отключением питания канала и после его включения,
+ * пока запрещён - статус канала определяется только по отфильтрованным значениям.
+ * Для каналов без watchdog ничего не делает
+ */
+void vmon_awd_inhibit(enum vmon_channel ch, bool inhibit)
+{
+    int i = awd_index(ch);
+    if (i < 0) {
+        return;
+    }
+    if (inhibit) {
+        vmon_awd[i].inhibited = true;
+        adc_awd_disarm(i);
+        vmon_awd[i].armed = false;
+        vmon_awd[i].latched = false;
+    } else {
+        vmon_awd[i].inhibited = false;
+    }
+}
+
+bool vmon_check_ch_fast(enum vmon_channel ch)
+{
+    const struct vmon_ch_cfg * cfg = &vmon_ch_cfg[ch];
+    uint32_t mv = adc_measure_once_mv(cfg->adc_ch);
+
+    return (mv >= cfg->ok_min) && (mv <= cfg->ok_max);
+}
+
 void vmon_do_periodic_work(void)
 {
     if ((vmon_initialized) ||
         (systick_get_time_since_timestamp(start_timestamp) > VOLTAGE_MONITOR_START_DELAY_MS))
     {
         for (enum vmon_channel ch = 0; ch < VMON_CHANNEL_COUNT; ch++) {
-            check_voltage(&vmon_ch_cfg[ch], &vmon_ch_status[ch]);
+            check_voltage(ch);
+        }
+        if (!vmon_initialized) {
+            boot_timeline_mark(BOOT_MILESTONE_VMON_READY);
         }
         vmon_initialized = 1;
+        rearm_awd();
     }
 }
 
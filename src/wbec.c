@@ -20,6 +20,9 @@
 #include "mcu-pwr.h"
 #include "rcc.h"
 #include "console.h"
+#include "event-log.h"
+#include "power-journal.h"
+#include "boot-timeline.h"
 #include "hwrev.h"
 #include "buzzer.h"
 #include "temperature-control.h"
@@ -74,6 +77,8 @@ struct wbec_ctx {
     bool pwrkey_pressed;
     bool linux_booted;
     bool linux_initial_powered_on;
+    // 3.3В при старте EC, измерено однократно в wbec_init
+    bool v33_present_at_startup;
     unsigned power_loss_cnt;
     systime_t power_loss_timestamp;
     enum linux_poweron_reason poweron_reason;
@@ -99,6 +104,8 @@ static void new_state(enum wbec_state s)
     case WBEC_STATE_WORKING:
         system_led_blink(500, 1000);
         buzzer_beep(EC_BUZZER_BEEP_FREQ, EC_BUZZER_BEEP_POWERON_MS);
+        power_journal_add(POWER_JOURNAL_LINUX_POWERON, wbec_ctx.poweron_reason);
+        boot_timeline_mark(BOOT_MILESTONE_LINUX_WORKING);
         linux_poweron_handler();
         break;
     }
@@ -173,6 +180,29 @@ static inline enum linux_powerctrl_req get_linux_powerctrl_req(void)
     return ret;
 }
 
+/**
+ * Быстрый путь периодического пробуждения RTC, когда питания +5В нет
+ * (EC питается от WBMZ или ждёт появления Vin).
+ * Вызывается в начале main, до инициализации АЦП, hwrev и WBMZ:
+ * +5В измеряется однократно относительно INT VREF, последнее состояние сохраняется
+ * в RTC домене и EC сразу засыпает обратно, как сделал бы wbec_init.
+ * В остальных случаях возвращается, и решение принимается в wbec_init
+ */
+void wbec_periodic_wakeup_fast_path(void)
+{
+    if (mcu_get_poweron_reason() != MCU_POWERON_REASON_RTC_PERIODIC_WAKEUP) {
+        return;
+    }
+    if (vmon_check_ch_fast(VMON_CHANNEL_V50)) {
+        return;
+    }
+
+    if (mcu_get_vcc_5v_last_state() == MCU_VCC_5V_STATE_ON) {
+        mcu_save_vcc_5v_last_state(MCU_VCC_5V_STATE_OFF);
+    }
+    linux_cpu_pwr_seq_off_and_goto_standby(WBEC_PERIODIC_WAKEUP_NEXT_TIMEOUT_S);
+}
+
 void wbec_init(void)
 {
     // Здесь нельзя инициализировать GPIO управления питанием
@@ -186,6 +216,7 @@ void wbec_init(void)
     wbec_ctx.poweron_reason = REASON_UNKNOWN;
 
     bool vcc_5v_ok = vmon_check_ch_once(VMON_CHANNEL_V50);
+    wbec_ctx.v33_present_at_startup = vmon_check_ch_once(VMON_CHANNEL_V33);
     enum mcu_vcc_5v_state vcc_5v_last_state = mcu_get_vcc_5v_last_state();
 
     /**
@@ -248,9 +279,7 @@ void wbec_init(void)
             // POWER ON переопределяется причиной PERIODIC WAKE UP
             // В этом случае тоже нужно включиться.
             // Понять это можно, измерив 3.3В
-            bool vcc_3v3_ok = vmon_check_ch_once(VMON_CHANNEL_V33);
-
-            if ((vcc_3v3_ok) || (vcc_5v_last_state == MCU_VCC_5V_STATE_OFF)) {
+            if ((wbec_ctx.v33_present_at_startup) || (vcc_5v_last_state == MCU_VCC_5V_STATE_OFF)) {
                 // Питание появилось или есть 3.3В (уже работаем) - включаемся в обычном режиме
                 // (просто идём дальше)
                 wbec_ctx.poweron_reason = REASON_POWER_ON;
@@ -304,6 +333,8 @@ void wbec_do_periodic_work(void)
         // Также возможна ситуация, когда при обновлении прошивки МК перезагружается,
         // а линукс в это время работает. Тогда его не надо перезагружать.
         // Факт работы линукса определяется по наличию +3.3В
+        // Ждать vmon нужно, даже если 3.3В не было при старте: дальше в VOLTAGE_CHECK
+        // по VBUS_DEBUG решается, нужна ли пауза для USB-консоли
         if (vmon_ready()) {
             if ((wbec_ctx.poweron_reason == REASON_POWER_ON) && (vmon_get_ch_status(VMON_CHANNEL_V33))) {
                 // Если после включения МК +3.3В есть - значит линукс уже работает
@@ -327,6 +358,7 @@ void wbec_do_periodic_work(void)
             // Сбросим счётчик потерь питания
             wbec_ctx.power_loss_cnt = 0;
             wbec_ctx.power_loss_timestamp = systick_get_system_time_ms();
+            boot_timeline_mark(BOOT_MILESTONE_STARTUP_DONE);
         }
         break;
 
@@ -336,8 +368,8 @@ void wbec_do_periodic_work(void)
         // В этом состоянии линукс всё ещё выключен
         // Тут нужно проверить напряжения и температуру (в будущем)
 
-        // Блокирующая отправка здесь - не страшно,
-        // т.к. устройство в этом состоянии больше ничего не делает
+        // Сообщения отправляются через буфер отладочного UART,
+        // он рассчитан на то, чтобы вместить их целиком
 
         // Если включились по USB (в общем случае - не по Vin) - нужно
         // подождать несколько секунд, чтобы не пропадали первые дебаг-сообщения
@@ -364,7 +396,7 @@ void wbec_do_periodic_work(void)
         console_print("\r\n\n");
         console_print_w_prefix("Wiren Board Embedded Controller\r\n");
         console_print_w_prefix("Firmware version: ");
-        usart_tx_buf_blocking(fwver_chars, ARRAY_SIZE(fwver_chars));
+        usart_tx_buf(fwver_chars, ARRAY_SIZE(fwver_chars));
         console_print("\r\n");
         console_print_w_prefix("Git info: ");
         console_print(MODBUS_DEVICE_GIT_INFO);
@@ -413,16 +445,12 @@ void wbec_do_periodic_work(void)
         // Сидим тут до тех пор, пока температура не станет выше -40
         if (in_state_time_ms() > 5000) {
             if (temperature_control_is_temperature_ready()) {
-                console_print_w_prefix("Temperature is OK!\r\n");
+                event_log(EVENT_LOG_TEMP_OK);
                 console_print_w_prefix("Turning on the main CPU; all future debug messages will originate from the CPU\r\n\n\n");
                 linux_cpu_pwr_seq_on();
                 new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
             } else {
-                console_print_w_prefix("Current board temperature ");
-                console_print_fixed_point(adc.temp / 10, 1);
-                console_print("ºC is too low! Waiting for it to rise above ");
-                console_print_fixed_point(WBEC_MINIMUM_WORKING_TEMPERATURE * 10, 1);
-                console_print("ºC\r\n");
+                event_log_put(EVENT_LOG_TEMP_TOO_LOW, adc.temp / 10, (int16_t)(WBEC_MINIMUM_WORKING_TEMPERATURE * 10));
                 new_state(WBEC_STATE_TEMP_CHECK_LOOP);
             }
         }
@@ -489,8 +517,7 @@ void wbec_do_periodic_work(void)
         if (linux_powerctrl_req == LINUX_POWERCTRL_OFF) {
             // Если прилетел запрос из линукса на выключение
             // Это была выполнена команда `poweroff` или `rtcwake -m off`
-            console_print("\r\n\n");
-            console_print_w_prefix("Power off request from Linux.\r\n");
+            event_log(EVENT_LOG_POWEROFF_REQUEST);
             bool wbmz = wbmz_is_powered_from_wbmz();
             bool alarm = rtc_alarm_is_alarm_enabled();
             bool btn = wbec_ctx.pwrkey_pressed;
@@ -529,11 +556,11 @@ void wbec_do_periodic_work(void)
             // Также разрешено выключаться по poweroff, если питаемся от WBMZ или если
             // выключились по кнопке
             if (wbmz || alarm || btn) {
-                console_print_w_prefix("Powering off\r\n");
+                event_log(EVENT_LOG_POWERING_OFF);
                 linux_cpu_pwr_seq_hard_off();
                 new_state(WBEC_STATE_POWER_OFF_SEQUENCE_WAIT);
             } else {
-                console_print_w_prefix("Alarm not set, reboot system instead of power off.\r\n\n");
+                event_log(EVENT_LOG_REBOOT_NO_ALARM);
                 wbec_ctx.poweron_reason = REASON_REBOOT_NO_ALARM;
                 linux_cpu_pwr_seq_hard_reset();
                 new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
@@ -541,14 +568,12 @@ void wbec_do_periodic_work(void)
         } else if (linux_powerctrl_req == LINUX_POWERCTRL_REBOOT) {
             // Если запрос на перезагрузку - перезагружается
             wbec_ctx.poweron_reason = REASON_REBOOT;
-            console_print("\r\n\n");
-            console_print_w_prefix("Reboot request, reset power.\r\n");
+            event_log(EVENT_LOG_REBOOT_REQUEST);
             linux_cpu_pwr_seq_hard_reset();
             new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
         } else if (linux_powerctrl_req == LINUX_POWERCTRL_PMIC_RESET) {
             wbec_ctx.poweron_reason = REASON_REBOOT;
-            console_print("\r\n\n");
-            console_print_w_prefix("PMIC reset request, activate PMIC RESET line now\r\n\n");
+            event_log(EVENT_LOG_PMIC_RESET_REQUEST);
             linux_cpu_pwr_seq_reset_pmic();
             new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
         }
@@ -556,8 +581,8 @@ void wbec_do_periodic_work(void)
         // Если сработал WDT - перезагружаемся по питанию
         if (wdt_handle_timed_out()) {
             wbec_ctx.poweron_reason = REASON_WATCHDOG;
-            console_print("\r\n\n");
-            console_print_w_prefix("Watchdog is timed out, reset power.\r\n");
+            event_log(EVENT_LOG_WDT_TIMED_OUT);
+            power_journal_add(POWER_JOURNAL_WATCHDOG, 0);
             linux_cpu_pwr_seq_hard_reset();
             new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
         }
@@ -568,7 +593,8 @@ void wbec_do_periodic_work(void)
         // В результате PMIC выключается, но питание на линии 5В остаётся.
         // Ограничение по числу попыток нужно, чтобы избежать циклического перезапуска.
         if (!vmon_get_ch_status(VMON_CHANNEL_V33)) {
-            console_print_w_prefix("3.3V is lost\r\n");
+            event_log(EVENT_LOG_V33_LOST);
+            power_journal_add(POWER_JOURNAL_PMIC_OFF, wbec_ctx.power_loss_cnt);
 
             if (!vmon_get_ch_status(VMON_CHANNEL_V50)) {
                 // Если при этом нет напряжения на линии 5В - это означает, что выдернули питание
@@ -584,7 +610,7 @@ void wbec_do_periodic_work(void)
                 // Если оно слишком низкое - значит надо выключить WBMZ. Далее всё выключиться само,
                 // если после отключения WBMZ пропадет +5В (нет внешнего питания или USB).
                 // А если есть внешнее питание - то продолжит работать от него.
-                console_print_w_prefix("WBMZ battery is fully discharged, disable WBMZ to prevent reboot loop\r\n");
+                event_log(EVENT_LOG_WBMZ_DISCHARGED);
                 wbmz_disable_stepup();
                 linux_cpu_pwr_seq_hard_reset();
                 new_state(WBEC_STATE_POWER_ON_SEQUENCE_WAIT);
@@ -596,13 +622,13 @@ void wbec_do_periodic_work(void)
                 }
                 wbec_ctx.power_loss_timestamp = systick_get_system_time_ms();
                 if (wbec_ctx.power_loss_cnt > WBEC_POWER_LOSS_ATTEMPTS) {
-                    console_print_w_prefix("Reaching power loss limit, power off and go to standby now\r\n");
+                    event_log(EVENT_LOG_POWER_LOSS_LIMIT);
+                    power_journal_add(POWER_JOURNAL_POWER_LOSS_LIMIT, 0);
                     // Чтобы включиться - нужно нажать кнопку или сбросить внешнее питание
                     linux_cpu_pwr_seq_hard_off();
                     new_state(WBEC_STATE_POWER_OFF_SEQUENCE_WAIT);
                 } else {
-                    console_print_w_prefix("Try to reset power\r\n");
-                    console_print_w_prefix("Enable WBMZ to prevent power loss under load\r\n");
+                    event_log(EVENT_LOG_POWER_LOSS_RESET);
                     wbec_ctx.poweron_reason = REASON_PMIC_OFF;
                     wbmz_enable_stepup();
                     linux_cpu_pwr_seq_hard_reset();
@@ -5,6 +5,8 @@
 #include "wbmz6-supercap.h"
 #include "adc.h"
 #include "fix16.h"
+#include "fixmath-fast.h"
+#include <assert.h>
 
 /**
  * За основу драйвера взят драйвер edlc-battery драйвер из ядра Linux:
@@ -47,29 +49,34 @@
 #define SUPERCAP_ENERGY_UWH(mv, mf)         (mf * (mv * mv / 1000) / 2 / 3600)
 #define SUPERCAP_CURRENT_LOWPASS_RC         1000
 
+// Квадраты напряжений для расчёта ёмкости: W пропорциональна V^2, ёмкость и постоянные множители сокращаются
+#define SUPERCAP_MV2_MAX                    ((uint32_t)WBEC_WBMZ6_SUPERCAP_VOLTAGE_MAX_MV * WBEC_WBMZ6_SUPERCAP_VOLTAGE_MAX_MV)
+#define SUPERCAP_MV2_MIN                    ((uint32_t)WBEC_WBMZ6_SUPERCAP_VOLTAGE_MIN_MV * WBEC_WBMZ6_SUPERCAP_VOLTAGE_MIN_MV)
+
+static_assert((uint64_t)(SUPERCAP_MV2_MAX - SUPERCAP_MV2_MIN) * 100 <= UINT32_MAX, "Supercap capacity calculation overflow");
+
 static const uint32_t supercap_energy_max_uwh = SUPERCAP_ENERGY_UWH(WBEC_WBMZ6_SUPERCAP_VOLTAGE_MAX_MV, WBEC_WBMZ6_SUPERCAP_CAPACITY_MF);
-static const uint32_t supercap_energy_min_uwh = SUPERCAP_ENERGY_UWH(WBEC_WBMZ6_SUPERCAP_VOLTAGE_MIN_MV, WBEC_WBMZ6_SUPERCAP_CAPACITY_MF);
 
 static fix16_t supercap_prev_voltage_mv = 0;
 static fix16_t supercap_dv_lowpass = 0;
 
-static inline uint32_t wbmz6_supercap_get_energy_uwh(uint16_t mv)
-{
-    uint32_t energy = SUPERCAP_ENERGY_UWH(mv, WBEC_WBMZ6_SUPERCAP_CAPACITY_MF);
-    return energy;
-}
-
-static inline uint8_t wbmz6_supercap_get_capacity_percent(uint32_t energy_now)
+static inline uint8_t wbmz6_supercap_get_capacity_percent(int16_t mv)
 {
-    if (energy_now < supercap_energy_min_uwh) {
+    if (mv <= 0) {
+        return 0;
+    }
+    uint32_t mv2 = (uint32_t)mv * mv;
+    if (mv2 < SUPERCAP_MV2_MIN) {
         return 0;
     }
-    if (energy_now > supercap_energy_max_uwh) {
+    if (mv2 > SUPERCAP_MV2_MAX) {
         return 100;
     }
-    uint32_t energy_range = supercap_energy_max_uwh - supercap_energy_min_uwh;
-    uint32_t energy = energy_now - supercap_energy_min_uwh;
-    uint8_t capacity = energy * 100 / energy_range;
+    // Деление на константу заменено умножением на обратную величину
+    uint8_t capacity = u32_mul_recip_q32(
+        (mv2 - SUPERCAP_MV2_MIN) * 100,
+        U32_RECIP_Q32(SUPERCAP_MV2_MAX - SUPERCAP_MV2_MIN)
+    );
     return capacity;
 }
 
@@ -122,11 +129,10 @@ void wbmz6_supercap_update_status(struct wbmz6_status *status)
 {
     fix16_t mv_f16 = adc_get_ch_mv_f16(ADC_CHANNEL_ADC_VBAT);
     int16_t mv = fix16_to_int(mv_f16);
-    uint32_t energy = wbmz6_supercap_get_energy_uwh(mv);
     int16_t current_ma = wbmz6_supercap_get_current_ma(mv_f16);
 
     status->voltage_now_mv = mv;
-    status->capacity_percent = wbmz6_supercap_get_capacity_percent(energy);
+    status->capacity_percent = wbmz6_supercap_get_capacity_percent(mv);
 
     if (current_ma > 0) {
         status->is_charging = 1;
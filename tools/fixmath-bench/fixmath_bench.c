@@ -0,0 +1,185 @@
+/**
+ * Бенчмарк ядер с фиксированной точкой для АЦП и WBMZ6-SUPERCAP
+ *
+ * Для каждого ядра сравнивается вариант с делением (как было раньше) и вариант
+ * без деления из include/fixmath-fast.h: время на хосте в нс на вызов и
+ * максимальное расхождение результатов.
+ *
+ * Время на хосте показывает только относительную стоимость операций: на хосте
+ * деление аппаратное, а на Cortex-M0+ оно программное и разница будет больше.
+ * Абсолютные значения в тактах нужно измерять на железе.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "fix16.h"
+#include "fixmath-fast.h"
+
+#define ITERATIONS              2000000
+#define INPUTS_COUNT            256
+
+// Параметры как в прошивке
+#define ADC_VREF_EXT_MV                 3300
+#define ADC_INT_VREF_FACTORY_CAL_MV     3000
+#define ADC_INT_VREF_CAL_VALUE          1655
+#define ADC_FILTRATION_PERIOD_MS        5
+#define FULL_SCALE_MV                   (ADC_VREF_EXT_MV * 2)
+#define SUPERCAP_MV_MAX                 4950
+#define SUPERCAP_MV_MIN                 3000
+#define SUPERCAP_MF                     25000
+
+static fix16_t adc_inputs[INPUTS_COUNT];
+static fix16_t vref_inputs[INPUTS_COUNT];
+static uint16_t rc_inputs[INPUTS_COUNT];
+static int16_t supercap_inputs[INPUTS_COUNT];
+
+static volatile int32_t sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Значение канала в mV в формате fix16
+
+static int32_t mv_f16_div(int i)
+{
+    fix16_t k = fix16_div(fix16_from_int(FULL_SCALE_MV), F16(4095));
+    return fix16_mul(adc_inputs[i], k);
+}
+
+static int32_t mv_f16_fast(int i)
+{
+    static const fix16_t mv_per_lsb = F16(FULL_SCALE_MV / 4095.0);
+    return fix16_mul(adc_inputs[i], mv_per_lsb);
+}
+
+// Коэффициент коррекции по INT_VREF
+
+static int32_t vref_coeff_div(int i)
+{
+    fix16_t k_int_ext = F16((float)ADC_INT_VREF_FACTORY_CAL_MV / ADC_VREF_EXT_MV);
+    fix16_t k_vref = fix16_div(fix16_from_int(ADC_INT_VREF_CAL_VALUE), vref_inputs[i]);
+    return fix16_mul(k_int_ext, k_vref);
+}
+
+static fix16_t vref_k = fix16_one;
+
+static int32_t vref_coeff_fast(int i)
+{
+    static const uint32_t cal_recip = UINT32_MAX / ADC_INT_VREF_CAL_VALUE;
+    fix16_t k_int_ext = F16((float)ADC_INT_VREF_FACTORY_CAL_MV / ADC_VREF_EXT_MV);
+    fix16_t ratio = u32_mul_recip_q32(vref_inputs[i], cal_recip);
+    vref_k = fix16_recip_nr_step(ratio, vref_k);
+    return fix16_mul(k_int_ext, vref_k);
+}
+
+// Коэффициент RC фильтра
+
+static int32_t rc_factor_div(int i)
+{
+    return fix16_div(
+        fix16_one,
+        fix16_add(
+            fix16_one,
+            fix16_div(fix16_from_int(rc_inputs[i]), fix16_from_int(ADC_FILTRATION_PERIOD_MS))
+        )
+    );
+}
+
+static int32_t rc_factor_fast(int i)
+{
+    return ((uint32_t)ADC_FILTRATION_PERIOD_MS << 16) / (ADC_FILTRATION_PERIOD_MS + rc_inputs[i]);
+}
+
+// Ёмкость суперконденсатора в процентах
+
+#define SUPERCAP_ENERGY_UWH(mv, mf)     (mf * (mv * mv / 1000) / 2 / 3600)
+
+static int32_t supercap_capacity_div(int i)
+{
+    uint32_t mv = supercap_inputs[i];
+    uint32_t e_max = SUPERCAP_ENERGY_UWH(SUPERCAP_MV_MAX, SUPERCAP_MF);
+    uint32_t e_min = SUPERCAP_ENERGY_UWH(SUPERCAP_MV_MIN, SUPERCAP_MF);
+    uint32_t e = SUPERCAP_ENERGY_UWH(mv, SUPERCAP_MF);
+    if (e < e_min) {
+        return 0;
+    }
+    if (e > e_max) {
+        return 100;
+    }
+    return (e - e_min) * 100 / (e_max - e_min);
+}
+
+static int32_t supercap_capacity_fast(int i)
+{
+    const uint32_t mv2_max = (uint32_t)SUPERCAP_MV_MAX * SUPERCAP_MV_MAX;
+    const uint32_t mv2_min = (uint32_t)SUPERCAP_MV_MIN * SUPERCAP_MV_MIN;
+    uint32_t mv2 = (uint32_t)supercap_inputs[i] * supercap_inputs[i];
+    if (mv2 < mv2_min) {
+        return 0;
+    }
+    if (mv2 > mv2_max) {
+        return 100;
+    }
+    return u32_mul_recip_q32((mv2 - mv2_min) * 100, U32_RECIP_Q32(mv2_max - mv2_min));
+}
+
+typedef int32_t (*kernel_t)(int i);
+
+static double run_kernel(kernel_t kernel)
+{
+    double start = now_ns();
+    for (int n = 0; n < ITERATIONS; n++) {
+        sink = kernel(n & (INPUTS_COUNT - 1));
+    }
+    return (now_ns() - start) / ITERATIONS;
+}
+
+static int32_t max_diff(kernel_t a, kernel_t b)
+{
+    int32_t diff = 0;
+    for (int i = 0; i < INPUTS_COUNT; i++) {
+        int32_t d = abs(a(i) - b(i));
+        if (d > diff) {
+            diff = d;
+        }
+    }
+    return diff;
+}
+
+static void bench(const char *name, kernel_t with_div, kernel_t fast, const char *diff_units)
+{
+    // Прогрев, заодно итерация Ньютона сходится к текущему значению
+    run_kernel(fast);
+
+    int32_t diff = max_diff(with_div, fast);
+    double t_div = run_kernel(with_div);
+    double t_fast = run_kernel(fast);
+
+    printf("%-20s %8.2f %8.2f %6.1fx   %d %s\n", name, t_div, t_fast, t_div / t_fast, diff, diff_units);
+}
+
+int main(void)
+{
+    srand(1);
+    for (int i = 0; i < INPUTS_COUNT; i++) {
+        adc_inputs[i] = rand() % (4095 << 16);
+        // INT_VREF меняется медленно: шум в пределах нескольких единиц АЦП
+        vref_inputs[i] = fix16_from_int(ADC_INT_VREF_CAL_VALUE - 40) + rand() % (4 << 16);
+        rc_inputs[i] = rand() % 10001;
+        supercap_inputs[i] = 2500 + rand() % 3000;
+    }
+
+    printf("%-20s %8s %8s %7s   %s\n", "kernel", "div, ns", "fast, ns", "ratio", "max diff");
+    bench("adc mv_f16", mv_f16_div, mv_f16_fast, "fix16 LSB");
+    bench("int vref coeff", vref_coeff_div, vref_coeff_fast, "fix16 LSB");
+    bench("rc factor", rc_factor_div, rc_factor_fast, "fix16 LSB");
+    bench("supercap capacity", supercap_capacity_div, supercap_capacity_fast, "%");
+
+    return 0;
+}
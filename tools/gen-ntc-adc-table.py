@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+Генерирует include/ntc-adc-table.h - таблицу температуры NTC, индексированную кодом АЦП.
+
+Таблицы сопротивлений NTC берутся из src/ntc.c, чтобы не дублировать данные.
+Значения считаются тем же алгоритмом, что и ntc_kohm_to_temp
+(делитель NTC + подтяжка, линейная интерполяция по таблице сопротивлений).
+Последняя точка таблицы считается для кода ADC_MAX_VAL - 1 (обрыв NTC),
+код ADC_MAX_VAL обрабатывается отдельно в ntc_convert_adc_raw_to_temp.
+
+Запуск из корня репозитория: ./tools/gen-ntc-adc-table.py > include/ntc-adc-table.h
+"""
+
+import re
+import sys
+
+ADC_MAX_VAL = 4095
+TABLE_STEP_SHIFT = 4        # шаг таблицы 16 кодов АЦП
+TEMP_SHIFT = 6              # температура в 1/64 °C
+TEMP_MIN = -55
+TEMP_MAX = 150
+PULLUP_RES_KOHM = (33,)
+
+NTC_SRC = "src/ntc.c"
+
+
+def parse_ntc_tables(path):
+    src = open(path).read()
+    tables = {}
+    for kohm, body in re.findall(
+        r"#(?:el)?if \(NTC_RES_KOHM == (\d+)\).*?static const fix16_t table_ntc\[\] = \{(.*?)\};",
+        src,
+        re.S,
+    ):
+        tables[int(kohm)] = [float(x) for x in re.findall(r"F16\(([-\d.]+)\)", body)]
+    return tables
+
+
+def kohm_to_temp(table, kohm):
+    step = (TEMP_MAX - TEMP_MIN) / (len(table) - 1)
+    if kohm > table[0]:
+        return TEMP_MIN
+    if kohm < table[-1]:
+        return TEMP_MAX
+    for i in range(len(table) - 1):
+        if table[i] >= kohm >= table[i + 1]:
+            return TEMP_MIN + step * i + step * (table[i] - kohm) / (table[i] - table[i + 1])
+    return TEMP_MAX
+
+
+def adc_to_temp(table, pullup_kohm, adc_val):
+    kohm = 0.0
+    if adc_val < ADC_MAX_VAL:
+        kohm = adc_val * pullup_kohm / (ADC_MAX_VAL - adc_val)
+    return kohm_to_temp(table, kohm)
+
+
+def main():
+    tables = parse_ntc_tables(NTC_SRC)
+    size = ((ADC_MAX_VAL + 1) >> TABLE_STEP_SHIFT) + 1
+    out = sys.stdout
+
+    out.write("#pragma once\n\n")
+    out.write("// Сгенерировано tools/gen-ntc-adc-table.py, не редактировать вручную\n")
+    out.write("// Температура NTC в 1/%d °C для кодов АЦП 0, %d, %d, ... %d\n\n" % (
+        1 << TEMP_SHIFT, 1 << TABLE_STEP_SHIFT, 2 << TABLE_STEP_SHIFT, (size - 1) << TABLE_STEP_SHIFT))
+    out.write("#include <stdint.h>\n\n")
+    out.write("#define NTC_ADC_TABLE_STEP_SHIFT        %d\n" % TABLE_STEP_SHIFT)
+    out.write("#define NTC_ADC_TABLE_TEMP_SHIFT        %d\n\n" % TEMP_SHIFT)
+
+    first = True
+    for kohm in sorted(tables):
+        for pullup in PULLUP_RES_KOHM:
+            cond = "(NTC_RES_KOHM == %d) && (NTC_PULLUP_RES_KOHM == %d)" % (kohm, pullup)
+            out.write("#%s %s\n\n" % ("if" if first else "elif", cond))
+            first = False
+            values = [
+                round(adc_to_temp(tables[kohm], pullup, min(i << TABLE_STEP_SHIFT, ADC_MAX_VAL - 1)) * (1 << TEMP_SHIFT))
+                for i in range(size)
+            ]
+            out.write("static const int16_t ntc_adc_table[%d] = {\n" % size)
+            for i in range(0, size, 8):
+                out.write("    " + ", ".join("%d" % v for v in values[i:i + 8]) + ",\n")
+            out.write("};\n\n")
+
+    out.write("#else\n")
+    out.write("    #error Not supported NTC, regenerate table with tools/gen-ntc-adc-table.py\n")
+    out.write("#endif\n")
+
+
+if __name__ == "__main__":
+    main()
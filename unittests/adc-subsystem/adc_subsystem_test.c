@@ -0,0 +1,173 @@
+#include "unity.h"
+#include "adc-subsystem.h"
+#include "adc.h"
+#include "regmap-int.h"
+#include "utest_regmap.h"
+#include "utest_adc.h"
+#include "utest_systick.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+static const enum adc_channel analog_inputs[] = {
+    ADC_CHANNEL_ADC_IN1,
+    ADC_CHANNEL_ADC_IN2,
+    ADC_CHANNEL_ADC_IN3,
+    ADC_CHANNEL_ADC_IN4,
+};
+
+static struct REGMAP_ADC_FILTER read_filter(void)
+{
+    struct REGMAP_ADC_FILTER f = {};
+    utest_regmap_get_region_data(REGMAP_REGION_ADC_FILTER, &f, sizeof(f));
+    return f;
+}
+
+static void write_filter(const struct REGMAP_ADC_FILTER *f)
+{
+    regmap_set_region_data(REGMAP_REGION_ADC_FILTER, f, sizeof(*f));
+    utest_regmap_mark_region_changed(REGMAP_REGION_ADC_FILTER);
+}
+
+static struct REGMAP_ADC_STATS read_stats(void)
+{
+    struct REGMAP_ADC_STATS s = {};
+    utest_regmap_get_region_data(REGMAP_REGION_ADC_STATS, &s, sizeof(s));
+    return s;
+}
+
+static void write_stats_ctrl(uint16_t window_ms, bool latch)
+{
+    struct REGMAP_ADC_STATS_CTRL c = { .window_ms = window_ms, .latch = latch };
+    regmap_set_region_data(REGMAP_REGION_ADC_STATS_CTRL, &c, sizeof(c));
+    utest_regmap_mark_region_changed(REGMAP_REGION_ADC_STATS_CTRL);
+}
+
+void setUp(void)
+{
+    utest_regmap_reset();
+    utest_adc_filter_reset();
+    utest_adc_stats_reset();
+    utest_systick_set_time_ms(1000);
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Инициализация
+// Ожидается: В ADC_FILTER опубликованы текущие настройки фильтров A1-A4
+static void test_filter_init_publishes_settings(void)
+{
+    LOG_INFO("Testing filter settings publish on init");
+
+    adc_set_lowpass_rc(ADC_CHANNEL_ADC_IN2, 50);
+    adc_subsystem_init();
+
+    struct REGMAP_ADC_FILTER f = read_filter();
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, f.rc_ms[0], "Wrong A1 RC");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(50, f.rc_ms[1], "Wrong A2 RC");
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, f.median_window[i], "Median filter should be off by default");
+    }
+}
+
+// Сценарий: Linux записывает настройки фильтров, часть значений недопустима
+// Ожидается: Настройки применяются к каналам A1-A4, в regmap записываются ограниченные значения
+static void test_filter_write_applies_and_limits(void)
+{
+    LOG_INFO("Testing filter settings write");
+
+    adc_subsystem_init();
+
+    struct REGMAP_ADC_FILTER f = {
+        .rc_ms = { 20, ADC_LOWPASS_RC_MAX_MS + 1, 0, 100 },
+        .median_window = { 3, 4, 7, 2 },
+    };
+    write_filter(&f);
+    adc_subsystem_do_periodic_work();
+
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(20, adc_get_lowpass_rc(analog_inputs[0]), "A1 RC should be applied");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(100, adc_get_lowpass_rc(analog_inputs[3]), "A4 RC should be applied");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(3, adc_get_median_window(analog_inputs[0]), "A1 median window should be applied");
+
+    f = read_filter();
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(ADC_LOWPASS_RC_MAX_MS, f.rc_ms[1], "RC should be limited");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(3, f.median_window[1], "Even median window should be decreased");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(ADC_MEDIAN_WINDOW_MAX, f.median_window[2], "Median window should be limited");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, f.median_window[3], "Median window less than 3 should turn filter off");
+}
+
+// Сценарий: Linux записывает latch = 1
+// Ожидается: Статистика забирается из АЦП и публикуется с новым seq, latch сбрасывается,
+// без повторной команды статистика не забирается
+static void test_stats_latch(void)
+{
+    LOG_INFO("Testing stats latch");
+
+    adc_subsystem_init();
+
+    utest_adc_set_stats(ADC_STATS_CHANNEL_V_IN, 11000, 12500, 12000, 40);
+    utest_adc_set_stats(ADC_STATS_CHANNEL_IN3, 100, 300, 200, 40);
+    write_stats_ctrl(0, true);
+    adc_subsystem_do_periodic_work();
+
+    struct REGMAP_ADC_STATS s = read_stats();
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, s.seq, "seq should be incremented");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(40, s.count, "Wrong count");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(11000, s.v_in_min, "Wrong V_IN min");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(12500, s.v_in_max, "Wrong V_IN max");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(12000, s.v_in_avg, "Wrong V_IN avg");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(100, s.v_a[2].min, "Wrong A3 min");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(300, s.v_a[2].max, "Wrong A3 max");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(200, s.v_a[2].avg, "Wrong A3 avg");
+
+    struct REGMAP_ADC_STATS_CTRL c = {};
+    utest_regmap_get_region_data(REGMAP_REGION_ADC_STATS_CTRL, &c, sizeof(c));
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, c.latch, "latch should be cleared");
+
+    utest_systick_advance_time_ms(10000);
+    adc_subsystem_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_adc_get_stats_take_count(), "Stats should not be taken without latch or window");
+}
+
+// Сценарий: Linux задаёт окно статистики
+// Ожидается: Статистика забирается по окончании каждого окна
+static void test_stats_window(void)
+{
+    LOG_INFO("Testing stats window");
+
+    adc_subsystem_init();
+
+    write_stats_ctrl(500, false);
+    adc_subsystem_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, utest_adc_get_stats_take_count(), "Stats should not be taken on window setup");
+
+    utest_systick_advance_time_ms(499);
+    adc_subsystem_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, utest_adc_get_stats_take_count(), "Stats should not be taken before window end");
+
+    utest_adc_set_stats(ADC_STATS_CHANNEL_V_IN, 5000, 5000, 5000, 25);
+    utest_systick_advance_time_ms(1);
+    adc_subsystem_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_adc_get_stats_take_count(), "Stats should be taken at window end");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(25, read_stats().count, "Wrong count");
+
+    utest_systick_advance_time_ms(500);
+    adc_subsystem_do_periodic_work();
+    struct REGMAP_ADC_STATS s = read_stats();
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(2, s.seq, "seq should be incremented at each window");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, s.count, "Accumulation should restart after each window");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_filter_init_publishes_settings);
+    RUN_TEST(test_filter_write_applies_and_limits);
+    RUN_TEST(test_stats_latch);
+    RUN_TEST(test_stats_window);
+
+    return UNITY_END();
+}
@@ -0,0 +1,99 @@
+#include "unity.h"
+#include "boot-timeline.h"
+#include "regmap-int.h"
+#include "utest_regmap.h"
+#include "utest_systick.h"
+#include "utest_mcu_pwr.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+// Состояние модуля не сбрасывается между тестами, как и в МК после старта:
+// тесты идут по порядку этапов загрузки
+
+static struct REGMAP_BOOT_TIMELINE read_timeline(void)
+{
+    struct REGMAP_BOOT_TIMELINE t = {};
+    utest_regmap_get_region_data(REGMAP_REGION_BOOT_TIMELINE, &t, sizeof(t));
+    return t;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Инициализация до прохождения этапов, до этого EC просыпался из standby
+// Ожидается: все этапы опубликованы как не пройденные, статистика пробуждений опубликована и забрана
+static void test_init_not_reached(void)
+{
+    LOG_INFO("Testing init without milestones");
+
+    utest_regmap_reset();
+    utest_mcu_reset();
+    utest_mcu_set_standby_stats(120, 850);
+    boot_timeline_init();
+
+    struct REGMAP_BOOT_TIMELINE t = read_timeline();
+    for (unsigned i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0xFFFF, t.ms[i], "Milestone should not be reached");
+    }
+
+    struct REGMAP_STANDBY_WAKEUP w = {};
+    utest_regmap_get_region_data(REGMAP_REGION_STANDBY_WAKEUP, &w, sizeof(w));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(120, w.wakeups, "Wrong standby wakeups count");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(850, w.last_awake_us, "Wrong awake time");
+
+    struct mcu_standby_stats stats;
+    mcu_take_standby_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, stats.wakeups, "Wakeups count should be taken");
+}
+
+// Сценарий: Этап пройден дважды
+// Ожидается: публикуется в периодической задаче, запоминается время первого прохождения
+static void test_first_mark_only(void)
+{
+    LOG_INFO("Testing first mark only");
+
+    utest_systick_set_time_ms(35);
+    boot_timeline_mark(BOOT_MILESTONE_ADC_READY);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0xFFFF, read_timeline().ms[BOOT_MILESTONE_ADC_READY], "Milestone should be published in periodic work");
+
+    boot_timeline_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(35, read_timeline().ms[BOOT_MILESTONE_ADC_READY], "Wrong milestone time");
+
+    utest_systick_set_time_ms(500);
+    boot_timeline_mark(BOOT_MILESTONE_ADC_READY);
+    boot_timeline_do_periodic_work();
+
+    struct REGMAP_BOOT_TIMELINE t = read_timeline();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(35, t.ms[BOOT_MILESTONE_ADC_READY], "Only first mark should be stored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0xFFFF, t.ms[BOOT_MILESTONE_WBEC_INIT], "Other milestones should not be reached");
+}
+
+// Сценарий: Этап пройден позже 65 секунд после старта
+// Ожидается: время ограничено 0xFFFE, 0xFFFF остаётся признаком непройденного этапа
+static void test_time_saturation(void)
+{
+    LOG_INFO("Testing time saturation");
+
+    utest_systick_set_time_ms(100000);
+    boot_timeline_mark(BOOT_MILESTONE_LINUX_WORKING);
+    boot_timeline_do_periodic_work();
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0xFFFE, read_timeline().ms[BOOT_MILESTONE_LINUX_WORKING], "Time should saturate");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_init_not_reached);
+    RUN_TEST(test_first_mark_only);
+    RUN_TEST(test_time_saturation);
+
+    return UNITY_END();
+}
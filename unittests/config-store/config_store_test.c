@@ -0,0 +1,402 @@
+#include "unity.h"
+#include "config-store.h"
+#include "regmap-int.h"
+#include "utest_regmap.h"
+#include "utest_flash.h"
+#include "utest_event_log.h"
+#include "flash.h"
+#include <string.h>
+#include <stddef.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+// Значения по умолчанию, которые выставляют модули при инициализации
+static void init_regions(void)
+{
+    struct REGMAP_RTC_CFG rtc_cfg = {};
+    struct REGMAP_ADC_FILTER adc_filter = {};
+    struct REGMAP_GPIO_DIR gpio_dir = {};
+    struct REGMAP_GPIO_AF gpio_af = {};
+    struct REGMAP_GPIO_DIN_CFG din_cfg = {};
+    struct REGMAP_WDT wdt = { .timeout = 60 };
+    struct REGMAP_UART_CTRL_MOD1 uart1 = {};
+    struct REGMAP_UART_CTRL_MOD2 uart2 = {};
+    struct REGMAP_PWR_SEQ_CFG pwr_seq = { .wait_3v3_ms = 1000 };
+
+    regmap_set_region_data(REGMAP_REGION_RTC_CFG, &rtc_cfg, sizeof(rtc_cfg));
+    regmap_set_region_data(REGMAP_REGION_ADC_FILTER, &adc_filter, sizeof(adc_filter));
+    regmap_set_region_data(REGMAP_REGION_GPIO_DIR, &gpio_dir, sizeof(gpio_dir));
+    regmap_set_region_data(REGMAP_REGION_GPIO_AF, &gpio_af, sizeof(gpio_af));
+    regmap_set_region_data(REGMAP_REGION_GPIO_DIN_CFG, &din_cfg, sizeof(din_cfg));
+    regmap_set_region_data(REGMAP_REGION_WDT, &wdt, sizeof(wdt));
+    regmap_set_region_data(REGMAP_REGION_UART_CTRL_MOD1, &uart1, sizeof(uart1));
+    regmap_set_region_data(REGMAP_REGION_UART_CTRL_MOD2, &uart2, sizeof(uart2));
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &pwr_seq, sizeof(pwr_seq));
+}
+
+// Перезагрузка EC: regmap пустой, flash сохраняется
+static void reboot(void)
+{
+    utest_regmap_reset();
+    init_regions();
+    config_store_init();
+}
+
+// Linux записывает настройки
+static void write_settings(uint16_t wdt_timeout, uint16_t uart_baud_x100)
+{
+    struct REGMAP_WDT wdt = { .timeout = wdt_timeout, .reset = 1 };
+    regmap_set_region_data(REGMAP_REGION_WDT, &wdt, sizeof(wdt));
+
+    struct REGMAP_UART_CTRL_MOD1 uart = {};
+    uart.ctrl.enable = 1;
+    uart.ctrl.ctrl_applyed = 1;
+    uart.ctrl.baud_x100 = uart_baud_x100;
+    regmap_set_region_data(REGMAP_REGION_UART_CTRL_MOD1, &uart, sizeof(uart));
+}
+
+static void send_cmd(bool save, bool clear)
+{
+    struct REGMAP_CONFIG_CTRL ctrl = { .save = save, .clear = clear };
+    regmap_set_region_data(REGMAP_REGION_CONFIG_CTRL, &ctrl, sizeof(ctrl));
+    utest_regmap_mark_region_changed(REGMAP_REGION_CONFIG_CTRL);
+    config_store_do_periodic_work();
+}
+
+static struct REGMAP_CONFIG_CTRL read_ctrl(void)
+{
+    struct REGMAP_CONFIG_CTRL ctrl = {};
+    utest_regmap_get_region_data(REGMAP_REGION_CONFIG_CTRL, &ctrl, sizeof(ctrl));
+    return ctrl;
+}
+
+// CRC-16/CCITT, как в config-store.c
+static uint16_t crc16(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (unsigned i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Смещение PWR_SEQ_CFG в данных записи: регионы идут подряд в порядке config-store
+#define PWR_SEQ_CFG_OFFSET  (sizeof(struct REGMAP_RTC_CFG) + sizeof(struct REGMAP_ADC_FILTER) + \
+                             sizeof(struct REGMAP_GPIO_DIR) + sizeof(struct REGMAP_GPIO_AF) + \
+                             sizeof(struct REGMAP_GPIO_DIN_CFG) + sizeof(struct REGMAP_WDT) + \
+                             sizeof(struct REGMAP_UART_CTRL_MOD1) + sizeof(struct REGMAP_UART_CTRL_MOD2))
+#define WDT_OFFSET          (PWR_SEQ_CFG_OFFSET - sizeof(struct REGMAP_UART_CTRL_MOD2) - \
+                             sizeof(struct REGMAP_UART_CTRL_MOD1) - sizeof(struct REGMAP_WDT))
+
+// Размеры данных прежних форматов
+#define FORMAT1_SIZE        PWR_SEQ_CFG_OFFSET
+#define FORMAT2_SIZE        (PWR_SEQ_CFG_OFFSET + offsetof(struct REGMAP_PWR_SEQ_CFG, v33_on_mv))
+
+// Запись прежнего формата, как её сохраняла прошивка до изменения набора регионов
+static void program_old_record(uint16_t format, uint16_t size, uint16_t wdt_timeout, uint16_t wait_3v3_ms)
+{
+    uint8_t rec[128] = {};
+    uint8_t *data = &rec[16];
+
+    struct REGMAP_WDT wdt = { .timeout = wdt_timeout };
+    memcpy(&data[WDT_OFFSET], &wdt, sizeof(wdt));
+    struct REGMAP_PWR_SEQ_CFG pwr_seq = { .wait_3v3_ms = wait_3v3_ms };
+    memcpy(&data[PWR_SEQ_CFG_OFFSET], &pwr_seq, sizeof(pwr_seq));
+    // Данных за пределами формата в записи нет
+    memset(&data[size], 0, sizeof(rec) - 16 - size);
+
+    uint16_t hdr[5] = { 0xC0F6, format, 7, size };
+    memcpy(rec, hdr, sizeof(hdr));
+    uint16_t crc = crc16(0xFFFF, &rec[2], 6);
+    hdr[4] = crc16(crc, data, sizeof(rec) - 16);
+    memcpy(rec, hdr, sizeof(hdr));
+
+    flash_storage_program(0, 0, rec, sizeof(rec));
+}
+
+void setUp(void)
+{
+    utest_regmap_reset();
+    utest_flash_reset();
+    utest_event_log_reset();
+    init_regions();
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Чистая flash
+// Ожидается: stored = 0, регионы не помечаются изменёнными
+static void test_empty_store(void)
+{
+    LOG_INFO("Testing empty store");
+
+    config_store_init();
+
+    struct REGMAP_CONFIG_CTRL ctrl = read_ctrl();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.stored, "Nothing should be stored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.error, "No error expected");
+    TEST_ASSERT_TRUE_MESSAGE(!regmap_get_data_if_region_changed(REGMAP_REGION_WDT, NULL, 0), "WDT region should not be changed");
+}
+
+// Сценарий: Linux сохраняет настройки, EC перезагружается
+// Ожидается: настройки записаны в regmap как изменённые снаружи, команды и флаги состояния не восстанавливаются
+static void test_save_and_restore(void)
+{
+    LOG_INFO("Testing save and restore");
+
+    config_store_init();
+    write_settings(120, 1152);
+    send_cmd(true, false);
+
+    struct REGMAP_CONFIG_CTRL ctrl = read_ctrl();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.save, "Save command should be cleared");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, ctrl.stored, "Settings should be stored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.error, "No error expected");
+
+    reboot();
+
+    struct REGMAP_WDT wdt;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(120, wdt.timeout, "Wrong WDT timeout");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, wdt.reset, "WDT reset must not be restored");
+
+    struct REGMAP_UART_CTRL_MOD1 uart;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_UART_CTRL_MOD1, &uart, sizeof(uart)), "UART region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, uart.ctrl.enable, "Wrong UART enable");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1152, uart.ctrl.baud_x100, "Wrong UART baudrate");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, uart.ctrl.ctrl_applyed, "ctrl_applyed must not be restored");
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, read_ctrl().stored, "Settings should be stored after reboot");
+}
+
+// Сценарий: Много сохранений, в том числе одинаковых настроек
+// Ожидается: страницы стираются по очереди и редко, после перезагрузки восстанавливаются последние настройки
+static void test_wear_leveling(void)
+{
+    LOG_INFO("Testing wear leveling");
+
+    config_store_init();
+
+    // Одинаковые настройки во flash не пишутся
+    write_settings(10, 96);
+    for (int i = 0; i < 100; i++) {
+        send_cmd(true, false);
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, utest_flash_get_erase_count(0) + utest_flash_get_erase_count(1), "No erase expected");
+
+    const uint16_t saves = 200;
+    for (uint16_t i = 0; i < saves; i++) {
+        write_settings(i, 96);
+        send_cmd(true, false);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().error, "No error expected");
+    }
+
+    uint32_t erases0 = utest_flash_get_erase_count(0);
+    uint32_t erases1 = utest_flash_get_erase_count(1);
+    TEST_ASSERT_TRUE_MESSAGE(erases0 + erases1 < saves / 10, "Too many erases");
+    TEST_ASSERT_TRUE_MESSAGE((erases0 + 1 >= erases1) && (erases1 + 1 >= erases0), "Pages should be erased in turn");
+    TEST_ASSERT_TRUE_MESSAGE(erases1 > 0, "Second page should be used");
+
+    reboot();
+
+    struct REGMAP_WDT wdt;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(saves - 1, wdt.timeout, "Latest settings should be restored");
+}
+
+// Сценарий: Питание пропало во время записи; затем стирание настроек
+// Ожидается: восстанавливаются предыдущие настройки; после стирания ничего не восстанавливается
+static void test_interrupted_write_and_clear(void)
+{
+    LOG_INFO("Testing interrupted write and clear");
+
+    config_store_init();
+    write_settings(30, 96);
+    send_cmd(true, false);
+
+    write_settings(40, 96);
+    utest_flash_break_next_program(16);
+    send_cmd(true, false);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, read_ctrl().error, "Error expected");
+
+    reboot();
+
+    struct REGMAP_WDT wdt;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(30, wdt.timeout, "Previous settings should be restored");
+
+    // После сбоя запись продолжается
+    write_settings(50, 96);
+    send_cmd(true, false);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().error, "No error expected");
+
+    send_cmd(false, true);
+    struct REGMAP_CONFIG_CTRL ctrl = read_ctrl();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.clear, "Clear command should be cleared");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, ctrl.stored, "Nothing should be stored after clear");
+
+    reboot();
+    TEST_ASSERT_TRUE_MESSAGE(!regmap_get_data_if_region_changed(REGMAP_REGION_WDT, NULL, 0), "Nothing should be restored after clear");
+}
+
+// Сценарий: Во flash запись прежнего формата, в которой ещё нет PWR_SEQ_CFG
+// Ожидается: регионы из записи восстанавливаются, PWR_SEQ_CFG остаётся по умолчанию;
+// при сохранении тех же настроек запись переписывается в текущем формате
+static void test_old_format_restore(void)
+{
+    LOG_INFO("Testing old format record restore");
+
+    program_old_record(1, FORMAT1_SIZE, 77, 0);
+    reboot();
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, read_ctrl().stored, "Old format record should be accepted");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_event_log_get_count(EVENT_LOG_CONFIG_OLD_FORMAT), "Old format should be logged");
+
+    struct REGMAP_WDT wdt;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(77, wdt.timeout, "Wrong WDT timeout");
+    TEST_ASSERT_TRUE_MESSAGE(!regmap_get_data_if_region_changed(REGMAP_REGION_PWR_SEQ_CFG, NULL, 0), "PWR_SEQ_CFG is not in old record");
+
+    struct REGMAP_PWR_SEQ_CFG pwr_seq = { .wait_3v3_ms = 2000 };
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &pwr_seq, sizeof(pwr_seq));
+    send_cmd(true, false);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().error, "No error expected");
+
+    reboot();
+
+    struct REGMAP_PWR_SEQ_CFG restored;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_PWR_SEQ_CFG, &restored, sizeof(restored)), "PWR_SEQ_CFG should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2000, restored.wait_3v3_ms, "Wrong 3.3V wait time");
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(77, wdt.timeout, "Wrong WDT timeout");
+}
+
+// Сценарий: Во flash запись формата, в котором у PWR_SEQ_CFG ещё нет порогов 3.3В
+// Ожидается: сохранённые поля PWR_SEQ_CFG восстанавливаются, новые остаются по умолчанию
+static void test_old_format_region_prefix_restore(void)
+{
+    LOG_INFO("Testing old format region prefix restore");
+
+    program_old_record(2, FORMAT2_SIZE, 60, 700);
+    utest_regmap_reset();
+    init_regions();
+    struct REGMAP_PWR_SEQ_CFG pwr_seq = { .wait_3v3_ms = 1000, .v33_on_mv = 2500, .v33_off_mv = 1000 };
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &pwr_seq, sizeof(pwr_seq));
+    config_store_init();
+
+    struct REGMAP_PWR_SEQ_CFG restored;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_PWR_SEQ_CFG, &restored, sizeof(restored)), "PWR_SEQ_CFG should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(700, restored.wait_3v3_ms, "Stored field should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2500, restored.v33_on_mv, "New field should keep default value");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1000, restored.v33_off_mv, "New field should keep default value");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_event_log_get_count(EVENT_LOG_CONFIG_OLD_FORMAT), "Old format should be logged");
+}
+
+// Сценарий: Во flash только запись неизвестного формата (от более новой прошивки)
+// Ожидается: ничего не восстанавливается, в лог пишется событие
+static void test_unknown_record_dropped(void)
+{
+    LOG_INFO("Testing unknown record drop");
+
+    program_old_record(100, FORMAT1_SIZE, 77, 0);
+    reboot();
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().stored, "Unknown record must not be accepted");
+    TEST_ASSERT_TRUE_MESSAGE(!regmap_get_data_if_region_changed(REGMAP_REGION_WDT, NULL, 0), "Nothing should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_event_log_get_count(EVENT_LOG_CONFIG_DROPPED), "Dropped settings should be logged");
+}
+
+// Журнал питания: данные с номером n в каждом байте
+static void save_journal(uint8_t n)
+{
+    uint8_t journal[CONFIG_STORE_JOURNAL_SIZE];
+    memset(journal, n, sizeof(journal));
+    TEST_ASSERT_TRUE_MESSAGE(config_store_save_journal(journal), "Journal save should succeed");
+}
+
+static void check_journal(uint8_t n)
+{
+    const uint8_t *journal = config_store_get_journal();
+    TEST_ASSERT_TRUE_MESSAGE(journal != NULL, "Journal should be stored");
+    for (unsigned i = 0; i < CONFIG_STORE_JOURNAL_SIZE; i++) {
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(n, journal[i], "Wrong journal data");
+    }
+}
+
+// Сценарий: Журнал питания записывается много раз после сохранения настроек, затем наоборот
+// Ожидается: при переходе на другую страницу последняя запись другого типа переносится,
+// после перезагрузки восстанавливаются и настройки, и журнал
+static void test_journal_and_settings_share_pages(void)
+{
+    LOG_INFO("Testing journal and settings in the same pages");
+
+    config_store_init();
+    TEST_ASSERT_TRUE_MESSAGE(config_store_get_journal() == NULL, "No journal expected on empty flash");
+
+    write_settings(33, 96);
+    send_cmd(true, false);
+    for (uint8_t i = 0; i < 100; i++) {
+        save_journal(i);
+    }
+    TEST_ASSERT_TRUE_MESSAGE(utest_flash_get_erase_count(0) + utest_flash_get_erase_count(1) > 2, "Pages should be switched");
+
+    reboot();
+    check_journal(99);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, read_ctrl().stored, "Settings should survive journal writes");
+    struct REGMAP_WDT wdt;
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(33, wdt.timeout, "Wrong WDT timeout");
+
+    for (uint16_t i = 0; i < 100; i++) {
+        write_settings(i, 96);
+        send_cmd(true, false);
+    }
+
+    reboot();
+    check_journal(99);
+    TEST_ASSERT_TRUE_MESSAGE(regmap_get_data_if_region_changed(REGMAP_REGION_WDT, &wdt, sizeof(wdt)), "WDT region should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(99, wdt.timeout, "Latest settings should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, utest_event_log_get_count(EVENT_LOG_CONFIG_DROPPED), "Nothing should be dropped");
+}
+
+// Сценарий: Linux стирает сохранённые настройки
+// Ожидается: журнал питания сохраняется
+static void test_clear_keeps_journal(void)
+{
+    LOG_INFO("Testing clear keeps journal");
+
+    config_store_init();
+    write_settings(30, 96);
+    send_cmd(true, false);
+    save_journal(5);
+
+    send_cmd(false, true);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().error, "No error expected");
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_ctrl().stored, "Nothing should be stored after clear");
+    TEST_ASSERT_TRUE_MESSAGE(!regmap_get_data_if_region_changed(REGMAP_REGION_WDT, NULL, 0), "Nothing should be restored after clear");
+    check_journal(5);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_store);
+    RUN_TEST(test_save_and_restore);
+    RUN_TEST(test_wear_leveling);
+    RUN_TEST(test_interrupted_write_and_clear);
+    RUN_TEST(test_old_format_restore);
+    RUN_TEST(test_old_format_region_prefix_restore);
+    RUN_TEST(test_unknown_record_dropped);
+    RUN_TEST(test_journal_and_settings_share_pages);
+    RUN_TEST(test_clear_keeps_journal);
+
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+#include "unity.h"
+#include "event-log.h"
+#include "regmap-int.h"
+#include "usart_tx.h"
+#include "utest_regmap.h"
+#include "utest_systick.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+// Заглушки UART: место в буфере задаётся тестом, flush освобождает весь буфер
+static size_t usart_free_space = 512;
+static unsigned usart_flush_count = 0;
+
+size_t usart_tx_get_free_space(void) { return usart_free_space; }
+
+void usart_tx_flush(void)
+{
+    usart_flush_count++;
+    usart_free_space = 512;
+}
+
+static struct REGMAP_LOG read_log(void)
+{
+    struct REGMAP_LOG l = {};
+    utest_regmap_get_region_data(REGMAP_REGION_LOG, &l, sizeof(l));
+    return l;
+}
+
+static void write_ctrl(uint16_t level_mask, uint16_t read_seq)
+{
+    struct REGMAP_LOG_CTRL ctrl = {
+        .level_mask = level_mask,
+        .read_seq = read_seq,
+    };
+    regmap_set_region_data(REGMAP_REGION_LOG_CTRL, &ctrl, sizeof(ctrl));
+    utest_regmap_mark_region_changed(REGMAP_REGION_LOG_CTRL);
+    event_log_do_periodic_work();
+}
+
+// Состояние модуля сохраняется между тестами: помечаем все записи прочитанными
+void setUp(void)
+{
+    usart_free_space = 512;
+    usart_flush_count = 0;
+    utest_regmap_reset();
+    utest_systick_set_time_ms(1000);
+    event_log_init();
+
+    struct REGMAP_LOG l = read_log();
+    write_ctrl(EVENT_LOG_LEVEL_MASK_DEFAULT, l.seq + l.pending);
+    event_log_print_pending();
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Запись трёх событий и чтение окна LOG
+// Ожидается: в окне две самые старые записи с номером, временем и аргументами, всего 3 непрочитанных
+static void test_records_in_regmap_window(void)
+{
+    LOG_INFO("Testing records in regmap window");
+
+    uint16_t seq = read_log().seq;
+
+    event_log_put(EVENT_LOG_TEMP_TOO_LOW, -415, -400);
+    utest_systick_advance_time_ms(70000);
+    event_log(EVENT_LOG_TEMP_OK);
+    event_log(EVENT_LOG_GOTO_STANDBY);
+    event_log_do_periodic_work();
+
+    struct REGMAP_LOG l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(seq, l.seq, "Window should start from first unread record");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, l.count, "Window should hold 2 records");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(3, l.pending, "All records should be pending");
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENT_LOG_TEMP_TOO_LOW, l.record[0].id, "Wrong first record id");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENT_LOG_LEVEL_WARN, l.record[0].level, "Wrong first record level");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1000, l.record[0].timestamp_lo | ((uint32_t)l.record[0].timestamp_hi << 16), "Wrong first record timestamp");
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(-415, l.record[0].arg[0], "Wrong first record arg 0");
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(-400, l.record[0].arg[1], "Wrong first record arg 1");
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENT_LOG_TEMP_OK, l.record[1].id, "Wrong second record id");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(71000, l.record[1].timestamp_lo | ((uint32_t)l.record[1].timestamp_hi << 16), "Wrong second record timestamp");
+}
+
+// Сценарий: Linux подтверждает чтение окна записью read_seq
+// Ожидается: окно сдвигается на следующие записи, повторная запись старого read_seq игнорируется
+static void test_read_seq_advances_window(void)
+{
+    LOG_INFO("Testing read acknowledge");
+
+    uint16_t seq = read_log().seq;
+
+    event_log(EVENT_LOG_TEMP_OK);
+    event_log(EVENT_LOG_V33_LOST);
+    event_log(EVENT_LOG_GOTO_STANDBY);
+    event_log_do_periodic_work();
+
+    write_ctrl(EVENT_LOG_LEVEL_MASK_DEFAULT, seq + 2);
+    struct REGMAP_LOG l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE((uint16_t)(seq + 2), l.seq, "Window should move after acknowledge");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, l.count, "One record should be left");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENT_LOG_GOTO_STANDBY, l.record[0].id, "Wrong record after acknowledge");
+
+    write_ctrl(EVENT_LOG_LEVEL_MASK_DEFAULT, seq);
+    l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE((uint16_t)(seq + 2), l.seq, "Old read_seq should be ignored");
+
+    write_ctrl(EVENT_LOG_LEVEL_MASK_DEFAULT, seq + 100);
+    l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE((uint16_t)(seq + 2), l.seq, "read_seq beyond written records should be ignored");
+}
+
+// Сценарий: В маске уровней оставлен только ERROR
+// Ожидается: события уровня WARN и INFO не записываются, ERROR записывается
+static void test_level_mask(void)
+{
+    LOG_INFO("Testing log level mask");
+
+    uint16_t seq = read_log().seq;
+    write_ctrl(EVENT_LOG_LEVEL_MASK(ERROR), seq);
+
+    event_log(EVENT_LOG_TEMP_OK);
+    event_log(EVENT_LOG_V33_LOST);
+    event_log(EVENT_LOG_POWER_LOSS_LIMIT);
+    event_log_do_periodic_work();
+
+    struct REGMAP_LOG l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, l.pending, "Only ERROR event should be logged");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENT_LOG_POWER_LOSS_LIMIT, l.record[0].id, "Wrong logged event");
+}
+
+// Сценарий: Записей больше, чем вмещает буфер, Linux их не читает
+// Ожидается: самые старые записи затираются, счётчик потерянных записей растёт
+static void test_overflow_drops_oldest(void)
+{
+    LOG_INFO("Testing overflow");
+
+    struct REGMAP_LOG l = read_log();
+    uint16_t seq = l.seq;
+    uint16_t dropped = l.dropped;
+
+    for (int i = 0; i < 40; i++) {
+        event_log_put(EVENT_LOG_TEMP_TOO_LOW, i, 0);
+    }
+    event_log_do_periodic_work();
+
+    l = read_log();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(32, l.pending, "Buffer should hold 32 records");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE((uint16_t)(dropped + 8), l.dropped, "8 records should be dropped");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE((uint16_t)(seq + 8), l.seq, "Window should start after dropped records");
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(8, l.record[0].arg[0], "Oldest record should be overwritten");
+}
+
+// Сценарий: В буфере UART нет места для записи
+// Ожидается: event_log_print_pending не ждёт отправки, запись выводится позже в периодической задаче;
+// event_log_flush выводит всё, дожидаясь отправки
+static void test_console_output_does_not_block(void)
+{
+    LOG_INFO("Testing console output without blocking");
+
+    usart_free_space = 0;
+    event_log(EVENT_LOG_TEMP_OK);
+    event_log_print_pending();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, usart_flush_count, "print_pending must not wait for UART");
+
+    usart_free_space = 512;
+    event_log_do_periodic_work();
+    usart_free_space = 0;
+    event_log_flush();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, usart_flush_count, "Record should be printed by periodic work");
+
+    event_log(EVENT_LOG_TEMP_OK);
+    event_log(EVENT_LOG_GOTO_STANDBY);
+    event_log_flush();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, usart_flush_count, "flush should wait for UART once");
+
+    usart_free_space = 0;
+    event_log_flush();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, usart_flush_count, "All records should be printed after flush");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_records_in_regmap_window);
+    RUN_TEST(test_read_seq_advances_window);
+    RUN_TEST(test_level_mask);
+    RUN_TEST(test_overflow_drops_oldest);
+    RUN_TEST(test_console_output_does_not_block);
+
+    return UNITY_END();
+}
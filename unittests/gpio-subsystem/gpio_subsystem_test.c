@@ -7,6 +7,8 @@
 #include "utest_regmap.h"
 #include "voltage-monitor.h"
 #include "utest_voltage_monitor.h"
+#include "utest_adc.h"
+#include "utest_irq.h"
 #include "bits.h"
 
 #ifdef EC_MOD1_MOD2_GPIO_CONTROL
@@ -68,6 +70,8 @@ void setUp(void)
     utest_gpio_reset_instances();
     utest_regmap_reset();
     utest_vmon_reset();
+    utest_adc_din_reset();
+    utest_irq_reset();
 
 #ifdef EC_MOD1_MOD2_GPIO_CONTROL
     utest_shared_gpio_reset();
@@ -790,6 +794,51 @@ static void test_multiple_gpios_independent(void)
 #endif
 
 
+// Сценарий: Настройка порогов цифрового входа A2 и его переключение
+// Ожидается: пороги передаются в АЦП, состояние входа отображается в GPIO_CTRL,
+// переключения подсчитываются в GPIO_DIN_CNT и выставляют IRQ_GPIO_DIN
+static void test_gpio_din_thresholds_and_edges(void)
+{
+    LOG_INFO("Testing A1-A4 digital inputs");
+
+    gpio_init();
+    gpio_reset();
+
+    struct REGMAP_GPIO_DIN_CFG din_cfg = {};
+    din_cfg.a[ADC_DIN_A2].low_mv = 1000;
+    din_cfg.a[ADC_DIN_A2].high_mv = 2000;
+    regmap_set_region_data(REGMAP_REGION_GPIO_DIN_CFG, &din_cfg, sizeof(din_cfg));
+    utest_regmap_mark_region_changed(REGMAP_REGION_GPIO_DIN_CFG);
+    gpio_do_periodic_work();
+
+    int32_t low_mv, high_mv;
+    utest_adc_din_get_thresholds(ADC_DIN_A2, &low_mv, &high_mv);
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(1000, low_mv, "A2 low threshold should be passed to ADC");
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(2000, high_mv, "A2 high threshold should be passed to ADC");
+    TEST_ASSERT_FALSE_MESSAGE(utest_irq_is_flag_set(IRQ_GPIO_DIN), "IRQ should not be set without input change");
+
+    utest_adc_din_set_state(ADC_DIN_A2, true);
+    gpio_do_periodic_work();
+
+    struct REGMAP_GPIO_CTRL gpio_ctrl;
+    utest_regmap_get_region_data(REGMAP_REGION_GPIO_CTRL, &gpio_ctrl, sizeof(gpio_ctrl));
+    TEST_ASSERT_TRUE_MESSAGE(gpio_ctrl.gpio_ctrl & BIT(EC_EXT_GPIO_A2), "A2 should be HIGH");
+    TEST_ASSERT_FALSE_MESSAGE(gpio_ctrl.gpio_ctrl & BIT(EC_EXT_GPIO_A1), "A1 should stay LOW");
+    TEST_ASSERT_TRUE_MESSAGE(utest_irq_is_flag_set(IRQ_GPIO_DIN), "IRQ should be set on input change");
+
+    utest_adc_din_set_state(ADC_DIN_A2, false);
+    gpio_do_periodic_work();
+
+    utest_regmap_get_region_data(REGMAP_REGION_GPIO_CTRL, &gpio_ctrl, sizeof(gpio_ctrl));
+    TEST_ASSERT_FALSE_MESSAGE(gpio_ctrl.gpio_ctrl & BIT(EC_EXT_GPIO_A2), "A2 should be LOW");
+
+    struct REGMAP_GPIO_DIN_CNT din_cnt;
+    utest_regmap_get_region_data(REGMAP_REGION_GPIO_DIN_CNT, &din_cnt, sizeof(din_cnt));
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, din_cnt.rising[ADC_DIN_A2], "A2 rising edges should be counted");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, din_cnt.falling[ADC_DIN_A2], "A2 falling edges should be counted");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, din_cnt.rising[ADC_DIN_A1], "A1 should have no edges");
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -820,6 +869,7 @@ int main(void)
     RUN_TEST(test_v_out_control_disabled_when_power_not_ok);
     RUN_TEST(test_v_out_control_disabled_when_ctrl_off);
     RUN_TEST(test_v_out_control_requires_both_conditions);
+    RUN_TEST(test_gpio_din_thresholds_and_edges);
 
     return UNITY_END();
 }
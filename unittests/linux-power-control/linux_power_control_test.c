@@ -12,6 +12,11 @@
 #include "utest_wdt_stm32.h"
 #include "utest_wbmcu_system.h"
 #include "utest_wbmz_common.h"
+#include "utest_event_log.h"
+#include "utest_power_journal.h"
+#include "utest_adc.h"
+#include "utest_regmap.h"
+#include "regmap-int.h"
 
 void utest_linux_power_control_reset_state(void);
 
@@ -46,6 +51,10 @@ void setUp(void)
     utest_linux_power_control_reset_state();
     utest_wbmz_common_reset();
     utest_pwrkey_reset();
+    utest_event_log_reset();
+    utest_power_journal_reset();
+    utest_regmap_reset();
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 0);
     utest_watchdog_set_reload_callback(watchdog_reload_callback);
 }
 
@@ -184,6 +193,127 @@ static void test_periodic_step1_timeout_changes_state_only_after_1000ms(void)
     );
 }
 
+// ==================== Таблица таймингов PWR_SEQ_CFG ====================
+
+static struct REGMAP_PWR_SEQ_CFG read_pwr_seq_cfg(void)
+{
+    struct REGMAP_PWR_SEQ_CFG c = {};
+    utest_regmap_get_region_data(REGMAP_REGION_PWR_SEQ_CFG, &c, sizeof(c));
+    return c;
+}
+
+// Сценарий: Linux записывает свои тайминги, часть значений вне допустимых пределов.
+// До действия: в regmap опубликованы тайминги по умолчанию из конфига модели.
+// После действия: значения ограничены и записаны обратно, step1 завершается по новому таймауту.
+static void test_config_override_limits_values_and_changes_step1_timeout(void)
+{
+    linux_cpu_pwr_seq_config_init();
+    struct REGMAP_PWR_SEQ_CFG c = read_pwr_seq_cfg();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(WBEC_LINUX_POWER_WAIT_3V3_MS, c.wait_3v3_ms, "Default 3.3V wait must be published");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(WBEC_POWER_RESET_TIME_MS, c.reset_max_ms, "Default reset time must be published");
+
+    c.wait_3v3_ms = 300;
+    c.pmic_pwron_attempts = 50;
+    c.reset_min_ms = 10;
+    c.reset_max_ms = 20;
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &c, sizeof(c));
+    utest_regmap_mark_region_changed(REGMAP_REGION_PWR_SEQ_CFG);
+
+    linux_cpu_pwr_seq_init(true);
+    prepare_periodic_runtime(true, false);
+    linux_cpu_pwr_seq_do_periodic_work();
+
+    c = read_pwr_seq_cfg();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, c.wait_3v3_ms, "3.3V wait must be accepted");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(10, c.pmic_pwron_attempts, "Attempts must be limited");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(100, c.reset_min_ms, "Minimum reset time must be limited");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(100, c.reset_max_ms, "Maximum reset time must not be less than minimum");
+
+    utest_systick_advance_time_ms(300);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        0, utest_gpio_get_output_state(pmic_pwron_gpio), "PMIC PWRON GPIO must stay low at exact configured timeout"
+    );
+
+    utest_systick_advance_time_ms(1);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        1, utest_gpio_get_output_state(pmic_pwron_gpio), "PMIC PWRON GPIO must go high after configured timeout"
+    );
+}
+
+// Сценарий: Linux задаёт пороги 3.3В для досрочного выхода из шагов.
+// До действия: по умолчанию пороги 0 - выход по статусу vmon канала V33.
+// После действия: step1 завершается, как только 3.3В выше порога включения (статус vmon ещё FAIL),
+// сброс PMIC - как только 3.3В ниже порога выключения (статус vmon ещё OK).
+static void test_config_v33_thresholds_end_steps_early(void)
+{
+    linux_cpu_pwr_seq_config_init();
+    struct REGMAP_PWR_SEQ_CFG c = read_pwr_seq_cfg();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, c.v33_on_mv, "Default threshold must be vmon status");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, c.v33_off_mv, "Default threshold must be vmon status");
+
+    c.v33_on_mv = 2500;
+    c.v33_off_mv = 5000;
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &c, sizeof(c));
+    utest_regmap_mark_region_changed(REGMAP_REGION_PWR_SEQ_CFG);
+
+    linux_cpu_pwr_seq_init(true);
+    prepare_periodic_runtime(true, false);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 2400);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(3300, read_pwr_seq_cfg().v33_off_mv, "Threshold must be limited");
+    TEST_ASSERT_TRUE_MESSAGE(linux_cpu_pwr_seq_is_busy(), "Step1 must wait while 3.3V is below threshold");
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 2500);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(linux_cpu_pwr_seq_is_busy(), "Step1 must end when 3.3V reaches threshold");
+
+    c = read_pwr_seq_cfg();
+    c.v33_off_mv = 1000;
+    regmap_set_region_data(REGMAP_REGION_PWR_SEQ_CFG, &c, sizeof(c));
+    utest_regmap_mark_region_changed(REGMAP_REGION_PWR_SEQ_CFG);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V33, true);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+    linux_cpu_pwr_seq_reset_pmic();
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 1000);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        1, utest_gpio_get_output_state(pmic_reset_gpio), "PMIC RESET must be held while 3.3V is above threshold"
+    );
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 999);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        0, utest_gpio_get_output_state(pmic_reset_gpio), "PMIC RESET must be released when 3.3V is below threshold"
+    );
+}
+
+// Сценарий: включение через fallback PWRON, 3.3В появляется во время удержания PWRON.
+// До действия: 5В включено, 3.3В нет.
+// После действия: в PWR_SEQ_TIMES опубликовано время каждого шага и количество нажатий PWRON.
+static void test_step_times_published_on_power_on(void)
+{
+    linux_cpu_pwr_seq_init(true);
+    prepare_periodic_runtime(true, false);
+
+    utest_systick_advance_time_ms(1001);
+    linux_cpu_pwr_seq_do_periodic_work();
+
+    utest_systick_advance_time_ms(200);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V33, true);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(linux_cpu_pwr_seq_is_busy(), "Power on must be complete");
+
+    struct REGMAP_PWR_SEQ_TIMES t = {};
+    utest_regmap_get_region_data(REGMAP_REGION_PWR_SEQ_TIMES, &t, sizeof(t));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1001, t.wait_3v3_ms, "Wrong time in step1");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(200, t.pmic_pwron_ms, "Wrong time in step2");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, t.pmic_pwron_pause_ms, "Step3 must not be reached");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, t.pmic_pwron_count, "PWRON must be pressed once");
+}
+
 // Сценарий: граничное условие таймаута шага PS_ON_STEP2_PMIC_PWRON.
 // До действия: fallback уже включил PMIC PWRON и алгоритм находится в step2.
 // После действия: в 1500мс PMIC PWRON остаётся активным, в 1501мс происходит выход из step2 и PWRON сбрасывается.
@@ -539,13 +669,14 @@ static void test_periodic_step3_retry_happens_only_after_timeout_is_strictly_exc
     );
 }
 
-// Сценарий: в reset-5V ожидании истекает таймаут reset.
+// Сценарий: в reset-5V ожидании линия 3.3В не разряжается, истекает максимальный таймаут reset.
 // До действия: hard_reset выключил 5В и перевёл последовательность в ожидание.
 // После действия: 5V снова включается, переход к следующему шагу включения.
 static void test_periodic_hard_reset_recovery_reenables_5v_after_timeout(void)
 {
     linux_cpu_pwr_seq_init(true);
     prepare_periodic_runtime(true, false);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
 
     utest_systick_advance_time_ms(1001);
     linux_cpu_pwr_seq_do_periodic_work();
@@ -573,6 +704,69 @@ static void test_periodic_hard_reset_recovery_reenables_5v_after_timeout(void)
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(
         1, utest_gpio_get_output_state(linux_power_gpio), "Linux power GPIO must be high after reset timeout elapses"
     );
+
+    struct REGMAP_POWER_RESET r = {};
+    utest_regmap_get_region_data(REGMAP_REGION_POWER_RESET, &r, sizeof(r));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0xFFFF, r.v33_discharge_ms, "3.3V must be reported as not discharged");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(WBEC_POWER_RESET_TIME_MS + 1, r.off_ms, "Wrong reported off time");
+}
+
+// Сценарий: в reset-5V ожидании линия 3.3В разряжается раньше минимального времени.
+// До действия: hard_reset выключил 5В, 3.3В ещё есть.
+// После действия: 5V включается сразу после минимального времени, время разрядки записано в regmap.
+static void test_periodic_hard_reset_ends_early_when_v33_discharged(void)
+{
+    linux_cpu_pwr_seq_init(true);
+    prepare_periodic_runtime(true, true);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+
+    linux_cpu_pwr_seq_hard_reset();
+
+    utest_systick_advance_time_ms(50);
+    linux_cpu_pwr_seq_do_periodic_work();
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, WBEC_POWER_RESET_V33_DISCHARGED_MV - 1);
+    utest_systick_advance_time_ms(50);
+    linux_cpu_pwr_seq_do_periodic_work();
+
+    utest_systick_advance_time_ms(WBEC_POWER_RESET_TIME_MIN_MS - 100);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        0, utest_gpio_get_output_state(linux_power_gpio), "Linux power GPIO must stay low until minimum reset time"
+    );
+
+    utest_systick_advance_time_ms(1);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        1, utest_gpio_get_output_state(linux_power_gpio), "Linux power GPIO must be high right after minimum reset time"
+    );
+
+    struct REGMAP_POWER_RESET r = {};
+    utest_regmap_get_region_data(REGMAP_REGION_POWER_RESET, &r, sizeof(r));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(100, r.v33_discharge_ms, "Wrong 3.3V discharge time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(WBEC_POWER_RESET_TIME_MIN_MS + 1, r.off_ms, "Wrong reported off time");
+}
+
+// Сценарий: сброс питания 5В и последующее включение.
+// До действия: питание включено, watchdog АЦП разрешены.
+// После действия: на время сброса watchdog 3.3В запрещён, после включения разрешён снова.
+static void test_hard_reset_inhibits_v33_awd_until_power_on(void)
+{
+    linux_cpu_pwr_seq_init(true);
+    prepare_periodic_runtime(true, true);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+
+    linux_cpu_pwr_seq_hard_reset();
+    TEST_ASSERT_TRUE_MESSAGE(utest_vmon_get_awd_inhibited(VMON_CHANNEL_V33), "3.3V watchdog must be inhibited during reset");
+    TEST_ASSERT_FALSE_MESSAGE(utest_vmon_get_awd_inhibited(VMON_CHANNEL_V50), "5V watchdog must stay enabled during reset");
+
+    utest_vmon_set_ch_status(VMON_CHANNEL_V33, false);
+    utest_systick_advance_time_ms(WBEC_POWER_RESET_TIME_MS + 1);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(utest_vmon_get_awd_inhibited(VMON_CHANNEL_V33), "3.3V watchdog must stay inhibited until 3.3V is back");
+
+    utest_vmon_set_ch_status(VMON_CHANNEL_V33, true);
+    linux_cpu_pwr_seq_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(utest_vmon_get_awd_inhibited(VMON_CHANNEL_V33), "3.3V watchdog must be enabled after power on");
 }
 
 // Сценарий: в PS_OFF_COMPLETE истекает задержка >200мс.
@@ -644,7 +838,7 @@ static void test_periodic_off_complete_disables_stepup_when_enabled(void)
 
 // Сценарий: неожиданно пропало 5V во время работы.
 // До действия: standby не запрошен.
-// После действия: немедленный переход в standby и сохранение статуса 5V=OFF.
+// После действия: немедленный переход в standby и сохранение статуса 5V=OFF, события в логе.
 static void test_periodic_v50_loss_goes_to_standby_with_saved_off_state(void)
 {
     linux_cpu_pwr_seq_init(true);
@@ -664,6 +858,15 @@ static void test_periodic_v50_loss_goes_to_standby_with_saved_off_state(void)
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(
         MCU_VCC_5V_STATE_OFF, mcu_get_vcc_5v_last_state(), "Saved 5V state must be OFF when V50 is absent"
     );
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        1, utest_event_log_get_count(EVENT_LOG_V50_LOST), "V50 loss event must be logged"
+    );
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        EVENT_LOG_GOTO_STANDBY, utest_event_log_get_last(NULL, NULL), "Standby event must be logged last"
+    );
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        1, utest_power_journal_get_count(POWER_JOURNAL_STANDBY), "Standby must be saved to power journal"
+    );
 }
 
 // ==================== Сценарии PMIC reset ====================
@@ -973,6 +1176,11 @@ int main(void)
     RUN_TEST(test_periodic_power_on_fallback_exhaustion_drops_5v);
     RUN_TEST(test_periodic_step3_retry_happens_only_after_timeout_is_strictly_exceeded);
     RUN_TEST(test_periodic_hard_reset_recovery_reenables_5v_after_timeout);
+    RUN_TEST(test_config_override_limits_values_and_changes_step1_timeout);
+    RUN_TEST(test_config_v33_thresholds_end_steps_early);
+    RUN_TEST(test_step_times_published_on_power_on);
+    RUN_TEST(test_periodic_hard_reset_ends_early_when_v33_discharged);
+    RUN_TEST(test_hard_reset_inhibits_v33_awd_until_power_on);
     RUN_TEST(test_periodic_hard_off_timeout_goes_to_standby_with_v50_on);
     RUN_TEST(test_periodic_off_complete_timeout_switches_to_standby_only_after_200ms);
     RUN_TEST(test_periodic_off_complete_disables_stepup_when_enabled);
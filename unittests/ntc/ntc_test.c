@@ -4,6 +4,7 @@
 #include "config.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #define LOG_LEVEL LOG_LEVEL_INFO
 #include "console_log.h"
@@ -351,6 +352,31 @@ static void test_ntc_convert_adc_raw_to_temp_various_values(void)
 }
 
 
+// Сценарий: Сравнение табличного преобразования кода АЦП с расчётом через сопротивление NTC
+// Ожидается: расхождение не превышает 0.5°C во всём рабочем диапазоне кодов АЦП
+static void test_ntc_convert_adc_raw_to_temp_matches_resistance(void)
+{
+    LOG_INFO("Testing ntc_convert_adc_raw_to_temp matches resistance-based conversion");
+
+    static char msg[100];
+
+    for (int adc = 100; adc < 4000; adc += 7) {
+        fix16_t adc_val = fix16_add(fix16_from_int(adc), F16(0.25));
+        fix16_t kohm = fix16_mul(
+            fix16_div(adc_val, fix16_sub(F16(ADC_MAX_VAL), adc_val)),
+            F16(NTC_PULLUP_RES_KOHM)
+        );
+        fix16_t expected = ntc_kohm_to_temp(kohm);
+        fix16_t temp = ntc_convert_adc_raw_to_temp(adc_val);
+
+        snprintf(msg, sizeof(msg), "ADC=%d.25: expected %d.%02d°C, got %d.%02d°C", adc,
+                 fix16_to_int(expected), abs(fix16_to_int(fix16_mul(expected, F16(100)))) % 100,
+                 fix16_to_int(temp), abs(fix16_to_int(fix16_mul(temp, F16(100)))) % 100);
+        TEST_ASSERT_INT32_WITHIN_MESSAGE(F16(0.5), expected, temp, msg);
+    }
+}
+
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -375,6 +401,7 @@ int main(void)
     RUN_TEST(test_ntc_convert_adc_raw_to_temp_adc_zero);
     RUN_TEST(test_ntc_convert_adc_raw_to_temp_adc_max);
     RUN_TEST(test_ntc_convert_adc_raw_to_temp_various_values);
+    RUN_TEST(test_ntc_convert_adc_raw_to_temp_matches_resistance);
 
     return UNITY_END();
 }
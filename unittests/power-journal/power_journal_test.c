@@ -0,0 +1,213 @@
+#include "unity.h"
+#include "power-journal.h"
+#include "config-store.h"
+#include "regmap-int.h"
+#include "utest_regmap.h"
+#include "utest_rtc.h"
+#include "utest_wbmz_common.h"
+#include "utest_flash.h"
+#include "utest_event_log.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+#define JOURNAL_SIZE        14
+
+static struct REGMAP_PWR_JOURNAL read_journal(void)
+{
+    struct REGMAP_PWR_JOURNAL j = {};
+    utest_regmap_get_region_data(REGMAP_REGION_PWR_JOURNAL, &j, sizeof(j));
+    return j;
+}
+
+// Linux выбирает окно журнала
+static void select_window(uint16_t first_entry)
+{
+    struct REGMAP_PWR_JOURNAL_CTRL ctrl = { .first_entry = first_entry };
+    regmap_set_region_data_as_changed(REGMAP_REGION_PWR_JOURNAL_CTRL, &ctrl, sizeof(ctrl));
+    power_journal_do_periodic_work();
+}
+
+static void set_time(uint8_t years, uint8_t months, uint8_t days, uint8_t hours, uint8_t minutes)
+{
+    // Значения в RTC хранятся в BCD
+    struct rtc_time t = {
+        .years = years,
+        .months = months,
+        .days = days,
+        .hours = hours,
+        .minutes = minutes,
+    };
+    utest_rtc_set_datetime(&t);
+}
+
+// Полное пропадание питания EC: RAM, regmap и домен RTC сброшены, flash сохраняется
+static void power_cycle(void)
+{
+    utest_regmap_reset();
+    utest_rtc_reset();
+    config_store_init();
+    power_journal_init();
+}
+
+void setUp(void)
+{
+    utest_regmap_reset();
+    utest_rtc_reset();
+    utest_wbmz_common_reset();
+    utest_flash_reset();
+    utest_event_log_reset();
+    config_store_init();
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Чистая flash после инициализации
+// Ожидается: журнал опубликован, событий нет
+static void test_empty_journal(void)
+{
+    LOG_INFO("Testing empty journal");
+
+    power_journal_init();
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, j.count, "Journal should be empty");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, j.first_entry, "Window should start from newest event");
+}
+
+// Сценарий: Добавление события с временем RTC и аргументом больше 7
+// Ожидается: событие, аргумент и время (BCD переведено в двоичное) опубликованы в regmap
+static void test_event_with_rtc_time(void)
+{
+    LOG_INFO("Testing event with RTC time");
+
+    power_journal_init();
+    set_time(0x25, 0x12, 0x31, 0x23, 0x59);
+    power_journal_add(POWER_JOURNAL_PMIC_OFF, 200);
+    power_journal_do_periodic_work();
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, j.count, "Journal should have one event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_PMIC_OFF, j.entry[0].event, "Wrong event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(200, j.entry[0].arg, "Arg must not be saturated");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(25, j.entry[0].years, "Wrong years");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(12, j.entry[0].months, "Wrong months");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(31, j.entry[0].days, "Wrong days");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(23, j.entry[0].hours, "Wrong hours");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(59, j.entry[0].minutes, "Wrong minutes");
+}
+
+// Сценарий: Событий больше, чем вмещает журнал; полное пропадание питания EC
+// Ожидается: хранятся 14 последних событий, самое новое первым; журнал восстанавливается из flash
+static void test_journal_keeps_latest_events(void)
+{
+    LOG_INFO("Testing journal overflow and restore after power loss");
+
+    power_journal_init();
+    set_time(0x25, 0x01, 0x01, 0x00, 0x00);
+    for (unsigned i = 0; i < JOURNAL_SIZE + 6; i++) {
+        power_journal_add(POWER_JOURNAL_PMIC_OFF, i);
+    }
+
+    power_cycle();
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(JOURNAL_SIZE, j.count, "Journal should hold 14 events");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_PMIC_OFF, j.entry[0].event, "Wrong newest event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(JOURNAL_SIZE + 5, j.entry[0].arg, "Newest event should be first");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(25, j.entry[0].years, "Event time should be restored");
+
+    select_window(JOURNAL_SIZE - 1);
+    j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(6, j.entry[0].arg, "Oldest kept event should be last");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_EMPTY, j.entry[1].event, "Window beyond journal should be empty");
+}
+
+// Сценарий: Linux листает журнал окнами по 4 события, затем выбирает окно за пределами журнала
+// Ожидается: в окне события начиная с first_entry; неверный номер заменяется на 0
+static void test_journal_window(void)
+{
+    LOG_INFO("Testing journal window paging");
+
+    power_journal_init();
+    for (unsigned i = 0; i < 10; i++) {
+        power_journal_add(POWER_JOURNAL_LINUX_POWERON, i);
+    }
+    power_journal_do_periodic_work();
+
+    select_window(4);
+    struct REGMAP_PWR_JOURNAL_CTRL ctrl = {};
+    utest_regmap_get_region_data(REGMAP_REGION_PWR_JOURNAL_CTRL, &ctrl, sizeof(ctrl));
+    TEST_ASSERT_EQUAL_UINT32(4, ctrl.first_entry);
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(10, j.count, "Wrong events count");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(4, j.first_entry, "Window start should be echoed");
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(9 - 4 - i, j.entry[i].arg, "Wrong event in window");
+    }
+
+    select_window(100);
+    j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, j.first_entry, "Out of range window should be reset to 0");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(9, j.entry[0].arg, "Window should start from newest event");
+}
+
+// Сценарий: Питание пропало во время записи журнала во flash
+// Ожидается: запись повторяется в периодической задаче, журнал восстанавливается после перезагрузки
+static void test_journal_save_retry(void)
+{
+    LOG_INFO("Testing journal save retry");
+
+    power_journal_init();
+    power_journal_add(POWER_JOURNAL_WATCHDOG, 0);
+
+    utest_flash_break_next_program(16);
+    power_journal_add(POWER_JOURNAL_POWER_LOSS_LIMIT, 0);
+    power_journal_do_periodic_work();
+
+    power_cycle();
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, j.count, "Both events should be restored");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_POWER_LOSS_LIMIT, j.entry[0].event, "Wrong newest event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_WATCHDOG, j.entry[1].event, "Wrong previous event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, utest_event_log_get_count(EVENT_LOG_CONFIG_DROPPED), "Broken journal record is not a settings loss");
+}
+
+// Сценарий: Переключение питания на WBMZ и обратно
+// Ожидается: в журнал добавляются события WBMZ_ON и WBMZ_OFF
+static void test_wbmz_switchover(void)
+{
+    LOG_INFO("Testing WBMZ switchover events");
+
+    power_journal_init();
+    power_journal_do_periodic_work();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, read_journal().count, "No event without switchover");
+
+    utest_wbmz_set_powered_from_wbmz(true);
+    power_journal_do_periodic_work();
+    utest_wbmz_set_powered_from_wbmz(false);
+    power_journal_do_periodic_work();
+
+    struct REGMAP_PWR_JOURNAL j = read_journal();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, j.count, "Two switchover events expected");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_WBMZ_OFF, j.entry[0].event, "Wrong newest event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(POWER_JOURNAL_WBMZ_ON, j.entry[1].event, "Wrong previous event");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_journal);
+    RUN_TEST(test_event_with_rtc_time);
+    RUN_TEST(test_journal_keeps_latest_events);
+    RUN_TEST(test_journal_window);
+    RUN_TEST(test_journal_save_retry);
+    RUN_TEST(test_wbmz_switchover);
+
+    return UNITY_END();
+}
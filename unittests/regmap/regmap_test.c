@@ -480,6 +480,38 @@ int main(void)
         free(read_vals);
     }
 
+    // TEST: Проверка записи в регион с выставлением флагов изменения
+    printf("Testing regmap_set_region_data_as_changed...\n");
+    for (int r = 0; r < REGMAP_REGION_COUNT; r++) {
+        size_t r_size = region_size(r);
+        uint16_t * data_to_write = malloc(r_size);
+        uint16_t * data_to_read = malloc(r_size);
+        memset(data_to_write, 0x5A, r_size);
+
+        bool ret = regmap_set_region_data_as_changed(r, data_to_write, r_size);
+        if (ret != is_region_rw(r)) {
+            printf("ERROR: regmap_set_region_data_as_changed returned %d for region %d\n", ret, r);
+            return -EBADMSG;
+        }
+
+        if (is_region_rw(r)) {
+            // Данные читаются без сброса флага изменения
+            memset(data_to_read, 0, r_size);
+            if (!regmap_get_region_data(r, data_to_read, r_size) || memcmp(data_to_read, data_to_write, r_size)) {
+                printf("ERROR: regmap_get_region_data returned wrong data for region %d\n", r);
+                return -EBADMSG;
+            }
+            memset(data_to_read, 0, r_size);
+            if (!regmap_get_data_if_region_changed(r, data_to_read, r_size) || memcmp(data_to_read, data_to_write, r_size)) {
+                printf("ERROR: region %d is not marked as changed\n", r);
+                return -EBADMSG;
+            }
+        }
+
+        free(data_to_write);
+        free(data_to_read);
+    }
+
     printf("All tests passed!\n\n");
     return 0;
 }
@@ -0,0 +1,183 @@
+#include "unity.h"
+#include "scheduler.h"
+#include "systick.h"
+#include "utest_systick.h"
+#include "utest_wbmcu_system.h"
+#include "array_size.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+static unsigned every_wakeup_runs;
+static unsigned periodic_runs;
+static unsigned adc_event_runs;
+static uint32_t adc_event_task_time_us;
+
+static void every_wakeup_task(void)
+{
+    every_wakeup_runs++;
+}
+
+static void periodic_task(void)
+{
+    periodic_runs++;
+}
+
+static void adc_event_task(void)
+{
+    adc_event_runs++;
+    utest_systick_advance_time_us(adc_event_task_time_us);
+}
+
+static const struct scheduler_task tasks[] = {
+    { every_wakeup_task,    0,      0 },
+    { periodic_task,        10,     0 },
+    { adc_event_task,       100,    SCHEDULER_EVENT_MASK(SCHEDULER_EVENT_ADC) },
+};
+
+void setUp(void)
+{
+    utest_systick_set_time_ms(1000);
+    utest_wfi_reset();
+
+    every_wakeup_runs = 0;
+    periodic_runs = 0;
+    adc_event_runs = 0;
+    adc_event_task_time_us = 0;
+
+    scheduler_init(tasks, ARRAY_SIZE(tasks));
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Первый проход планировщика после инициализации
+// Ожидается: выполняются все задачи независимо от периода
+static void test_first_pass_runs_all_tasks(void)
+{
+    LOG_INFO("Testing first pass runs all tasks");
+
+    scheduler_run_pass();
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, every_wakeup_runs, "Task with period 0 should run");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, periodic_runs, "Periodic task should run on first pass");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, adc_event_runs, "Event task should run on first pass");
+}
+
+// Сценарий: Несколько проходов с шагом времени 1 мс
+// Ожидается: задача с периодом 0 выполняется на каждом проходе, периодическая - раз в свой период
+static void test_periodic_tasks(void)
+{
+    LOG_INFO("Testing task periods");
+
+    scheduler_run_pass();
+
+    for (int i = 0; i < 9; i++) {
+        utest_systick_advance_time_ms(1);
+        scheduler_run_pass();
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(10, every_wakeup_runs, "Task with period 0 should run on every pass");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, periodic_runs, "Periodic task should not run before period expires");
+
+    utest_systick_advance_time_ms(1);
+    scheduler_run_pass();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, periodic_runs, "Periodic task should run when period expires");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, adc_event_runs, "Event task should wait for its period or event");
+}
+
+// Сценарий: Выставление события между проходами
+// Ожидается: подписанная задача выполняется на ближайшем проходе один раз, событие сбрасывается
+static void test_event_runs_task(void)
+{
+    LOG_INFO("Testing event-driven task");
+
+    scheduler_run_pass();
+
+    scheduler_set_event(SCHEDULER_EVENT_REGMAP);
+    scheduler_run_pass();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, adc_event_runs, "Task should not run on event it is not subscribed to");
+
+    scheduler_set_event(SCHEDULER_EVENT_ADC);
+    scheduler_run_pass();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, adc_event_runs, "Task should run on its event");
+
+    scheduler_run_pass();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, adc_event_runs, "Event should be consumed by pass");
+}
+
+// Сценарий: Засыпание после прохода
+// Ожидается: WFI вызывается только при отсутствии необработанных событий
+static void test_sleep_only_without_pending_events(void)
+{
+    LOG_INFO("Testing sleep with and without pending events");
+
+    scheduler_run_pass();
+    scheduler_sleep();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_wfi_get_count(), "Should sleep when no events are pending");
+
+    scheduler_set_event(SCHEDULER_EVENT_ADC);
+    scheduler_sleep();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, utest_wfi_get_count(), "Should not sleep with pending event");
+
+    scheduler_run_pass();
+    scheduler_sleep();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, utest_wfi_get_count(), "Should sleep after event is handled");
+}
+
+// Сценарий: Задача выполняется 300 мкс, затем 100 мкс, затем сброс статистики
+// Ожидается: последнее, максимальное и среднее время задачи обновляются, сброс обнуляет их
+static void test_task_perf(void)
+{
+    LOG_INFO("Testing task execution time profiling");
+
+    struct scheduler_task_perf perf;
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(ARRAY_SIZE(tasks), scheduler_get_tasks_count(), "Wrong tasks count");
+
+    adc_event_task_time_us = 300;
+    scheduler_run_pass();
+    scheduler_get_task_perf(2, &perf);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, perf.last_us, "Wrong last time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, perf.max_us, "Wrong max time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, perf.avg_us, "Average should start from first measurement");
+
+    scheduler_get_task_perf(0, &perf);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, perf.max_us, "Task without delay should take 0 us");
+
+    adc_event_task_time_us = 100;
+    scheduler_set_event(SCHEDULER_EVENT_ADC);
+    scheduler_run_pass();
+    scheduler_get_task_perf(2, &perf);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(100, perf.last_us, "Wrong last time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, perf.max_us, "Max time should be kept");
+    // 300 - 300 / 16 + 100 / 16
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(287, perf.avg_us, "Wrong average time");
+
+    struct scheduler_loop_perf loop;
+    scheduler_get_loop_perf(&loop);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(100, loop.loop_time_us, "Wrong loop time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, loop.loop_time_max_us, "Wrong max loop time");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(300, loop.loop_period_us, "Wrong loop period");
+
+    scheduler_reset_perf();
+    scheduler_get_task_perf(2, &perf);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, perf.max_us, "Max time should be reset");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, perf.avg_us, "Average time should be reset");
+
+    scheduler_get_task_perf(ARRAY_SIZE(tasks), &perf);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, perf.last_us, "Task out of range should return zeros");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_pass_runs_all_tasks);
+    RUN_TEST(test_periodic_tasks);
+    RUN_TEST(test_event_runs_task);
+    RUN_TEST(test_sleep_only_without_pending_events);
+    RUN_TEST(test_task_perf);
+
+    return UNITY_END();
+}
@@ -1,6 +1,7 @@
 #include "unity.h"
 #include "temperature-control.h"
 #include "utest_ntc.h"
+#include "utest_adc.h"
 #include "utest_wbmz_common.h"
 #include "utest_voltage_monitor.h"
 #include "voltage-monitor.h"
@@ -10,6 +11,17 @@
 #define LOG_LEVEL LOG_LEVEL_INFO
 #include "console_log.h"
 
+// Температура кешируется по значению АЦП, поэтому вместе с температурой
+// меняем и значение на канале NTC
+static void set_temperature(fix16_t temp_celsius)
+{
+    static fix16_t ntc_raw = 0;
+
+    ntc_raw = fix16_add(ntc_raw, F16(1));
+    utest_adc_set_ch_raw(ADC_CHANNEL_ADC_NTC, ntc_raw);
+    utest_ntc_set_temperature(temp_celsius);
+}
+
 #if defined(EC_GPIO_HEATER)
 static const gpio_pin_t heater_pin = { EC_GPIO_HEATER };
 #endif
@@ -21,7 +33,7 @@ void setUp(void)
     utest_gpio_reset_instances();
 
     // Установка значений по умолчанию
-    utest_ntc_set_temperature(F16(25.0));  // 25°C
+    set_temperature(F16(25.0));  // 25°C
     utest_wbmz_set_powered_from_wbmz(false);
     vmon_init();
 }
@@ -72,7 +84,7 @@ static void test_temperature_is_ready_above_minimum(void)
     LOG_INFO("Testing temperature ready when above minimum");
 
     // Установка температуры выше минимума (WBEC_MINIMUM_WORKING_TEMPERATURE)
-    utest_ntc_set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE + 1.0));
+    set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE + 1.0));
 
     bool ready = temperature_control_is_temperature_ready();
     TEST_ASSERT_TRUE_MESSAGE(ready, "Temperature should be ready when above minimum working temperature");
@@ -85,7 +97,7 @@ static void test_temperature_is_not_ready_below_minimum(void)
     LOG_INFO("Testing temperature not ready when below minimum");
 
     // Установка температуры ниже минимума (WBEC_MINIMUM_WORKING_TEMPERATURE)
-    utest_ntc_set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE - 10.0));
+    set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE - 10.0));
 
     bool ready = temperature_control_is_temperature_ready();
     TEST_ASSERT_FALSE_MESSAGE(ready, "Temperature should not be ready when below minimum working temperature");
@@ -98,13 +110,13 @@ static void test_temperature_is_ready_at_minimum_threshold(void)
     LOG_INFO("Testing temperature ready at threshold");
 
     // Установка температуры ровно на минимальном пороге
-    utest_ntc_set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE));
+    set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE));
 
     bool ready = temperature_control_is_temperature_ready();
     TEST_ASSERT_FALSE_MESSAGE(ready, "Temperature should not be ready at exact minimum threshold");
 
     // Чуть выше порога
-    utest_ntc_set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE + 1.0));
+    set_temperature(F16(WBEC_MINIMUM_WORKING_TEMPERATURE + 1.0));
 
     ready = temperature_control_is_temperature_ready();
     TEST_ASSERT_TRUE_MESSAGE(ready, "Temperature should be ready above minimum threshold");
@@ -116,7 +128,7 @@ static void test_get_temperature_positive(void)
 {
     LOG_INFO("Testing get temperature - positive values");
 
-    utest_ntc_set_temperature(F16(25.5));
+    set_temperature(F16(25.5));
 
     int16_t temp_x100 = temperature_control_get_temperature_c_x100();
     TEST_ASSERT_EQUAL_INT16_MESSAGE(2550, temp_x100, "Temperature x100 should be 2550 for 25.5°C");
@@ -128,19 +140,38 @@ static void test_get_temperature_negative(void)
 {
     LOG_INFO("Testing get temperature - negative values");
 
-    utest_ntc_set_temperature(F16(-15.5));
+    set_temperature(F16(-15.5));
 
     int16_t temp_x100 = temperature_control_get_temperature_c_x100();
     TEST_ASSERT_EQUAL_INT16_MESSAGE(-1550, temp_x100, "Temperature x100 should be -1550 for -15.5°C");
 }
 
+// Сценарий: Повторное чтение температуры без нового значения АЦП
+// Ожидается: возвращается закешированная температура, пересчёт происходит только после изменения АЦП
+static void test_get_temperature_cached_until_adc_changes(void)
+{
+    LOG_INFO("Testing temperature is cached until ADC value changes");
+
+    set_temperature(F16(20.0));
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(2000, temperature_control_get_temperature_c_x100(), "Temperature x100 should be 2000 for 20.0°C");
+
+    // Значение АЦП не изменилось - температура не пересчитывается
+    utest_ntc_set_temperature(F16(30.0));
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(2000, temperature_control_get_temperature_c_x100(),
+                                    "Temperature should be cached while ADC value is the same");
+
+    set_temperature(F16(30.0));
+    TEST_ASSERT_EQUAL_INT16_MESSAGE(3000, temperature_control_get_temperature_c_x100(),
+                                    "Temperature should be updated after ADC value change");
+}
+
 // Сценарий: Получение температуры ровно при 0°C
 // Ожидается: Возвращается 0
 static void test_get_temperature_zero(void)
 {
     LOG_INFO("Testing get temperature - zero");
 
-    utest_ntc_set_temperature(F16(0.0));
+    set_temperature(F16(0.0));
 
     int16_t temp_x100 = temperature_control_get_temperature_c_x100();
     TEST_ASSERT_EQUAL_INT16_MESSAGE(0, temp_x100, "Temperature x100 should be 0 for 0.0°C");
@@ -157,7 +188,7 @@ static void test_heater_turns_on_at_low_temperature(void)
     temperature_control_init();
 
     // Установка температуры ниже порога включения нагревателя (EC_HEATER_ON_TEMP)
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
 
     // Установка питания от Vin (для нагревателя требуется наличие Vin)
     utest_wbmz_set_powered_from_wbmz(false);
@@ -179,7 +210,7 @@ static void test_heater_turns_off_at_high_temperature(void)
     temperature_control_init();
 
     // Сначала включаем нагреватель
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     utest_wbmz_set_powered_from_wbmz(false);
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
     temperature_control_do_periodic_work();
@@ -189,7 +220,7 @@ static void test_heater_turns_off_at_high_temperature(void)
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, state, "Heater should be on initially");
 
     // Затем устанавливаем температуру выше порога выключения (EC_HEATER_OFF_TEMP)
-    utest_ntc_set_temperature(F16(EC_HEATER_OFF_TEMP + 1.0));
+    set_temperature(F16(EC_HEATER_OFF_TEMP + 1.0));
     temperature_control_do_periodic_work();
 
     // Проверка, что GPIO нагревателя в LOW (выключен)
@@ -206,7 +237,7 @@ static void test_heater_stays_off_when_powered_from_wbmz(void)
     temperature_control_init();
 
     // Установка низкой температуры
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
 
     // Установка питания от WBMZ (нагреватель не должен включиться)
     utest_wbmz_set_powered_from_wbmz(true);
@@ -228,7 +259,7 @@ static void test_heater_stays_off_when_vin_not_present(void)
     temperature_control_init();
 
     // Установка низкой температуры
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
 
     // Отключим Vin (нагреватель не должен включиться)
     utest_wbmz_set_powered_from_wbmz(false);
@@ -255,34 +286,34 @@ static void test_heater_hysteresis(void)
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
 
     // Начинаем с низкой температуры: нагреватель должен включиться
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     temperature_control_do_periodic_work();
     uint32_t state = utest_gpio_get_output_state(heater_pin);
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, state, "Heater should turn ON below ON threshold");
 
     // Температура растет, но все еще ниже порога OFF
-    utest_ntc_set_temperature(F16((EC_HEATER_ON_TEMP + EC_HEATER_OFF_TEMP) / 2.0));
+    set_temperature(F16((EC_HEATER_ON_TEMP + EC_HEATER_OFF_TEMP) / 2.0));
     temperature_control_do_periodic_work();
     // Нагреватель должен оставаться включенным (выше ON, ниже OFF)
     state = utest_gpio_get_output_state(heater_pin);
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, state, "Heater should stay ON inside hysteresis band");
 
     // Температура поднимается выше порога OFF
-    utest_ntc_set_temperature(F16(EC_HEATER_OFF_TEMP + 1.0));
+    set_temperature(F16(EC_HEATER_OFF_TEMP + 1.0));
     temperature_control_do_periodic_work();
     // Нагреватель должен выключиться
     state = utest_gpio_get_output_state(heater_pin);
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, state, "Heater should turn OFF above OFF threshold");
 
     // Температура падает, но все еще выше порога ON
-    utest_ntc_set_temperature(F16((EC_HEATER_ON_TEMP + EC_HEATER_OFF_TEMP) / 2.0));
+    set_temperature(F16((EC_HEATER_ON_TEMP + EC_HEATER_OFF_TEMP) / 2.0));
     temperature_control_do_periodic_work();
     // Нагреватель должен оставаться выключенным (ниже OFF, выше ON)
     state = utest_gpio_get_output_state(heater_pin);
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, state, "Heater should stay OFF inside hysteresis band");
 
     // Температура падает ниже порога ON
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     temperature_control_do_periodic_work();
     // Нагреватель должен снова включиться
     state = utest_gpio_get_output_state(heater_pin);
@@ -298,7 +329,7 @@ static void test_heater_turns_off_when_wbmz_power_enabled_during_heating(void)
     temperature_control_init();
 
     // Установка низкой температуры и корректных условий питания для включения нагревателя
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     utest_wbmz_set_powered_from_wbmz(false);
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
 
@@ -326,7 +357,7 @@ static void test_heater_turns_off_when_vin_lost_during_heating(void)
     temperature_control_init();
 
     // Установка низкой температуры и корректных условий питания для включения нагревателя
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     utest_wbmz_set_powered_from_wbmz(false);
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
 
@@ -354,7 +385,7 @@ static void test_heater_force_control_enable(void)
     temperature_control_init();
 
     // Установка высокой температуры (обычно нагреватель должен быть выключен при этом)
-    utest_ntc_set_temperature(F16(25.0));
+    set_temperature(F16(25.0));
     utest_wbmz_set_powered_from_wbmz(false);
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
 
@@ -378,7 +409,7 @@ static void test_heater_force_control_disable(void)
     temperature_control_init();
 
     // Сначала принудительно включаем нагреватель
-    utest_ntc_set_temperature(F16(25.0));
+    set_temperature(F16(25.0));
     utest_wbmz_set_powered_from_wbmz(false);
     utest_vmon_set_ch_status(VMON_CHANNEL_V_IN, true);
     temperature_control_heater_force_control(true);
@@ -392,7 +423,7 @@ static void test_heater_force_control_disable(void)
     TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, state, "Heater should turn OFF after force mode is disabled at high temperature");
 
     // Установка низкой температуры
-    utest_ntc_set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
+    set_temperature(F16(EC_HEATER_ON_TEMP - 1.0));
     temperature_control_do_periodic_work();
     // Теперь нагреватель должен управляться температурой
     state = utest_gpio_get_output_state(heater_pin);
@@ -411,6 +442,7 @@ int main(void)
     RUN_TEST(test_temperature_is_ready_at_minimum_threshold);
     RUN_TEST(test_get_temperature_positive);
     RUN_TEST(test_get_temperature_negative);
+    RUN_TEST(test_get_temperature_cached_until_adc_changes);
     RUN_TEST(test_get_temperature_zero);
 
 #if defined(EC_GPIO_HEATER)
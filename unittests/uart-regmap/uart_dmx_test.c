@@ -0,0 +1,205 @@
+#include "unity.h"
+#include "uart-regmap.h"
+#include "regmap-structs.h"
+#include "utest_systick.h"
+#include "utest_regmap.h"
+#include "utest_wbmcu_system.h"
+#include "rcc.h"
+#include <string.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+static struct uart_ctx ctx;
+
+static const struct uart_descr u = {
+    .ctx = &ctx,
+    .uart = USART1,
+    .irq_num = USART1_IRQn,
+    .ctrl_region = REGMAP_REGION_UART_CTRL_MOD1,
+    .start_tx_region = REGMAP_REGION_UART_TX_START_MOD1,
+    .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD1,
+    .dmx_region = REGMAP_REGION_UART_DMX_MOD1,
+    .onewire_region = REGMAP_REGION_UART_ONEWIRE_MOD1,
+    .stats_region = REGMAP_REGION_UART_STATS_MOD1,
+    .mod = MOD1,
+};
+
+// Линукс записывает UART_CTRL в режиме DMX
+static void set_dmx_ctrl(uint16_t channels_count, uint16_t refresh_hz)
+{
+    struct uart_ctrl ctrl = {
+        .enable = 1,
+        .mode = UART_MODE_DMX,
+        .baud_x100 = 1152,
+        .dmx_channels_count = channels_count,
+        .dmx_refresh_hz = refresh_hz,
+    };
+    uart_regmap_process_ctrl(&u, &ctrl);
+}
+
+// Линукс записывает окно каналов, заполненное значением value
+static void write_window(uint16_t first_channel, uint16_t channels_count, uint8_t value)
+{
+    struct uart_dmx_window w = {
+        .first_channel = first_channel,
+        .channels_count = channels_count,
+    };
+    memset(w.data, value, sizeof(w.data));
+    uart_dmx_process_window(&u, &w);
+}
+
+static unsigned count_channels_with_value(uint8_t value)
+{
+    unsigned n = 0;
+    for (unsigned i = 0; i < UART_DMX_UNIVERSE_SIZE; i++) {
+        if (ctx.circ_buf_tx.data[i] == value) {
+            n++;
+        }
+    }
+    return n;
+}
+
+// Прерывание USART с флагами isr
+static void usart_irq(uint32_t isr)
+{
+    USART1->ISR = isr;
+    uart_regmap_process_irq(&u);
+    USART1->ISR = 0;
+}
+
+static bool txe_irq_enabled(void)
+{
+    return USART1->CR1 & USART_CR1_TXEIE_TXFNFIE;
+}
+
+void setUp(void)
+{
+    utest_systick_set_time_ms(1000);
+    utest_regmap_reset();
+    utest_usart_reset();
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ctrl.dmx_channels_count = UART_DMX_UNIVERSE_SIZE;
+    ctx.ctrl.dmx_refresh_hz = 44;
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Окна каналов, выходящие за пределы universe или больше UART_DMX_WINDOW_SIZE
+// Ожидается: записываются только каналы внутри universe и не больше 64 за раз, окно за пределами игнорируется
+static void test_window_clamping(void)
+{
+    LOG_INFO("Testing DMX window clamping");
+
+    set_dmx_ctrl(UART_DMX_UNIVERSE_SIZE, 44);
+
+    write_window(0, 100, 0x11);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_WINDOW_SIZE, count_channels_with_value(0x11), "Window should be limited to 64 channels");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x11, ctx.circ_buf_tx.data[UART_DMX_WINDOW_SIZE - 1], "Last channel of window should be written");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x00, ctx.circ_buf_tx.data[UART_DMX_WINDOW_SIZE], "Channel after window must not be written");
+
+    write_window(UART_DMX_UNIVERSE_SIZE - 12, UART_DMX_WINDOW_SIZE, 0x22);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(12, count_channels_with_value(0x22), "Window should be clamped to universe end");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x22, ctx.circ_buf_tx.data[UART_DMX_UNIVERSE_SIZE - 1], "Last universe channel should be written");
+    for (unsigned i = 0; i < sizeof(ctx.circ_buf_tx.bit8); i++) {
+        TEST_ASSERT_EQUAL_HEX8_MESSAGE(0, ctx.circ_buf_tx.bit8[i], "Data after universe must not be touched");
+    }
+
+    write_window(UART_DMX_UNIVERSE_SIZE, UART_DMX_WINDOW_SIZE, 0x33);
+    write_window(0xFFFF, UART_DMX_WINDOW_SIZE, 0x33);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, count_channels_with_value(0x33), "Window beyond universe should be ignored");
+}
+
+// Сценарий: Линукс записывает dmx_channels_count и dmx_refresh_hz на границах допустимых значений и за ними
+// Ожидается: значения 1..512 и 1..44 принимаются, остальные игнорируются и остаются прежние
+static void test_ctrl_limits(void)
+{
+    LOG_INFO("Testing DMX channels count and refresh rate limits");
+
+    set_dmx_ctrl(100, 30);
+    TEST_ASSERT_EQUAL_UINT16(100, ctx.ctrl.dmx_channels_count);
+    TEST_ASSERT_EQUAL_UINT16(30, ctx.ctrl.dmx_refresh_hz);
+
+    set_dmx_ctrl(0, 0);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(100, ctx.ctrl.dmx_channels_count, "0 channels should be ignored");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(30, ctx.ctrl.dmx_refresh_hz, "0 Hz should be ignored");
+
+    set_dmx_ctrl(UART_DMX_UNIVERSE_SIZE + 1, 45);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(100, ctx.ctrl.dmx_channels_count, "More than 512 channels should be ignored");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(30, ctx.ctrl.dmx_refresh_hz, "More than 44 Hz should be ignored");
+
+    set_dmx_ctrl(1, 1);
+    TEST_ASSERT_EQUAL_UINT16(1, ctx.ctrl.dmx_channels_count);
+    TEST_ASSERT_EQUAL_UINT16(1, ctx.ctrl.dmx_refresh_hz);
+
+    set_dmx_ctrl(UART_DMX_UNIVERSE_SIZE, 44);
+    TEST_ASSERT_EQUAL_UINT16(UART_DMX_UNIVERSE_SIZE, ctx.ctrl.dmx_channels_count);
+    TEST_ASSERT_EQUAL_UINT16(44, ctx.ctrl.dmx_refresh_hz);
+}
+
+// Сценарий: Передача кадра из 3 каналов с частотой 44 Гц
+// Ожидается: BREAK на 57600 бод, по TC - переход на 250000 бод и передача стартового кода и каналов по TXE,
+// после последнего канала TXE выключается, по TC кадр завершается; следующий кадр - через 1000/44 мс
+static void test_frame_sequence(void)
+{
+    LOG_INFO("Testing DMX frame sequence");
+
+    set_dmx_ctrl(3, 44);
+    struct uart_dmx_window w = { .first_channel = 0, .channels_count = 3, .data = { 10, 20, 30 } };
+    uart_dmx_process_window(&u, &w);
+
+    USART1->TDR = 0xFF;
+    uart_dmx_do_periodic_work(&u);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_BREAK, ctx.dmx.state, "First frame should start at once");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(SystemCoreClock / 57600, USART1->BRR, "BREAK should be sent at 57600 baud");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x00, USART1->TDR, "BREAK is 0x00");
+    TEST_ASSERT_FALSE(txe_irq_enabled());
+
+    // пока кадр передаётся, новый не начинается
+    utest_systick_advance_time_ms(1);
+    uart_dmx_do_periodic_work(&u);
+    TEST_ASSERT_EQUAL_UINT32(UART_DMX_STATE_BREAK, ctx.dmx.state);
+
+    usart_irq(USART_ISR_TC);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_DATA, ctx.dmx.state, "Data should follow BREAK");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(SystemCoreClock / 250000, USART1->BRR, "Data should be sent at 250000 baud");
+    TEST_ASSERT_TRUE_MESSAGE(txe_irq_enabled(), "TXE IRQ should be enabled for data");
+
+    const uint8_t expected[] = { 0x00, 10, 20, 30 };
+    for (unsigned i = 0; i < sizeof(expected); i++) {
+        TEST_ASSERT_EQUAL_UINT32(UART_DMX_STATE_DATA, ctx.dmx.state);
+        usart_irq(USART_ISR_TXE_TXFNF);
+        TEST_ASSERT_EQUAL_HEX8_MESSAGE(expected[i], USART1->TDR, "Wrong slot value");
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_LAST_SLOT, ctx.dmx.state, "Last slot should be in progress");
+    TEST_ASSERT_FALSE_MESSAGE(txe_irq_enabled(), "TXE IRQ should be disabled after last slot");
+
+    // TXE без разрешённого прерывания ничего не передаёт
+    USART1->TDR = 0xFF;
+    usart_irq(USART_ISR_TXE_TXFNF);
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0xFF, USART1->TDR, "Nothing should be sent after last slot");
+
+    usart_irq(USART_ISR_TC);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_IDLE, ctx.dmx.state, "Frame should be finished");
+
+    // кадры начинаются не чаще, чем раз в 1000 / 44 мс от начала предыдущего
+    utest_systick_advance_time_ms(1000 / 44 - 2);
+    uart_dmx_do_periodic_work(&u);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_IDLE, ctx.dmx.state, "Next frame should wait for refresh period");
+    utest_systick_advance_time_ms(1);
+    uart_dmx_do_periodic_work(&u);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_DMX_STATE_BREAK, ctx.dmx.state, "Next frame should start after refresh period");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_window_clamping);
+    RUN_TEST(test_ctrl_limits);
+    RUN_TEST(test_frame_sequence);
+
+    return UNITY_END();
+}
@@ -0,0 +1,382 @@
+#include "unity.h"
+#include "uart-regmap.h"
+#include "regmap-structs.h"
+#include "utest_systick.h"
+#include "utest_regmap.h"
+#include "utest_wbmcu_system.h"
+#include "rcc.h"
+#include <string.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+#define FAMILY_DS18S20          0x10
+#define FAMILY_DS18B20          0x28
+#define FAMILY_DS2401           0x01
+
+#define CMD_SEARCH_ROM          0xF0
+#define CMD_MATCH_ROM           0x55
+#define CMD_SKIP_ROM            0xCC
+#define CMD_READ_SCRATCHPAD     0xBE
+
+#define SIM_MAX_DEVICES         4
+
+static struct uart_ctx ctx;
+
+static const struct uart_descr u = {
+    .ctx = &ctx,
+    .uart = USART1,
+    .irq_num = USART1_IRQn,
+    .ctrl_region = REGMAP_REGION_UART_CTRL_MOD1,
+    .start_tx_region = REGMAP_REGION_UART_TX_START_MOD1,
+    .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD1,
+    .dmx_region = REGMAP_REGION_UART_DMX_MOD1,
+    .onewire_region = REGMAP_REGION_UART_ONEWIRE_MOD1,
+    .stats_region = REGMAP_REGION_UART_STATS_MOD1,
+    .mod = MOD1,
+};
+
+// Модель шины 1-Wire: устройства отвечают на тайм-слоты мастера, линия - монтажное И
+enum sim_state {
+    SIM_ROM_CMD,
+    SIM_MATCH_ROM,
+    SIM_SEARCH_ROM,
+    SIM_FUNC_CMD,
+    SIM_READ_SCRATCHPAD,
+    SIM_IGNORE,
+};
+
+struct sim_device {
+    uint8_t rom[8];
+    uint8_t scratchpad[9];
+    bool has_scratchpad;
+    bool selected;
+};
+
+static struct {
+    struct sim_device dev[SIM_MAX_DEVICES];
+    unsigned count;
+    enum sim_state state;
+    uint8_t cmd;
+    unsigned bit;
+} bus;
+
+// CRC-8 Dallas/Maxim, как в uart-regmap-onewire.c
+static uint8_t crc8(const uint8_t *data, unsigned len)
+{
+    uint8_t crc = 0;
+    for (unsigned i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        for (unsigned j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ b) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static inline bool get_bit(const uint8_t *data, unsigned bit)
+{
+    return data[bit / 8] & (1 << (bit % 8));
+}
+
+// Добавляет на шину устройство с серийным номером serial и температурой в формате scratchpad
+static struct sim_device * sim_add_device(uint8_t family, uint8_t serial, int16_t raw_temperature)
+{
+    struct sim_device *d = &bus.dev[bus.count++];
+
+    memset(d, 0, sizeof(*d));
+    d->rom[0] = family;
+    d->rom[1] = serial;
+    d->rom[6] = serial ^ 0x5A;
+    d->rom[7] = crc8(d->rom, 7);
+
+    d->has_scratchpad = (family != FAMILY_DS2401);
+    d->scratchpad[0] = raw_temperature & 0xFF;
+    d->scratchpad[1] = (uint16_t)raw_temperature >> 8;
+    d->scratchpad[4] = 0x7F;
+    d->scratchpad[8] = crc8(d->scratchpad, 8);
+    return d;
+}
+
+// Ответ шины на символ tx: возвращает символ, который примет USART
+static uint8_t sim_slot(uint8_t tx)
+{
+    if (USART1->BRR == SystemCoreClock / 9600) {
+        // reset: устройства отвечают presence pulse и ждут команду ROM
+        for (unsigned i = 0; i < bus.count; i++) {
+            bus.dev[i].selected = true;
+        }
+        bus.state = SIM_ROM_CMD;
+        bus.cmd = 0;
+        bus.bit = 0;
+        return bus.count ? 0xE0 : tx;
+    }
+
+    bool master_bit = (tx == 0xFF);
+    bool line = true;
+
+    switch (bus.state) {
+    case SIM_ROM_CMD:
+    case SIM_FUNC_CMD:
+        if (master_bit) {
+            bus.cmd |= 1 << bus.bit;
+        }
+        if (++bus.bit < 8) {
+            break;
+        }
+        bus.bit = 0;
+        if (bus.state == SIM_ROM_CMD) {
+            bus.state = (bus.cmd == CMD_SEARCH_ROM) ? SIM_SEARCH_ROM :
+                        (bus.cmd == CMD_MATCH_ROM) ? SIM_MATCH_ROM :
+                        (bus.cmd == CMD_SKIP_ROM) ? SIM_FUNC_CMD : SIM_IGNORE;
+        } else {
+            bus.state = (bus.cmd == CMD_READ_SCRATCHPAD) ? SIM_READ_SCRATCHPAD : SIM_IGNORE;
+        }
+        bus.cmd = 0;
+        break;
+
+    case SIM_MATCH_ROM:
+        for (unsigned i = 0; i < bus.count; i++) {
+            if (get_bit(bus.dev[i].rom, bus.bit) != master_bit) {
+                bus.dev[i].selected = false;
+            }
+        }
+        if (++bus.bit == 64) {
+            bus.bit = 0;
+            bus.state = SIM_FUNC_CMD;
+        }
+        break;
+
+    case SIM_SEARCH_ROM: {
+        // на каждый бит ROM три слота: бит, его дополнение и запись направления мастером
+        unsigned rom_bit = bus.bit / 3;
+        unsigned phase = bus.bit % 3;
+        for (unsigned i = 0; i < bus.count; i++) {
+            if (!bus.dev[i].selected) {
+                continue;
+            }
+            bool b = get_bit(bus.dev[i].rom, rom_bit);
+            if (phase == 0) {
+                line &= b;
+            } else if (phase == 1) {
+                line &= !b;
+            } else if (b != master_bit) {
+                bus.dev[i].selected = false;
+            }
+        }
+        bus.bit++;
+        break;
+    }
+
+    case SIM_READ_SCRATCHPAD:
+        for (unsigned i = 0; i < bus.count; i++) {
+            if (bus.dev[i].selected && bus.dev[i].has_scratchpad) {
+                line &= get_bit(bus.dev[i].scratchpad, bus.bit);
+            }
+        }
+        bus.bit++;
+        break;
+
+    default:
+        break;
+    }
+
+    // устройство может только притянуть линию к 0 во время слота мастера
+    return (master_bit && line) ? 0xFF : 0x00;
+}
+
+// Отвечает на все символы текущего задания так, как это делает USART в half-duplex
+static void sim_run_job(void)
+{
+    while (ctx.onewire.job_pos < ctx.onewire.job_len) {
+        USART1->RDR = sim_slot(USART1->TDR);
+        USART1->ISR = USART_ISR_RXNE_RXFNE;
+        uart_regmap_process_irq(&u);
+        USART1->ISR = 0;
+    }
+}
+
+// Linux записывает регион UART_ONEWIRE
+static void write_region(uint16_t cmd, uint16_t device_index)
+{
+    struct uart_onewire ow = {
+        .cmd = cmd,
+        .device_index = device_index,
+    };
+    uart_onewire_process_region(&u, &ow);
+}
+
+// Выполняет команду до конца, время идёт шагами по 10 мс между проходами основного цикла
+static void run_cmd(uint16_t cmd, uint16_t device_index)
+{
+    write_region(cmd, device_index);
+    for (unsigned i = 0; (i < 10000) && ctx.onewire.pub.busy; i++) {
+        sim_run_job();
+        uart_onewire_do_periodic_work(&u);
+        utest_systick_advance_time_ms(10);
+    }
+    TEST_ASSERT_FALSE_MESSAGE(ctx.onewire.pub.busy, "Command should be finished");
+}
+
+// Результаты для устройства device_index из кеша ЕС
+static struct uart_onewire read_device(uint16_t device_index)
+{
+    write_region(UART_ONEWIRE_CMD_NONE, device_index);
+    return ctx.onewire.pub;
+}
+
+static bool device_found(const struct sim_device *d)
+{
+    for (unsigned i = 0; i < ctx.onewire.pub.devices_count; i++) {
+        if (memcmp(read_device(i).rom, d->rom, sizeof(d->rom)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void setUp(void)
+{
+    utest_systick_set_time_ms(1000);
+    utest_regmap_reset();
+    utest_usart_reset();
+    memset(&bus, 0, sizeof(bus));
+    memset(&ctx, 0, sizeof(ctx));
+
+    struct uart_ctrl ctrl = {
+        .enable = 1,
+        .mode = UART_MODE_ONEWIRE,
+        .baud_x100 = 1152,
+        .dmx_channels_count = UART_DMX_UNIVERSE_SIZE,
+        .dmx_refresh_hz = 44,
+    };
+    uart_regmap_process_ctrl(&u, &ctrl);
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: На шине три устройства, ROM которых расходятся в разных битах, в том числе в коде семейства
+// Ожидается: SEARCH находит все три ROM без ошибок
+static void test_search_multiple_devices(void)
+{
+    LOG_INFO("Testing 1-Wire search of several devices");
+
+    const struct sim_device *d0 = sim_add_device(FAMILY_DS18B20, 0x01, 0);
+    const struct sim_device *d1 = sim_add_device(FAMILY_DS18B20, 0x81, 0);
+    const struct sim_device *d2 = sim_add_device(FAMILY_DS18S20, 0x01, 0);
+
+    run_cmd(UART_ONEWIRE_CMD_SEARCH, 0);
+
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.no_presence, "Presence expected");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.bus_error, "No bus error expected");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(3, ctx.onewire.pub.devices_count, "All devices should be found");
+    TEST_ASSERT_TRUE_MESSAGE(device_found(d0), "Device 0 not found");
+    TEST_ASSERT_TRUE_MESSAGE(device_found(d1), "Device 1 not found");
+    TEST_ASSERT_TRUE_MESSAGE(device_found(d2), "Device 2 not found");
+}
+
+// Сценарий: На шине нет устройств
+// Ожидается: SEARCH и CONVERT_ALL завершаются с no_presence, устройств нет
+static void test_no_presence(void)
+{
+    LOG_INFO("Testing 1-Wire bus without devices");
+
+    run_cmd(UART_ONEWIRE_CMD_SEARCH, 0);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, ctx.onewire.pub.no_presence, "No presence expected on search");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.bus_error, "No bus error expected");
+    TEST_ASSERT_EQUAL_UINT8(0, ctx.onewire.pub.devices_count);
+
+    run_cmd(UART_ONEWIRE_CMD_CONVERT_ALL, 0);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, ctx.onewire.pub.no_presence, "No presence expected on convert");
+}
+
+// Сценарий: У устройства на шине испорчен CRC в ROM
+// Ожидается: SEARCH завершается с bus_error, устройство не добавляется
+static void test_search_rom_crc_error(void)
+{
+    LOG_INFO("Testing 1-Wire search with ROM CRC error");
+
+    struct sim_device *d = sim_add_device(FAMILY_DS18B20, 0x10, 0);
+    d->rom[7] ^= 0x01;
+
+    run_cmd(UART_ONEWIRE_CMD_SEARCH, 0);
+
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, ctx.onewire.pub.bus_error, "Bus error expected");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.devices_count, "Device with bad ROM must not be added");
+}
+
+// Сценарий: Датчик найден, затем его scratchpad приходит с неверным CRC
+// Ожидается: READ_SCRATCHPAD и CONVERT_ALL завершаются с bus_error, температура недействительна
+static void test_scratchpad_crc_error(void)
+{
+    LOG_INFO("Testing 1-Wire scratchpad CRC error");
+
+    struct sim_device *d = sim_add_device(FAMILY_DS18B20, 0x20, 25 * 16);
+    run_cmd(UART_ONEWIRE_CMD_SEARCH, 0);
+    TEST_ASSERT_EQUAL_UINT8(1, ctx.onewire.pub.devices_count);
+
+    d->scratchpad[8] ^= 0xFF;
+
+    run_cmd(UART_ONEWIRE_CMD_READ_SCRATCHPAD, 0);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, ctx.onewire.pub.bus_error, "Bus error expected on read scratchpad");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(d->scratchpad[8], ctx.onewire.pub.scratchpad[8], "Scratchpad should be published as read");
+
+    run_cmd(UART_ONEWIRE_CMD_CONVERT_ALL, 0);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, ctx.onewire.pub.bus_error, "Bus error expected on convert");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, read_device(0).temperature_valid, "Temperature must not be valid");
+}
+
+// Сценарий: На шине датчики DS18B20 и DS18S20 и устройство другого семейства (DS2401 без scratchpad)
+// Ожидается: CONVERT_ALL читает только датчики, без bus_error; у DS2401 температура недействительна
+static void test_convert_skips_non_thermometers(void)
+{
+    LOG_INFO("Testing 1-Wire convert with non-thermometer device on bus");
+
+    sim_add_device(FAMILY_DS18B20, 0x30, -10 * 16 - 8);
+    sim_add_device(FAMILY_DS2401, 0x31, 0);
+    sim_add_device(FAMILY_DS18S20, 0x32, 2 * 21);
+    run_cmd(UART_ONEWIRE_CMD_SEARCH, 0);
+    TEST_ASSERT_EQUAL_UINT8(3, ctx.onewire.pub.devices_count);
+
+    run_cmd(UART_ONEWIRE_CMD_CONVERT_ALL, 0);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.no_presence, "Presence expected");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, ctx.onewire.pub.bus_error, "Non-thermometer device must not cause bus error");
+
+    for (unsigned i = 0; i < 3; i++) {
+        struct uart_onewire d = read_device(i);
+        switch (d.rom[0]) {
+        case FAMILY_DS18B20:
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, d.temperature_valid, "DS18B20 temperature should be valid");
+            TEST_ASSERT_EQUAL_INT16_MESSAGE(-10 * 16 - 8, d.temperature, "Wrong DS18B20 temperature");
+            break;
+        case FAMILY_DS18S20:
+            // DS18S20: 0.5 °C на единицу, приводится к 1/16 °C
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, d.temperature_valid, "DS18S20 temperature should be valid");
+            TEST_ASSERT_EQUAL_INT16_MESSAGE(21 * 16, d.temperature, "Wrong DS18S20 temperature");
+            break;
+        default:
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, d.temperature_valid, "Non-thermometer must not have temperature");
+            break;
+        }
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_search_multiple_devices);
+    RUN_TEST(test_no_presence);
+    RUN_TEST(test_search_rom_crc_error);
+    RUN_TEST(test_scratchpad_crc_error);
+    RUN_TEST(test_convert_skips_non_thermometers);
+
+    return UNITY_END();
+}
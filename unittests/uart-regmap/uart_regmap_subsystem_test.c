@@ -0,0 +1,106 @@
+#include "unity.h"
+#include "uart-regmap-subsystem.h"
+#include "uart-regmap-types.h"
+#include "regmap-structs.h"
+#include "config.h"
+#include "utest_systick.h"
+#include "utest_regmap.h"
+#include "utest_gpio.h"
+#include "utest_wbmcu_system.h"
+#include <string.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+static const gpio_pin_t irq_gpio = { EC_GPIO_UART_INT };
+
+static bool irq_gpio_is_active(void)
+{
+    return utest_gpio_get_output_state(irq_gpio);
+}
+
+// Линукс включает порт MOD1 в режиме UART
+static void linux_enable_mod1(void)
+{
+    struct uart_ctrl ctrl = {
+        .enable = 1,
+        .mode = UART_MODE_UART,
+        .baud_x100 = 1152,
+        .dmx_channels_count = UART_DMX_UNIVERSE_SIZE,
+        .dmx_refresh_hz = 44,
+    };
+    regmap_set_region_data_as_changed(REGMAP_REGION_UART_CTRL_MOD1, &ctrl, sizeof(ctrl));
+}
+
+// Линукс запрашивает передачу на MOD1
+static void linux_start_tx_mod1(void)
+{
+    struct uart_start_tx start_tx = { .want_to_tx = 1 };
+    regmap_set_region_data_as_changed(REGMAP_REGION_UART_TX_START_MOD1, &start_tx, sizeof(start_tx));
+}
+
+// Линукс по прерыванию выполняет обмен для всех портов без данных на передачу
+static void linux_exchange(void)
+{
+    union uart_exchange e;
+    memset(&e, 0, sizeof(e));
+    regmap_set_region_data_as_changed(REGMAP_REGION_UART_EXCHANGE_MOD1, &e, sizeof(e));
+    regmap_set_region_data_as_changed(REGMAP_REGION_UART_EXCHANGE_MOD2, &e, sizeof(e));
+}
+
+void setUp(void)
+{
+    utest_systick_set_time_ms(1000);
+    utest_regmap_reset();
+    utest_usart_reset();
+    utest_gpio_reset_instances();
+
+    uart_regmap_subsystem_init();
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Линукс выполняет обмен по прерыванию, сразу после этого приходит новый запрос на передачу,
+// проходы основного цикла следуют друг за другом без задержки
+// Ожидается: линия прерывания снова устанавливается только через 200 мкс после сброса
+static void test_irq_gpio_min_inactive_time(void)
+{
+    LOG_INFO("Testing minimum inactive time of UART IRQ line");
+
+    linux_enable_mod1();
+    uart_regmap_subsystem_do_periodic_work();
+    TEST_ASSERT_FALSE(irq_gpio_is_active());
+
+    linux_start_tx_mod1();
+    utest_systick_advance_time_ms(1);
+    uart_regmap_subsystem_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(irq_gpio_is_active(), "IRQ line should be set on TX request");
+
+    linux_exchange();
+    utest_systick_advance_time_us(50);
+    uart_regmap_subsystem_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(irq_gpio_is_active(), "IRQ line should be reset after exchange");
+
+    // новый запрос на передачу сразу после обмена
+    linux_start_tx_mod1();
+    for (int i = 0; i < 3; i++) {
+        utest_systick_advance_time_us(50);
+        uart_regmap_subsystem_do_periodic_work();
+        TEST_ASSERT_FALSE_MESSAGE(irq_gpio_is_active(), "IRQ line should stay inactive for at least 200 us");
+    }
+
+    utest_systick_advance_time_us(50);
+    uart_regmap_subsystem_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(irq_gpio_is_active(), "IRQ line should be set after 200 us");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_irq_gpio_min_inactive_time);
+
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+#include "unity.h"
+#include "uart-regmap.h"
+#include "regmap-structs.h"
+#include "utest_systick.h"
+#include "utest_regmap.h"
+#include "utest_wbmcu_system.h"
+#include <string.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "console_log.h"
+
+static struct uart_ctx ctx;
+
+static const struct uart_descr u = {
+    .ctx = &ctx,
+    .uart = USART1,
+    .irq_num = USART1_IRQn,
+    .ctrl_region = REGMAP_REGION_UART_CTRL_MOD1,
+    .start_tx_region = REGMAP_REGION_UART_TX_START_MOD1,
+    .exchange_region = REGMAP_REGION_UART_EXCHANGE_MOD1,
+    .dmx_region = REGMAP_REGION_UART_DMX_MOD1,
+    .onewire_region = REGMAP_REGION_UART_ONEWIRE_MOD1,
+    .stats_region = REGMAP_REGION_UART_STATS_MOD1,
+    .mod = MOD1,
+};
+
+// Включение порта в режиме UART 115200 8N1 так же, как это делает линукс через UART_CTRL
+static void enable_port_with_irq_hold(uint16_t irq_min_bytes, uint16_t irq_max_hold_ms)
+{
+    struct uart_ctrl ctrl = {
+        .enable = 1,
+        .mode = UART_MODE_UART,
+        .baud_x100 = 1152,
+        .irq_min_bytes = irq_min_bytes,
+        .irq_max_hold_ms = irq_max_hold_ms,
+        .dmx_channels_count = UART_DMX_UNIVERSE_SIZE,
+        .dmx_refresh_hz = 44,
+    };
+    uart_regmap_process_ctrl(&u, &ctrl);
+}
+
+static void enable_port(void)
+{
+    enable_port_with_irq_hold(0, 0);
+}
+
+// Приём байта: прерывание RXNE с заданными флагами ошибок
+static void receive_byte_with_flags(uint8_t byte, uint32_t isr_err_flags)
+{
+    USART1->RDR = byte;
+    USART1->ISR = USART_ISR_RXNE_RXFNE | isr_err_flags;
+    uart_regmap_process_irq(&u);
+    USART1->ISR = 0;
+}
+
+static void receive_byte(uint8_t byte)
+{
+    receive_byte_with_flags(byte, 0);
+}
+
+// Последний байт, помещённый в кольцевой буфер приёма
+static union uart_rx_byte_w_errors last_rx_byte(void)
+{
+    uint16_t pos = (uint16_t)(ctx.circ_buf_rx.i.head - 1) % UART_REGMAP_CIRC_BUFFER_SIZE;
+    return ctx.circ_buf_rx.data[pos];
+}
+
+void setUp(void)
+{
+    utest_systick_set_time_ms(1000);
+    utest_regmap_reset();
+    utest_usart_reset();
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ctrl.baud_x100 = 1152;
+    ctx.ctrl.mode = UART_MODE_UART;
+    ctx.ctrl.dmx_channels_count = UART_DMX_UNIVERSE_SIZE;
+    ctx.ctrl.dmx_refresh_hz = 44;
+    ctx.rx_data.ready_for_tx = 1;
+}
+
+void tearDown(void)
+{
+}
+
+// Сценарий: Кольцевой буфер приёма заполнен, подряд приходит несколько байт, которые в него не помещаются
+// Ожидается: счётчик переполнений увеличивается на 1 за всё событие, а не за каждый потерянный байт;
+// первый байт, поместившийся после переполнения, помечен ORE; новое переполнение считается отдельно
+static void test_rx_buf_overflow_counted_once_per_event(void)
+{
+    LOG_INFO("Testing RX circular buffer overflow counter");
+
+    enable_port();
+    TEST_ASSERT_TRUE_MESSAGE(utest_nvic_is_irq_enabled(USART1_IRQn), "USART IRQ should be enabled");
+
+    for (unsigned i = 0; i < UART_REGMAP_CIRC_BUFFER_SIZE; i++) {
+        receive_byte(i);
+    }
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, ctx.stats.rx_buf_overflows, "Buffer is full, but nothing is lost yet");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(UART_REGMAP_CIRC_BUFFER_SIZE, ctx.stats.rx_buf_peak, "Wrong buffer peak");
+
+    for (unsigned i = 0; i < 5; i++) {
+        receive_byte(0xA0 + i);
+    }
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, ctx.stats.rx_buf_overflows, "Several lost bytes in a row are one overflow event");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(UART_REGMAP_CIRC_BUFFER_SIZE + 5, ctx.stats.rx_bytes, "All received bytes should be counted");
+
+    // линукс забирает часть данных - в буфере появляется место
+    uart_regmap_collect_data_for_new_exchange(&u);
+    TEST_ASSERT_EQUAL_UINT8(UART_REGMAP_BUFFER_SIZE, ctx.rx_data.read_bytes_count);
+
+    receive_byte(0x55);
+    union uart_rx_byte_w_errors b = last_rx_byte();
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x55, b.byte, "Byte after overflow should be stored");
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(USART_ISR_ORE, b.err_flags, "Byte after overflow should be marked with ORE");
+
+    receive_byte(0x56);
+    b = last_rx_byte();
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(0, b.err_flags, "Only the first byte after overflow is marked with ORE");
+    TEST_ASSERT_EQUAL_UINT16(1, ctx.stats.rx_buf_overflows);
+
+    // буфер снова заполняется и переполняется - это новое событие
+    while (circ_buffer_get_available_space(&ctx.circ_buf_rx.i) > 0) {
+        receive_byte(0x11);
+    }
+    receive_byte(0x22);
+    receive_byte(0x33);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(2, ctx.stats.rx_buf_overflows, "New overflow after recovery should be counted");
+}
+
+// Сценарий: Включено объединение прерываний (8 байт или 10 мс), данные собраны в regmap,
+// после сбора в кольцевой буфер приходит ещё один байт
+// Ожидается: прерывание не выставляется до накопления порога или истечения времени удержания
+static void test_irq_hold_not_bypassed_by_late_byte(void)
+{
+    LOG_INFO("Testing IRQ coalescing with byte received after collect");
+
+    enable_port_with_irq_hold(8, 10);
+
+    receive_byte(0x01);
+    receive_byte(0x02);
+    uart_regmap_collect_data_for_new_exchange(&u);
+    TEST_ASSERT_EQUAL_UINT8(2, ctx.rx_data.read_bytes_count);
+    TEST_ASSERT_FALSE_MESSAGE(uart_regmap_is_irq_needed(&u), "IRQ should be held");
+
+    // байт принят между сбором данных и проверкой необходимости прерывания
+    receive_byte(0x03);
+    TEST_ASSERT_FALSE_MESSAGE(uart_regmap_is_irq_needed(&u), "Byte received after collect should not bypass IRQ hold");
+
+    // следующий сбор данных забирает его в regmap
+    utest_systick_advance_time_ms(5);
+    uart_regmap_collect_data_for_new_exchange(&u);
+    TEST_ASSERT_EQUAL_UINT8(3, ctx.rx_data.read_bytes_count);
+    TEST_ASSERT_FALSE_MESSAGE(uart_regmap_is_irq_needed(&u), "IRQ should be held until hold time elapsed");
+
+    utest_systick_advance_time_ms(5);
+    TEST_ASSERT_TRUE_MESSAGE(uart_regmap_is_irq_needed(&u), "IRQ should be set after hold time elapsed");
+}
+
+// Сценарий: Включено объединение прерываний, после байтов без ошибок принят байт с ошибкой чётности
+// Ожидается: байт с ошибкой не помещается в regmap в текущем формате, прерывание выставляется сразу
+static void test_irq_hold_expires_on_format_change(void)
+{
+    LOG_INFO("Testing IRQ coalescing with byte in error format");
+
+    enable_port_with_irq_hold(8, 10);
+
+    receive_byte(0x01);
+    receive_byte(0x02);
+    receive_byte_with_flags(0x03, USART_ISR_PE);
+    uart_regmap_collect_data_for_new_exchange(&u);
+
+    TEST_ASSERT_EQUAL_UINT8(2, ctx.rx_data.read_bytes_count);
+    TEST_ASSERT_EQUAL_UINT8(0, ctx.rx_data.data_format);
+    TEST_ASSERT_TRUE_MESSAGE(uart_regmap_is_irq_needed(&u), "IRQ should be set when next byte needs error format");
+}
+
+// Сценарий: Включено объединение прерываний с порогом больше, чем помещается в regmap в формате с ошибками
+// Ожидается: когда буфер regmap заполнен, прерывание выставляется без ожидания
+static void test_irq_hold_expires_on_full_regmap(void)
+{
+    LOG_INFO("Testing IRQ coalescing with full regmap buffer");
+
+    enable_port_with_irq_hold(UART_REGMAP_BUFFER_SIZE, 10);
+
+    for (unsigned i = 0; i < UART_REGMAP_BUFFER_SIZE / 2; i++) {
+        receive_byte_with_flags(i, USART_ISR_FE);
+    }
+    uart_regmap_collect_data_for_new_exchange(&u);
+
+    TEST_ASSERT_EQUAL_UINT8(1, ctx.rx_data.data_format);
+    TEST_ASSERT_EQUAL_UINT8(UART_REGMAP_BUFFER_SIZE / 2, ctx.rx_data.read_bytes_count);
+    TEST_ASSERT_TRUE_MESSAGE(uart_regmap_is_irq_needed(&u), "IRQ should be set when regmap buffer is full");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rx_buf_overflow_counted_once_per_event);
+    RUN_TEST(test_irq_hold_not_bypassed_by_late_byte);
+    RUN_TEST(test_irq_hold_expires_on_format_change);
+    RUN_TEST(test_irq_hold_expires_on_full_regmap);
+
+    return UNITY_END();
+}
@@ -0,0 +1,4 @@
+#include <stdint.h>
+
+// Частота ядра для расчёта BRR (в прошивке определяется в rcc.c)
+uint32_t SystemCoreClock = 64000000;
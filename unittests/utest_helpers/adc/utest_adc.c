@@ -5,6 +5,24 @@
 static int32_t adc_values_mv[ADC_CHANNEL_COUNT] = {0};
 static fix16_t adc_values_raw[ADC_CHANNEL_COUNT] = {0};
 static int16_t adc_offsets_mv[ADC_CHANNEL_COUNT] = {0};
+static uint16_t adc_lowpass_rc_ms[ADC_CHANNEL_COUNT] = {0};
+static uint8_t adc_median_window[ADC_CHANNEL_COUNT] = {0};
+static struct adc_stats adc_stats[ADC_STATS_CHANNEL_COUNT] = {};
+static unsigned adc_stats_take_count = 0;
+
+static struct {
+    adc_awd_handler_t handler;
+    bool armed[ADC_AWD_COUNT];
+    enum adc_channel channel[ADC_AWD_COUNT];
+} awd_state;
+
+static struct {
+    uint8_t states;
+    uint16_t rising_count[ADC_DIN_COUNT];
+    uint16_t falling_count[ADC_DIN_COUNT];
+    int32_t low_mv[ADC_DIN_COUNT];
+    int32_t high_mv[ADC_DIN_COUNT];
+} din_state;
 
 void utest_adc_set_ch_mv(enum adc_channel channel, int32_t mv)
 {
@@ -42,6 +60,164 @@ void adc_set_offset_mv(enum adc_channel channel, int16_t offset_mv)
 }
 
 void adc_init(enum adc_clock clock_divider, enum adc_vref vref) {}
-void adc_set_lowpass_rc(enum adc_channel channel, uint16_t rc_ms) {}
+
+// Ограничения значений - как в прошивке
+void adc_set_lowpass_rc(enum adc_channel channel, uint16_t rc_ms)
+{
+    if (rc_ms > ADC_LOWPASS_RC_MAX_MS) {
+        rc_ms = ADC_LOWPASS_RC_MAX_MS;
+    }
+    adc_lowpass_rc_ms[channel] = rc_ms;
+}
+
+uint16_t adc_get_lowpass_rc(enum adc_channel channel)
+{
+    return adc_lowpass_rc_ms[channel];
+}
+
+void adc_set_median_window(enum adc_channel channel, uint8_t n)
+{
+    if (n > ADC_MEDIAN_WINDOW_MAX) {
+        n = ADC_MEDIAN_WINDOW_MAX;
+    }
+    if (n < 3) {
+        n = 1;
+    } else if ((n & 1) == 0) {
+        n--;
+    }
+    adc_median_window[channel] = n;
+}
+
+uint8_t adc_get_median_window(enum adc_channel channel)
+{
+    return adc_median_window[channel];
+}
+
+void utest_adc_filter_reset(void)
+{
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ch++) {
+        adc_lowpass_rc_ms[ch] = 0;
+        adc_median_window[ch] = 1;
+    }
+}
+
 bool adc_get_ready(void) { return true; }
+int32_t adc_measure_once_mv(enum adc_channel channel) { return adc_values_mv[channel]; }
 void adc_do_periodic_work(void) {}
+
+void adc_awd_set_handler(adc_awd_handler_t handler)
+{
+    awd_state.handler = handler;
+}
+
+void adc_awd_setup(enum adc_awd awd, enum adc_channel channel, int32_t low_mv, int32_t high_mv)
+{
+    awd_state.channel[awd] = channel;
+    awd_state.armed[awd] = false;
+}
+
+void adc_awd_rearm(enum adc_awd awd)
+{
+    awd_state.armed[awd] = true;
+}
+
+void adc_awd_disarm(enum adc_awd awd)
+{
+    awd_state.armed[awd] = false;
+}
+
+void adc_capture_trigger(void) {}
+
+// Как и в прошивке, статистика забирается и накопление начинается заново
+void adc_stats_take(struct adc_stats stats[ADC_STATS_CHANNEL_COUNT])
+{
+    memcpy(stats, adc_stats, sizeof(adc_stats));
+    memset(adc_stats, 0, sizeof(adc_stats));
+    adc_stats_take_count++;
+}
+
+void utest_adc_stats_reset(void)
+{
+    memset(adc_stats, 0, sizeof(adc_stats));
+    adc_stats_take_count = 0;
+}
+
+void utest_adc_set_stats(enum adc_stats_channel c, int32_t min_mv, int32_t max_mv, int32_t avg_mv, uint16_t count)
+{
+    adc_stats[c].min_mv = min_mv;
+    adc_stats[c].max_mv = max_mv;
+    adc_stats[c].avg_mv = avg_mv;
+    adc_stats[c].count = count;
+}
+
+unsigned utest_adc_get_stats_take_count(void)
+{
+    return adc_stats_take_count;
+}
+
+bool utest_adc_awd_is_armed(enum adc_awd awd)
+{
+    return awd_state.armed[awd];
+}
+
+enum adc_channel utest_adc_awd_get_channel(enum adc_awd awd)
+{
+    return awd_state.channel[awd];
+}
+
+// Имитирует срабатывание watchdog: как и в прошивке, прерывание отключается до adc_awd_rearm()
+void utest_adc_awd_trigger(enum adc_awd awd)
+{
+    if (!awd_state.armed[awd]) {
+        return;
+    }
+    awd_state.armed[awd] = false;
+    if (awd_state.handler) {
+        awd_state.handler(awd);
+    }
+}
+
+void adc_din_set_thresholds(enum adc_din din, int32_t low_mv, int32_t high_mv)
+{
+    din_state.low_mv[din] = low_mv;
+    din_state.high_mv[din] = high_mv;
+}
+
+uint8_t adc_din_get_states(void)
+{
+    return din_state.states;
+}
+
+uint16_t adc_din_get_rising_count(enum adc_din din)
+{
+    return din_state.rising_count[din];
+}
+
+uint16_t adc_din_get_falling_count(enum adc_din din)
+{
+    return din_state.falling_count[din];
+}
+
+void utest_adc_din_reset(void)
+{
+    memset(&din_state, 0, sizeof(din_state));
+}
+
+// Имитирует переключение цифрового входа в АЦП: меняет состояние и счётчик фронтов
+void utest_adc_din_set_state(enum adc_din din, bool state)
+{
+    uint8_t mask = 1 << din;
+    if (state && !(din_state.states & mask)) {
+        din_state.states |= mask;
+        din_state.rising_count[din]++;
+    } else if (!state && (din_state.states & mask)) {
+        din_state.states &= ~mask;
+        din_state.falling_count[din]++;
+    }
+}
+
+void utest_adc_din_get_thresholds(enum adc_din din, int32_t *low_mv, int32_t *high_mv)
+{
+    *low_mv = din_state.low_mv[din];
+    *high_mv = din_state.high_mv[din];
+}
@@ -11,3 +11,33 @@ void utest_adc_set_ch_raw(enum adc_channel channel, fix16_t raw_value);
 
 // Получить последнее установленное смещение канала АЦП в мВ
 int16_t utest_adc_get_offset_mv(enum adc_channel channel);
+
+// Сброс настроек фильтров каналов: RC 0, медианный фильтр выключен
+void utest_adc_filter_reset(void);
+
+// Сброс накопленной статистики и счётчика вызовов adc_stats_take()
+void utest_adc_stats_reset(void);
+
+// Статистика канала, которую вернёт следующий adc_stats_take()
+void utest_adc_set_stats(enum adc_stats_channel c, int32_t min_mv, int32_t max_mv, int32_t avg_mv, uint16_t count);
+
+// Количество вызовов adc_stats_take()
+unsigned utest_adc_get_stats_take_count(void);
+
+// Взведён ли watchdog (вызван adc_awd_rearm() после настройки или срабатывания)
+bool utest_adc_awd_is_armed(enum adc_awd awd);
+
+// Канал АЦП, на который настроен watchdog
+enum adc_channel utest_adc_awd_get_channel(enum adc_awd awd);
+
+// Имитация срабатывания watchdog в прерывании АЦП
+void utest_adc_awd_trigger(enum adc_awd awd);
+
+// Сброс состояния цифровых входов
+void utest_adc_din_reset(void);
+
+// Переключение цифрового входа (с подсчётом фронта, как в АЦП)
+void utest_adc_din_set_state(enum adc_din din, bool state);
+
+// Последние пороги, установленные для цифрового входа
+void utest_adc_din_get_thresholds(enum adc_din din, int32_t *low_mv, int32_t *high_mv);
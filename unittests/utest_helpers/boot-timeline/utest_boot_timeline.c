@@ -0,0 +1,37 @@
+#include "utest_boot_timeline.h"
+#include <string.h>
+
+static struct {
+    bool marked[BOOT_MILESTONE_COUNT];
+} boot_timeline_state;
+
+void utest_boot_timeline_reset(void)
+{
+    memset(&boot_timeline_state, 0, sizeof(boot_timeline_state));
+}
+
+bool utest_boot_timeline_is_marked(enum boot_milestone m)
+{
+    if (m >= BOOT_MILESTONE_COUNT) {
+        return false;
+    }
+    return boot_timeline_state.marked[m];
+}
+
+// Мок-реализация boot-timeline API
+void boot_timeline_init(void)
+{
+
+}
+
+void boot_timeline_do_periodic_work(void)
+{
+
+}
+
+void boot_timeline_mark(enum boot_milestone m)
+{
+    if (m < BOOT_MILESTONE_COUNT) {
+        boot_timeline_state.marked[m] = true;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdbool.h>
+#include "boot-timeline.h"
+
+// Сбросить состояние мока
+void utest_boot_timeline_reset(void);
+
+// Был ли отмечен этап загрузки
+bool utest_boot_timeline_is_marked(enum boot_milestone m);
@@ -5,6 +5,11 @@ void console_print(const char str[])
     (void)str;
 }
 
+void console_print_buf(const char buf[], size_t size)
+{
+    (void)buf; (void)size;
+}
+
 void console_print_w_prefix(const char str[])
 {
     (void)str;
@@ -0,0 +1,65 @@
+#include "utest_event_log.h"
+#include <string.h>
+
+static struct {
+    uint32_t count[EVENT_LOG_ID_COUNT];
+    enum event_log_id last_id;
+    int16_t last_arg[2];
+} event_log_state;
+
+void utest_event_log_reset(void)
+{
+    memset(&event_log_state, 0, sizeof(event_log_state));
+    event_log_state.last_id = EVENT_LOG_ID_COUNT;
+}
+
+uint32_t utest_event_log_get_count(enum event_log_id id)
+{
+    if (id >= EVENT_LOG_ID_COUNT) {
+        return 0;
+    }
+    return event_log_state.count[id];
+}
+
+enum event_log_id utest_event_log_get_last(int16_t *arg0, int16_t *arg1)
+{
+    if (arg0) {
+        *arg0 = event_log_state.last_arg[0];
+    }
+    if (arg1) {
+        *arg1 = event_log_state.last_arg[1];
+    }
+    return event_log_state.last_id;
+}
+
+// Мок-реализация event-log API
+void event_log_init(void)
+{
+
+}
+
+void event_log_do_periodic_work(void)
+{
+
+}
+
+void event_log_put(enum event_log_id id, int16_t arg0, int16_t arg1)
+{
+    if (id >= EVENT_LOG_ID_COUNT) {
+        return;
+    }
+    event_log_state.count[id]++;
+    event_log_state.last_id = id;
+    event_log_state.last_arg[0] = arg0;
+    event_log_state.last_arg[1] = arg1;
+}
+
+void event_log_print_pending(void)
+{
+
+}
+
+void event_log_flush(void)
+{
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdint.h>
+#include "event-log.h"
+
+// Сбросить состояние мока
+void utest_event_log_reset(void);
+
+// Сколько раз было записано событие
+uint32_t utest_event_log_get_count(enum event_log_id id);
+
+// Последнее записанное событие и его аргументы
+enum event_log_id utest_event_log_get_last(int16_t *arg0, int16_t *arg1);
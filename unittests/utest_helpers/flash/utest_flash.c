@@ -0,0 +1,77 @@
+#include "utest_flash.h"
+#include <string.h>
+
+#define NO_BREAK        UINT16_MAX
+
+// Внутреннее состояние мока flash
+static struct {
+    uint8_t pages[FLASH_STORAGE_PAGES_COUNT][FLASH_STORAGE_PAGE_SIZE];
+    uint32_t erase_count[FLASH_STORAGE_PAGES_COUNT];
+    uint16_t break_after;
+} flash_state;
+
+void utest_flash_reset(void)
+{
+    memset(flash_state.pages, 0xFF, sizeof(flash_state.pages));
+    memset(flash_state.erase_count, 0, sizeof(flash_state.erase_count));
+    flash_state.break_after = NO_BREAK;
+}
+
+uint32_t utest_flash_get_erase_count(unsigned page)
+{
+    if (page >= FLASH_STORAGE_PAGES_COUNT) {
+        return 0;
+    }
+    return flash_state.erase_count[page];
+}
+
+void utest_flash_break_next_program(uint16_t n)
+{
+    flash_state.break_after = n;
+}
+
+// Мок-реализация flash API
+const uint8_t * flash_storage_page_addr(unsigned page)
+{
+    return flash_state.pages[page];
+}
+
+bool flash_storage_erase(unsigned page)
+{
+    if (page >= FLASH_STORAGE_PAGES_COUNT) {
+        return false;
+    }
+    memset(flash_state.pages[page], 0xFF, FLASH_STORAGE_PAGE_SIZE);
+    flash_state.erase_count[page]++;
+    return true;
+}
+
+bool flash_storage_program(unsigned page, uint16_t offset, const void *data, uint16_t size)
+{
+    if ((page >= FLASH_STORAGE_PAGES_COUNT) ||
+        (offset % FLASH_STORAGE_WRITE_UNIT) || (size % FLASH_STORAGE_WRITE_UNIT) ||
+        (offset + size > FLASH_STORAGE_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    // Как и настоящая flash, не стёртую область записать нельзя
+    uint8_t *dst = &flash_state.pages[page][offset];
+    for (uint16_t i = 0; i < size; i++) {
+        if (dst[i] != 0xFF) {
+            return false;
+        }
+    }
+
+    if (flash_state.break_after != NO_BREAK) {
+        if (flash_state.break_after < size) {
+            size = flash_state.break_after;
+        }
+        memcpy(dst, data, size);
+        flash_state.break_after = NO_BREAK;
+        return false;
+    }
+
+    memcpy(dst, data, size);
+    return true;
+}
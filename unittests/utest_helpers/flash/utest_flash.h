@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "flash.h"
+
+// Сбросить состояние мока, страницы становятся стёртыми
+void utest_flash_reset(void);
+
+// Сколько раз стиралась страница
+uint32_t utest_flash_get_erase_count(unsigned page);
+
+// Следующая запись прервётся после записи n байт (эмуляция пропадания питания)
+void utest_flash_break_next_program(uint16_t n);
@@ -6,6 +6,7 @@ static struct {
     enum mcu_vcc_5v_state vcc_5v_state;
     bool init_called;
     uint16_t standby_wakeup_time;
+    struct mcu_standby_stats standby_stats;
 } mcu_state = {
     .poweron_reason = MCU_POWERON_REASON_POWER_ON,
     .vcc_5v_state = MCU_VCC_5V_STATE_OFF,
@@ -39,6 +40,12 @@ void mcu_save_vcc_5v_last_state(enum mcu_vcc_5v_state state)
     mcu_state.vcc_5v_state = state;
 }
 
+void mcu_take_standby_stats(struct mcu_standby_stats * stats)
+{
+    *stats = mcu_state.standby_stats;
+    mcu_state.standby_stats.wakeups = 0;
+}
+
 // Функции для тестирования
 void utest_mcu_set_poweron_reason(enum mcu_poweron_reason reason)
 {
@@ -60,10 +67,18 @@ uint16_t utest_mcu_get_standby_wakeup_time(void)
     return mcu_state.standby_wakeup_time;
 }
 
+void utest_mcu_set_standby_stats(uint16_t wakeups, uint16_t last_awake_us)
+{
+    mcu_state.standby_stats.wakeups = wakeups;
+    mcu_state.standby_stats.last_awake_us = last_awake_us;
+}
+
 void utest_mcu_reset(void)
 {
     mcu_state.poweron_reason = MCU_POWERON_REASON_POWER_ON;
     mcu_state.vcc_5v_state = MCU_VCC_5V_STATE_OFF;
     mcu_state.init_called = false;
     mcu_state.standby_wakeup_time = 0;
+    mcu_state.standby_stats.wakeups = 0;
+    mcu_state.standby_stats.last_awake_us = 0;
 }
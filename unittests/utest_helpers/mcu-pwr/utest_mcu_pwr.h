@@ -16,5 +16,8 @@ bool utest_mcu_was_init_called(void);
 // Получить параметр wakeup_after_s последнего вызова mcu_goto_standby()
 uint16_t utest_mcu_get_standby_wakeup_time(void);
 
+// Установить статистику, которую вернёт mcu_take_standby_stats()
+void utest_mcu_set_standby_stats(uint16_t wakeups, uint16_t last_awake_us);
+
 // Сбросить состояние мока
 void utest_mcu_reset(void);
@@ -0,0 +1,51 @@
+#include "utest_power_journal.h"
+#include <string.h>
+
+#define UTEST_POWER_JOURNAL_EVENTS_COUNT    8
+
+static struct {
+    uint32_t count[UTEST_POWER_JOURNAL_EVENTS_COUNT];
+    enum power_journal_event last_event;
+    uint8_t last_arg;
+} power_journal_state;
+
+void utest_power_journal_reset(void)
+{
+    memset(&power_journal_state, 0, sizeof(power_journal_state));
+}
+
+uint32_t utest_power_journal_get_count(enum power_journal_event e)
+{
+    if (e >= UTEST_POWER_JOURNAL_EVENTS_COUNT) {
+        return 0;
+    }
+    return power_journal_state.count[e];
+}
+
+enum power_journal_event utest_power_journal_get_last(uint8_t *arg)
+{
+    if (arg) {
+        *arg = power_journal_state.last_arg;
+    }
+    return power_journal_state.last_event;
+}
+
+// Мок-реализация power-journal API
+void power_journal_init(void)
+{
+
+}
+
+void power_journal_do_periodic_work(void)
+{
+
+}
+
+void power_journal_add(enum power_journal_event e, uint8_t arg)
+{
+    if (e < UTEST_POWER_JOURNAL_EVENTS_COUNT) {
+        power_journal_state.count[e]++;
+    }
+    power_journal_state.last_event = e;
+    power_journal_state.last_arg = arg;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdint.h>
+#include "power-journal.h"
+
+// Сбросить состояние мока
+void utest_power_journal_reset(void);
+
+// Сколько раз было добавлено событие
+uint32_t utest_power_journal_get_count(enum power_journal_event e);
+
+// Последнее добавленное событие и его аргумент
+enum power_journal_event utest_power_journal_get_last(uint8_t *arg);
@@ -82,3 +82,23 @@ bool regmap_get_data_if_region_changed(enum regmap_region r, void * data, size_t
     regmap_state.changed[r] = false;
     return true;
 }
+
+bool regmap_get_region_data(enum regmap_region r, void * data, size_t size)
+{
+    if (r >= REGMAP_REGION_COUNT || data == NULL || size == 0 || size > regmap_state.size[r]) {
+        return false;
+    }
+
+    memcpy(data, regmap_state.data[r], size);
+    return true;
+}
+
+bool regmap_set_region_data_as_changed(enum regmap_region r, const void * data, size_t size)
+{
+    if (!regmap_set_region_data(r, data, size)) {
+        return false;
+    }
+
+    regmap_state.changed[r] = true;
+    return true;
+}
@@ -9,6 +9,7 @@ static struct {
     bool ready_read;
     bool alarm_flag_cleared;
     bool periodic_wakeup_disabled;
+    uint32_t tamper_regs[5];
 
     // Track what was set
     bool datetime_was_set;
@@ -162,5 +163,18 @@ void rtc_disable_pc13_1hz_clkout(void) {}
 void rtc_enable_pa4_1hz_clkout(void) {}
 void rtc_disable_pa4_1hz_clkout(void) {}
 void rtc_set_periodic_wakeup(uint16_t period_s) { (void)period_s; }
-void rtc_save_to_tamper_reg(uint8_t index, uint32_t data) { (void)index; (void)data; }
-uint32_t rtc_get_tamper_reg(uint8_t index) { (void)index; return 0; }
+
+void rtc_save_to_tamper_reg(uint8_t index, uint32_t data)
+{
+    if (index < 5) {
+        rtc_state.tamper_regs[index] = data;
+    }
+}
+
+uint32_t rtc_get_tamper_reg(uint8_t index)
+{
+    if (index < 5) {
+        return rtc_state.tamper_regs[index];
+    }
+    return 0;
+}
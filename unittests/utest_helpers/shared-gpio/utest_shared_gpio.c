@@ -80,4 +80,11 @@ void shared_gpio_set_value(enum mod mod, enum mod_gpio mod_gpio, bool value)
     }
 }
 
+void shared_gpio_set_open_drain(enum mod mod, enum mod_gpio mod_gpio, bool open_drain)
+{
+    (void)mod;
+    (void)mod_gpio;
+    (void)open_drain;
+}
+
 #endif
@@ -3,11 +3,13 @@
 #include <stdbool.h>
 
 static systime_t current_time_ms = 0;
+static uint32_t current_time_us = 0;
 static bool systick_init_called = false;
 
 void utest_systick_set_time_ms(systime_t time_ms)
 {
     current_time_ms = time_ms;
+    current_time_us = 0;
 }
 
 void utest_systick_advance_time_ms(systime_t delta_ms)
@@ -25,6 +27,18 @@ systime_t systick_get_time_since_timestamp(systime_t timestamp)
     return current_time_ms - timestamp;
 }
 
+uint32_t systick_get_time_us(void)
+{
+    return current_time_ms * 1000 + current_time_us;
+}
+
+void utest_systick_advance_time_us(uint32_t delta_us)
+{
+    current_time_us += delta_us;
+    current_time_ms += current_time_us / 1000;
+    current_time_us %= 1000;
+}
+
 void systick_init(void)
 {
     systick_init_called = true;
@@ -9,6 +9,9 @@ void utest_systick_set_time_ms(systime_t time_ms);
 // Мок для увеличения времени на заданное количество мс
 void utest_systick_advance_time_ms(systime_t delta_ms);
 
+// Мок для увеличения времени на заданное количество мкс (systick_get_time_us)
+void utest_systick_advance_time_us(uint32_t delta_us);
+
 // Проверка вызова systick_init
 bool utest_systick_was_init_called(void);
 void utest_systick_reset_init_flag(void);
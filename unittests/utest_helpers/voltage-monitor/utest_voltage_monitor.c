@@ -3,12 +3,14 @@
 
 static bool vmon_channel_status[VMON_CHANNEL_COUNT] = {false};
 static bool vmon_is_ready = false;
+static bool vmon_awd_inhibited[VMON_CHANNEL_COUNT] = {false};
 
 void utest_vmon_reset(void)
 {
     vmon_is_ready = false;
     for (int i = 0; i < VMON_CHANNEL_COUNT; i++) {
         vmon_channel_status[i] = false;
+        vmon_awd_inhibited[i] = false;
     }
 }
 
@@ -50,6 +52,26 @@ bool vmon_check_ch_once(enum vmon_channel ch)
     return vmon_get_ch_status(ch);
 }
 
+bool vmon_check_ch_fast(enum vmon_channel ch)
+{
+    return vmon_get_ch_status(ch);
+}
+
+void vmon_awd_inhibit(enum vmon_channel ch, bool inhibit)
+{
+    if (ch < VMON_CHANNEL_COUNT) {
+        vmon_awd_inhibited[ch] = inhibit;
+    }
+}
+
+bool utest_vmon_get_awd_inhibited(enum vmon_channel ch)
+{
+    if (ch < VMON_CHANNEL_COUNT) {
+        return vmon_awd_inhibited[ch];
+    }
+    return false;
+}
+
 void vmon_do_periodic_work(void)
 {
 }
@@ -10,3 +10,6 @@ void utest_vmon_set_ch_status(enum vmon_channel ch, bool status);
 
 // Установка состояния готовности voltage monitor
 void utest_vmon_set_ready(bool ready);
+
+// Запрещён ли watchdog канала через vmon_awd_inhibit()
+bool utest_vmon_get_awd_inhibited(enum vmon_channel ch);
@@ -38,6 +38,23 @@ void utest_nvic_set_exit_jmp(jmp_buf *jmp)
     nvic_state.exit_jmp = jmp;
 }
 
+static unsigned wfi_count = 0;
+
+void __WFI(void)
+{
+    wfi_count++;
+}
+
+unsigned utest_wfi_get_count(void)
+{
+    return wfi_count;
+}
+
+void utest_wfi_reset(void)
+{
+    wfi_count = 0;
+}
+
 
 PWR_TypeDef _PWR_instance = {0};
 
@@ -45,3 +62,36 @@ void utest_pwr_reset(void)
 {
     memset(&_PWR_instance, 0, sizeof(_PWR_instance));
 }
+
+
+static uint32_t nvic_enabled_irqs = 0;
+
+void NVIC_EnableIRQ(IRQn_Type irqn)
+{
+    nvic_enabled_irqs |= (1UL << irqn);
+}
+
+void NVIC_DisableIRQ(IRQn_Type irqn)
+{
+    nvic_enabled_irqs &= ~(1UL << irqn);
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irqn)
+{
+    (void)irqn;
+}
+
+bool utest_nvic_is_irq_enabled(IRQn_Type irqn)
+{
+    return (nvic_enabled_irqs & (1UL << irqn)) != 0;
+}
+
+RCC_TypeDef _RCC_instance = {0};
+USART_TypeDef _USART_instance[2] = {0};
+
+void utest_usart_reset(void)
+{
+    memset(&_RCC_instance, 0, sizeof(_RCC_instance));
+    memset(_USART_instance, 0, sizeof(_USART_instance));
+    nvic_enabled_irqs = 0;
+}
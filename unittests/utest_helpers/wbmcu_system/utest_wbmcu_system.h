@@ -14,5 +14,15 @@ void utest_nvic_reset(void);
 // Это позволяет тестировать код с while(1) циклами
 void utest_nvic_set_exit_jmp(jmp_buf *jmp);
 
+// Количество вызовов __WFI()
+unsigned utest_wfi_get_count(void);
+void utest_wfi_reset(void);
+
 // Сбросить состояние мока PWR
 void utest_pwr_reset(void);
+
+// Состояние прерывания в моке NVIC
+bool utest_nvic_is_irq_enabled(IRQn_Type irqn);
+
+// Сбросить регистры моков RCC и USART и состояние прерываний NVIC
+void utest_usart_reset(void);
@@ -10,6 +10,9 @@ extern const uint32_t uid_base_mock[3];
 // Mock для NVIC_SystemReset
 void NVIC_SystemReset(void);
 
+// Mock для __WFI
+void __WFI(void);
+
 // Mock для PWR (определяется в stm32g030xx.h)
 typedef struct {
   volatile uint32_t CR1;        /*!< PWR Power Control Register 1,                     Address offset: 0x00 */
@@ -40,3 +43,96 @@ extern PWR_TypeDef _PWR_instance;
 
 // Бит применения конфигурации pull-up/pull-down.
 #define PWR_CR3_APC (1UL << 10)
+
+// Mock для номеров прерываний (определяются в stm32g030xx.h)
+typedef enum {
+  USART1_IRQn                 = 27,
+  USART2_IRQn                 = 28,
+} IRQn_Type;
+
+// Mock для NVIC: состояние прерываний доступно через utest_nvic_is_irq_enabled()
+void NVIC_EnableIRQ(IRQn_Type irqn);
+void NVIC_DisableIRQ(IRQn_Type irqn);
+void NVIC_ClearPendingIRQ(IRQn_Type irqn);
+#define NVIC_SetHandler(irqn, handler)     ((void)(irqn), (void)(handler))
+
+// Mock для RCC: только регистры, которые используются в тестируемых модулях
+typedef struct {
+  volatile uint32_t APBRSTR1;   /*!< RCC APB peripherals reset register 1 */
+  volatile uint32_t APBRSTR2;   /*!< RCC APB peripherals reset register 2 */
+  volatile uint32_t APBENR1;    /*!< RCC APB peripherals clock enable register1 */
+  volatile uint32_t APBENR2;    /*!< RCC APB peripherals clock enable register2 */
+} RCC_TypeDef;
+
+extern RCC_TypeDef _RCC_instance;
+
+#define RCC (&_RCC_instance)
+
+#define RCC_APBRSTR1_USART2RST          (1UL << 17)
+#define RCC_APBRSTR2_USART1RST          (1UL << 14)
+#define RCC_APBENR1_USART2EN            (1UL << 17)
+#define RCC_APBENR2_USART1EN            (1UL << 14)
+
+// Mock для USART (определяется в stm32g030xx.h)
+typedef struct {
+  volatile uint32_t CR1;        /*!< USART Control register 1,                 Address offset: 0x00  */
+  volatile uint32_t CR2;        /*!< USART Control register 2,                 Address offset: 0x04  */
+  volatile uint32_t CR3;        /*!< USART Control register 3,                 Address offset: 0x08  */
+  volatile uint32_t BRR;        /*!< USART Baud rate register,                 Address offset: 0x0C  */
+  volatile uint32_t GTPR;       /*!< USART Guard time and prescaler register,  Address offset: 0x10  */
+  volatile uint32_t RTOR;       /*!< USART Receiver Time Out register,         Address offset: 0x14  */
+  volatile uint32_t RQR;        /*!< USART Request register,                   Address offset: 0x18  */
+  volatile uint32_t ISR;        /*!< USART Interrupt and status register,      Address offset: 0x1C  */
+  volatile uint32_t ICR;        /*!< USART Interrupt flag Clear register,      Address offset: 0x20  */
+  volatile uint32_t RDR;        /*!< USART Receive Data register,              Address offset: 0x24  */
+  volatile uint32_t TDR;        /*!< USART Transmit Data register,             Address offset: 0x28  */
+  volatile uint32_t PRESC;      /*!< USART Prescaler register,                 Address offset: 0x2C  */
+} USART_TypeDef;
+
+// Регистры хранят записанные значения, аппаратная логика флагов не моделируется:
+// тест сам выставляет ISR/RDR и читает TDR/CR1
+extern USART_TypeDef _USART_instance[2];
+
+#define USART1 (&_USART_instance[0])
+#define USART2 (&_USART_instance[1])
+
+#define USART_CR1_UE                    (1UL << 0)
+#define USART_CR1_RE                    (1UL << 2)
+#define USART_CR1_TE                    (1UL << 3)
+#define USART_CR1_RXNEIE_RXFNEIE        (1UL << 5)
+#define USART_CR1_TCIE                  (1UL << 6)
+#define USART_CR1_TXEIE_TXFNFIE         (1UL << 7)
+#define USART_CR1_PS                    (1UL << 9)
+#define USART_CR1_PCE                   (1UL << 10)
+#define USART_CR1_WAKE                  (1UL << 11)
+#define USART_CR1_M0                    (1UL << 12)
+#define USART_CR1_MME                   (1UL << 13)
+#define USART_CR1_M1                    (1UL << 28)
+#define USART_CR1_M                     (USART_CR1_M0 | USART_CR1_M1)
+
+#define USART_CR2_ADDM7                 (1UL << 4)
+#define USART_CR2_STOP_Pos              (12U)
+#define USART_CR2_STOP                  (0x3UL << USART_CR2_STOP_Pos)
+#define USART_CR2_ADD_Pos               (24U)
+#define USART_CR2_ADD                   (0xFFUL << USART_CR2_ADD_Pos)
+
+#define USART_CR3_HDSEL                 (1UL << 3)
+#define USART_CR3_DEM                   (1UL << 14)
+
+#define USART_RQR_MMRQ                  (1UL << 2)
+
+#define USART_ISR_PE                    (1UL << 0)
+#define USART_ISR_FE                    (1UL << 1)
+#define USART_ISR_NE                    (1UL << 2)
+#define USART_ISR_ORE                   (1UL << 3)
+#define USART_ISR_RXNE_RXFNE            (1UL << 5)
+#define USART_ISR_TC                    (1UL << 6)
+#define USART_ISR_TXE_TXFNF             (1UL << 7)
+#define USART_ISR_BUSY                  (1UL << 16)
+
+#define USART_ICR_PECF                  (1UL << 0)
+#define USART_ICR_FECF                  (1UL << 1)
+#define USART_ICR_NECF                  (1UL << 2)
+#define USART_ICR_ORECF                 (1UL << 3)
+#define USART_ICR_TXFECF                (1UL << 5)
+#define USART_ICR_TCCF                  (1UL << 6)
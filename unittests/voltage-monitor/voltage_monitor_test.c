@@ -4,6 +4,7 @@
 #include "systick.h"
 #include "utest_adc.h"
 #include "utest_systick.h"
+#include "utest_irq.h"
 
 #define LOG_LEVEL LOG_LEVEL_INFO
 #include "console_log.h"
@@ -277,6 +278,114 @@ static void test_vmon_multiple_channels_independent(void)
     TEST_ASSERT_FALSE_MESSAGE(status, "V50 status should be FAIL");
 }
 
+// Сценарий: Срабатывание аппаратного watchdog АЦП на канале V50 в состоянии OK
+// Ожидается: Канал сразу переходит в FAIL, выставляется IRQ_PWR_FAIL, watchdog остаётся
+// выключенным до возврата напряжения в OK, затем снова взводится
+static void test_vmon_awd_trigger(void)
+{
+    LOG_INFO("Testing ADC analog watchdog trigger");
+
+    utest_irq_reset();
+    vmon_init();
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_V_IN, 20000);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_5V, 5000);
+
+    TEST_ASSERT_EQUAL_MESSAGE(ADC_CHANNEL_ADC_5V, utest_adc_awd_get_channel(ADC_AWD_2), "Watchdog 2 should monitor 5V channel");
+
+    utest_systick_advance_time_ms(VOLTAGE_MONITOR_START_DELAY_MS + 10);
+    vmon_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_2), "Watchdog should be armed when channel is OK");
+
+    // Провал напряжения, который ещё не виден в отфильтрованном значении
+    utest_adc_awd_trigger(ADC_AWD_2);
+    TEST_ASSERT_FALSE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V50), "V50 should be FAIL right after watchdog trigger");
+    TEST_ASSERT_TRUE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should stay OK");
+    TEST_ASSERT_TRUE_MESSAGE(utest_irq_is_flag_set(IRQ_PWR_FAIL), "IRQ_PWR_FAIL should be set");
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_5V, 3000);
+    vmon_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_2), "Watchdog should not be armed while channel is FAIL");
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_5V, 5000);
+    vmon_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V50), "V50 should be OK after voltage recovery");
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_2), "Watchdog should be rearmed after voltage recovery");
+}
+
+// Сценарий: Короткий провал V33, отфильтрованное значение остаётся в пределах OK
+// Ожидается: Канал держится в FAIL и watchdog не взводится до истечения VOLTAGE_MONITOR_AWD_HOLD_MS,
+// затем канал возвращается в OK и watchdog взводится снова
+static void test_vmon_awd_latch_filtered_in_range(void)
+{
+    LOG_INFO("Testing ADC analog watchdog latch");
+
+    utest_irq_reset();
+    vmon_init();
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_V_IN, 20000);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_5V, 5000);
+
+    utest_systick_advance_time_ms(VOLTAGE_MONITOR_START_DELAY_MS + 10);
+    vmon_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should be armed when channel is OK");
+
+    utest_adc_awd_trigger(ADC_AWD_3);
+    TEST_ASSERT_FALSE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should be FAIL right after watchdog trigger");
+
+    vmon_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should stay FAIL while filtered value is OK");
+    TEST_ASSERT_FALSE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should not be rearmed while latched");
+
+    utest_systick_advance_time_ms(VOLTAGE_MONITOR_AWD_HOLD_MS - 1);
+    vmon_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should stay FAIL before hold time elapsed");
+
+    utest_systick_advance_time_ms(1);
+    vmon_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should be OK after hold time");
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should be rearmed after hold time");
+}
+
+// Сценарий: Штатное отключение 3.3В при запрещённом watchdog
+// Ожидается: Watchdog отключается и не взводится, статус канала определяется по отфильтрованным значениям,
+// после разрешения watchdog взводится снова
+static void test_vmon_awd_inhibit(void)
+{
+    LOG_INFO("Testing ADC analog watchdog inhibit");
+
+    utest_irq_reset();
+    vmon_init();
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_V_IN, 20000);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_5V, 5000);
+
+    utest_systick_advance_time_ms(VOLTAGE_MONITOR_START_DELAY_MS + 10);
+    vmon_do_periodic_work();
+
+    vmon_awd_inhibit(VMON_CHANNEL_V33, true);
+    TEST_ASSERT_FALSE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should be disarmed when inhibited");
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_2), "Other watchdogs should stay armed");
+
+    vmon_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should not be rearmed when inhibited");
+    TEST_ASSERT_TRUE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should stay OK");
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 0);
+    vmon_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should be FAIL by filtered value");
+    TEST_ASSERT_FALSE_MESSAGE(utest_irq_is_flag_set(IRQ_PWR_FAIL), "IRQ_PWR_FAIL should not be set");
+
+    utest_adc_set_ch_mv(ADC_CHANNEL_ADC_3V3, 3300);
+    vmon_awd_inhibit(VMON_CHANNEL_V33, false);
+    vmon_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(vmon_get_ch_status(VMON_CHANNEL_V33), "V33 should be OK");
+    TEST_ASSERT_TRUE_MESSAGE(utest_adc_awd_is_armed(ADC_AWD_3), "Watchdog should be rearmed after inhibit is removed");
+}
+
 
 int main(void)
 {
@@ -291,6 +400,9 @@ int main(void)
     RUN_TEST(test_vmon_do_periodic_work_after_delay);
     RUN_TEST(test_vmon_do_periodic_work_checks_all_channels);
     RUN_TEST(test_vmon_multiple_channels_independent);
+    RUN_TEST(test_vmon_awd_trigger);
+    RUN_TEST(test_vmon_awd_latch_filtered_in_range);
+    RUN_TEST(test_vmon_awd_inhibit);
 
     return UNITY_END();
 }
@@ -18,6 +18,7 @@
 #include "utest_wdt_stm32.h"
 #include "utest_wdt.h"
 #include "utest_pwrkey.h"
+#include "utest_boot_timeline.h"
 #include "regmap-int.h"
 
 void utest_wbec_reset_state(void);
@@ -52,6 +53,7 @@ static void reset_all(void)
     utest_rtc_reset();
     utest_rtc_alarm_reset();
     utest_irq_reset();
+    utest_boot_timeline_reset();
 }
 
 void setUp(void)
@@ -326,6 +328,60 @@ static void test_init_periodic_wakeup_no_5v_was_off_no_extra_save(void)
                               "VCC 5V state must stay OFF without rewrite");
 }
 
+// ======================== wbec_periodic_wakeup_fast_path ========================
+
+// Сценарий: быстрый путь, периодическое пробуждение, +5В пропало (было включено).
+// Ожидание: сохраняется VCC_5V_STATE_OFF и МК сразу уходит в standby с обычным интервалом.
+static void test_fast_path_no_5v_goes_to_standby(void)
+{
+    utest_mcu_set_poweron_reason(MCU_POWERON_REASON_RTC_PERIODIC_WAKEUP);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V50, false);
+    utest_mcu_set_vcc_5v_state(MCU_VCC_5V_STATE_ON);
+
+    jmp_buf standby_jmp;
+    utest_linux_pwr_set_standby_exit_jmp(&standby_jmp);
+
+    if (setjmp(standby_jmp) == 0) {
+        wbec_periodic_wakeup_fast_path();
+        TEST_FAIL_MESSAGE("Fast path must go to standby when 5V is absent");
+    }
+
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(WBEC_PERIODIC_WAKEUP_NEXT_TIMEOUT_S,
+                                     utest_linux_pwr_get_standby_wakeup_s(),
+                                     "Standby wakeup timeout must match WBEC_PERIODIC_WAKEUP_NEXT_TIMEOUT_S");
+    TEST_ASSERT_EQUAL_MESSAGE(MCU_VCC_5V_STATE_OFF, mcu_get_vcc_5v_last_state(),
+                              "VCC 5V last state must be saved as OFF when 5V disappears");
+}
+
+// Сценарий: быстрый путь, периодическое пробуждение, +5В есть.
+// Ожидание: возврат без standby, решение принимает wbec_init.
+static void test_fast_path_5v_present_returns(void)
+{
+    utest_mcu_set_poweron_reason(MCU_POWERON_REASON_RTC_PERIODIC_WAKEUP);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V50, true);
+    utest_mcu_set_vcc_5v_state(MCU_VCC_5V_STATE_OFF);
+
+    wbec_periodic_wakeup_fast_path();
+
+    TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_standby_called(),
+                              "Fast path must not go to standby when 5V is present");
+    TEST_ASSERT_EQUAL_MESSAGE(MCU_VCC_5V_STATE_OFF, mcu_get_vcc_5v_last_state(),
+                              "VCC 5V last state must be left for wbec_init");
+}
+
+// Сценарий: быстрый путь при включении не от периодического пробуждения, +5В нет.
+// Ожидание: возврат без standby (например, включение от кнопки при питании от WBMZ).
+static void test_fast_path_other_reason_returns(void)
+{
+    utest_mcu_set_poweron_reason(MCU_POWERON_REASON_POWER_KEY);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V50, false);
+
+    wbec_periodic_wakeup_fast_path();
+
+    TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_standby_called(),
+                              "Fast path must be used only for RTC periodic wakeup");
+}
+
 // ======================== wbec_init: общие проверки ========================
 
 // Сценарий: при отсутствии +5В после любого штатного включения должен включаться wbmz stepup.
@@ -428,12 +484,13 @@ static void set_power_ctrl_request(bool off, bool reboot, bool reset_pmic)
 
 // ======================== wbec_do_periodic_work: WAIT_STARTUP ========================
 
-// Сценарий: vmon не готов → остаёмся в WAIT_STARTUP.
+// Сценарий: vmon не готов, V33 при старте есть (линукс может работать) → остаёмся в WAIT_STARTUP.
 // Ожидание: linux_cpu_pwr_seq_init не вызывается.
 static void test_periodic_wait_startup_vmon_not_ready(void)
 {
     utest_mcu_set_poweron_reason(MCU_POWERON_REASON_POWER_ON);
     utest_vmon_set_ch_status(VMON_CHANNEL_V50, true);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V33, true);
     wbec_init();
 
     // vmon_ready = false по умолчанию после reset
@@ -441,6 +498,38 @@ static void test_periodic_wait_startup_vmon_not_ready(void)
 
     TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_init_called(),
                               "linux_cpu_pwr_seq_init must not be called when vmon is not ready");
+    TEST_ASSERT_FALSE_MESSAGE(utest_boot_timeline_is_marked(BOOT_MILESTONE_STARTUP_DONE),
+                              "Startup must not be done while waiting for vmon");
+}
+
+// Сценарий: vmon не готов, V33 при старте нет, EC включен от USB-консоли.
+// Ожидание: WAIT_STARTUP ждёт vmon, затем VOLTAGE_CHECK видит VBUS_DEBUG и делает паузу
+// для USB-консоли, питание линукса не включается.
+static void test_periodic_wait_startup_no_v33_waits_vmon(void)
+{
+    utest_mcu_set_poweron_reason(MCU_POWERON_REASON_POWER_ON);
+    utest_vmon_set_ch_status(VMON_CHANNEL_V50, true);
+    wbec_init();
+
+    wbec_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_init_called(),
+                              "linux_cpu_pwr_seq_init must not be called before vmon is ready");
+    TEST_ASSERT_FALSE_MESSAGE(utest_boot_timeline_is_marked(BOOT_MILESTONE_STARTUP_DONE),
+                              "Startup must not be done while waiting for vmon");
+
+    // WAIT_STARTUP → VOLTAGE_CHECK
+    utest_vmon_set_ready(true);
+    utest_vmon_set_ch_status(VMON_CHANNEL_VBUS_DEBUG, true);
+    wbec_do_periodic_work();
+    TEST_ASSERT_TRUE_MESSAGE(utest_linux_pwr_get_init_called(),
+                             "linux_cpu_pwr_seq_init must be called when vmon is ready");
+    TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_init_on(),
+                              "linux_cpu_pwr_seq_init must be called with on=false when V33 is absent");
+
+    // VOLTAGE_CHECK: пауза для USB-консоли
+    wbec_do_periodic_work();
+    TEST_ASSERT_FALSE_MESSAGE(utest_linux_pwr_get_pwr_on_called(),
+                              "Linux power on must wait for USB console pause");
 }
 
 // Сценарий: vmon готов, POWER_ON, V33 есть → linux_cpu_pwr_seq_init(1), переход в POWER_ON_SEQUENCE_WAIT.
@@ -1194,6 +1283,9 @@ int main(void)
     RUN_TEST(test_init_periodic_wakeup_no_5v_was_on_saves_state);
     RUN_TEST(test_init_periodic_wakeup_no_5v_was_off_goes_to_standby);
     RUN_TEST(test_init_periodic_wakeup_no_5v_was_off_no_extra_save);
+    RUN_TEST(test_fast_path_no_5v_goes_to_standby);
+    RUN_TEST(test_fast_path_5v_present_returns);
+    RUN_TEST(test_fast_path_other_reason_returns);
 
     // Общие проверки init
     RUN_TEST(test_init_enables_stepup_when_no_5v);
@@ -1201,6 +1293,7 @@ int main(void)
 
     // WAIT_STARTUP
     RUN_TEST(test_periodic_wait_startup_vmon_not_ready);
+    RUN_TEST(test_periodic_wait_startup_no_v33_waits_vmon);
     RUN_TEST(test_periodic_wait_startup_power_on_with_v33);
     RUN_TEST(test_periodic_wait_startup_power_on_without_v33);
     RUN_TEST(test_periodic_wait_startup_non_power_on_with_v33);
@@ -154,6 +154,6 @@ bool rtc_alarm_is_alarm_enabled(void)
 
 void rtc_alarm_do_periodic_work(void) {}
 
-void usart_tx_buf_blocking(const void * buf, size_t size) { (void)buf; (void)size; }
+void usart_tx_buf(const void * buf, size_t size) { (void)buf; (void)size; }
 void buzzer_beep(uint16_t freq, uint16_t duration_ms) { (void)freq; (void)duration_ms; }
 void rcc_set_hsi_pll_64mhz_clock(void) {}